@@ -0,0 +1,37 @@
+#pragma once
+
+#include <compiler/specs/specs_file.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+    struct CorpusConfig {
+        size_t drivers              = 1000;     // Number of device drivers instantiating the bus driver
+        size_t namespaceDepth       = 4;        // Number of namespaces the bus driver is nested in
+        size_t inheritanceDepth     = 16;       // Length of the inheritance chain between the bus driver and some devices
+        size_t functionsPerDriver   = 4;        // Number of functions in every driver
+        size_t rawCodeSize          = 2048;     // Approximate size of every raw code block in bytes
+    };
+
+    struct Corpus {
+        std::map<std::string, compiler::specs::Driver> drivers;
+
+        // Driver names ordered so every driver comes after all of its dependencies
+        std::vector<std::string> order;
+
+        size_t totalBytes = 0;
+
+        // Drivers need to be added after all of their dependencies
+        auto addDriver(const std::string &name, std::string code, std::map<std::string, std::string> config = { }, std::vector<std::string> dependencies = { }) -> void;
+    };
+
+    // Generates a deterministic synthetic set of drivers to benchmark the compiler with
+    auto generateCorpus(const CorpusConfig &config) -> Corpus;
+
+    // Writes the corpus as a specs file and driver files that can be passed to the compiler
+    auto writeCorpus(const Corpus &corpus, const std::filesystem::path &directory) -> void;
+
+}
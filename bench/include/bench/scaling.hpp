@@ -0,0 +1,42 @@
+#pragma once
+
+#include <compiler/types.hpp>
+
+#include <string>
+#include <vector>
+
+namespace bench {
+
+    struct ScalingConfig {
+        // Fewer sizes than this don't give a reliable fit of the growth rate
+        static constexpr size_t MinimumSteps = 4;
+
+        size_t steps        = 5;        // Number of times the input size is doubled
+        size_t iterations   = 3;        // Number of runs per size, the fastest one is used
+        double maxExponent  = 1.35;     // Highest growth exponent accepted, O(n log n) stays well below this
+    };
+
+    struct ScalingResult {
+        struct Sample {
+            compiler::u64 bytes;
+            double seconds;
+        };
+
+        std::string scenario;
+        std::string stage;
+        std::vector<Sample> samples;
+
+        // Exponent k of the best fit of time = c * bytes^k
+        double exponent;
+
+        // Stages measured at fewer than MinimumSteps sizes have no exponent. They don't pass, but don't fail the check either
+        bool conclusive;
+        bool passed;
+    };
+
+    // Runs every stage on every scenario at doubling input sizes and fits the growth rate of the runtime
+    auto runScalingChecks(const ScalingConfig &config) -> std::vector<ScalingResult>;
+
+    auto scalingResultsToJson(const ScalingConfig &config, const std::vector<ScalingResult> &results) -> std::string;
+
+}
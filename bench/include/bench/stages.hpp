@@ -0,0 +1,33 @@
+#pragma once
+
+#include <bench/corpus.hpp>
+
+#include <compiler/types.hpp>
+
+#include <chrono>
+
+namespace bench {
+
+    // Every stage runs the given number of times, the duration is their total. Setting up the input isn't measured and only done once
+    struct Measurement {
+        std::chrono::nanoseconds duration;
+        compiler::u64 items;
+        compiler::u64 outputBytes = 0;
+    };
+
+    // Lexes every driver including placeholder expansion. Items are tokens
+    auto measureLexer(const Corpus &corpus, size_t repetitions = 1) -> Measurement;
+
+    // Parses every driver from already lexed tokens. Items are AST nodes
+    auto measureParser(const Corpus &corpus, size_t repetitions = 1) -> Measurement;
+
+    // Runs the full compiler front end from specs to AST. Items are drivers
+    auto measureCompiler(const Corpus &corpus, size_t repetitions = 1) -> Measurement;
+
+    // Measures only the time spent in the C code generator. Items are drivers
+    auto measureCodegen(const Corpus &corpus, size_t repetitions = 1) -> Measurement;
+
+    // Runs the front end and then counts nodes and generates C code in one fused traversal. Items are AST nodes
+    auto measurePipeline(const Corpus &corpus, size_t repetitions = 1) -> Measurement;
+
+}
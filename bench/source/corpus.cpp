@@ -0,0 +1,157 @@
+#include <bench/corpus.hpp>
+
+#include <wolv/io/file.hpp>
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+
+#include <array>
+
+namespace bench {
+
+    namespace {
+
+        constexpr auto ParameterTypes = std::array { "u8", "u16", "u32", "u64", "i8", "i16", "i32", "bool" };
+
+        auto generateRawCode(size_t size, size_t seed) -> std::string {
+            std::string result = "[[\n";
+
+            // Emit lines that look like typical HAL code until the requested size has been reached
+            for (size_t line = 0; result.size() < size; line++) {
+                switch ((seed + line) % 4) {
+                    case 0:
+                        result += fmt::format("    HAL_I2C_Master_Transmit(&hi2c{}, Address, &buffer[{}], sizeof(buffer), 1000);\n", seed % 4, line);
+                        break;
+                    case 1:
+                        result += fmt::format("    if ((status & 0x{:02X}) != 0) {{ result |= (1 << {}); }}\n", (seed * 31 + line) & 0xFF, line % 32);
+                        break;
+                    case 2:
+                        result += fmt::format("    for (int i = 0; i < {}; i++) {{ checksum ^= buffer[i] * {}; }}\n", line % 64 + 1, seed % 17);
+                        break;
+                    default:
+                        result += fmt::format("    // Wait for the transfer {} to complete\n", line);
+                        break;
+                }
+            }
+
+            result += "]]";
+
+            return result;
+        }
+
+        auto generateFunctions(const CorpusConfig &config, std::string_view prefix, size_t seed) -> std::string {
+            std::string result;
+
+            for (size_t i = 0; i < config.functionsPerDriver; i++) {
+                result += fmt::format("    fn {}Function{}({} value, {} offset) {{\n", prefix, i, ParameterTypes[(seed + i) % ParameterTypes.size()], ParameterTypes[(seed + i + 3) % ParameterTypes.size()]);
+                result += fmt::format("        {}\n", generateRawCode(config.rawCodeSize, seed + i));
+                result += "    }\n\n";
+            }
+
+            return result;
+        }
+
+    }
+
+    auto Corpus::addDriver(const std::string &name, std::string code, std::map<std::string, std::string> config, std::vector<std::string> dependencies) -> void {
+        this->totalBytes += code.size();
+        this->order.push_back(name);
+        this->drivers.emplace(name, compiler::specs::Driver {
+            .path           = fmt::format("drivers/{}.drv", name),
+            .code           = std::move(code),
+            .config         = std::move(config),
+            .dependencies   = std::move(dependencies)
+        });
+    }
+
+    auto generateCorpus(const CorpusConfig &config) -> Corpus {
+        Corpus corpus;
+
+        // Bus driver nested inside of multiple namespaces
+        std::string busNamespace;
+        {
+            std::string code;
+            for (size_t i = 0; i < config.namespaceDepth; i++) {
+                code += fmt::format("namespace Vendor{} {{\n", i);
+
+                if (!busNamespace.empty())
+                    busNamespace += "::";
+                busNamespace += fmt::format("Vendor{}", i);
+            }
+
+            code += "driver Bus<u8 Address> {\n";
+            code += generateFunctions(config, "bus", 0);
+            code += "}\n";
+
+            for (size_t i = 0; i < config.namespaceDepth; i++) {
+                code += "}\n";
+            }
+
+            corpus.addDriver("Bus", std::move(code));
+        }
+
+        auto busName = busNamespace.empty() ? std::string("Bus") : fmt::format("{{% impl %}}::Bus");
+        auto busConfig = busNamespace.empty() ? std::map<std::string, std::string>() : std::map<std::string, std::string> { { "impl", busNamespace } };
+
+        // Long inheritance chain where every driver inherits from the previous one
+        for (size_t i = 0; i < config.inheritanceDepth; i++) {
+            auto name = fmt::format("Chain{}", i);
+            auto parent = i == 0 ? fmt::format("{}<0x10>", busName) : fmt::format("Chain{}", i - 1);
+            auto dependency = i == 0 ? std::string("Bus") : fmt::format("Chain{}", i - 1);
+
+            auto code = fmt::format("driver {} : {} {{\n{}}}\n", name, parent, generateFunctions(config, "chain", i));
+
+            corpus.addDriver(name, std::move(code), busConfig, { dependency });
+        }
+
+        // Device drivers which mostly instantiate the bus driver with different template arguments
+        for (size_t i = 0; i < config.drivers; i++) {
+            auto name = fmt::format("Device{}", i);
+
+            std::string parent, dependency;
+            if (config.inheritanceDepth > 0 && i % 8 == 7) {
+                parent = fmt::format("Chain{}", config.inheritanceDepth - 1);
+                dependency = parent;
+            } else {
+                parent = fmt::format("{}<0x{:02X}>", busName, i % 0x80);
+                dependency = "Bus";
+            }
+
+            auto code = fmt::format("driver {} : {} {{\n{}}}\n", name, parent, generateFunctions(config, "device", i));
+
+            corpus.addDriver(name, std::move(code), busConfig, { dependency });
+        }
+
+        return corpus;
+    }
+
+    auto writeCorpus(const Corpus &corpus, const std::filesystem::path &directory) -> void {
+        std::filesystem::create_directories(directory / "drivers");
+
+        std::string specs;
+        for (const auto &name : corpus.order) {
+            const auto &driver = corpus.drivers.at(name);
+
+            wolv::io::File file(directory / driver.path, wolv::io::File::Mode::Create);
+            file.writeString(driver.code);
+
+            specs += fmt::format("[{}]\npath = \"{}\"\n", name, (directory / driver.path).generic_string());
+
+            if (!driver.config.empty()) {
+                std::vector<std::string> values;
+                for (const auto &[key, value] : driver.config)
+                    values.push_back(fmt::format("{} = \"{}\"", key, value));
+
+                specs += fmt::format("config = {{ {} }}\n", fmt::join(values, ", "));
+            }
+
+            if (!driver.dependencies.empty())
+                specs += fmt::format("depends = [\"{}\"]\n", fmt::join(driver.dependencies, "\", \""));
+
+            specs += "\n";
+        }
+
+        wolv::io::File file(directory / "specs.toml", wolv::io::File::Mode::Create);
+        file.writeString(specs);
+    }
+
+}
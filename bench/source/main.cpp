@@ -0,0 +1,185 @@
+#include <bench/corpus.hpp>
+#include <bench/scaling.hpp>
+#include <bench/stages.hpp>
+
+#include <compiler/helpers/fs.hpp>
+#include <compiler/helpers/json.hpp>
+#include <compiler/helpers/profiler.hpp>
+
+#include <cxxopts.hpp>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <sys/resource.h>
+#endif
+
+using namespace compiler;
+
+namespace {
+
+    struct StageResult {
+        std::string name;
+        double seconds;
+        u64 bytes;
+        u64 items;
+        std::string_view itemName;
+        u64 peakHeapBytes;
+        u64 allocations;
+        u64 peakRssBytes;
+    };
+
+    auto getPeakRss() -> u64 {
+        #if defined(__APPLE__)
+            rusage usage = { };
+            getrusage(RUSAGE_SELF, &usage);
+            return usage.ru_maxrss;
+        #elif defined(__unix__)
+            rusage usage = { };
+            getrusage(RUSAGE_SELF, &usage);
+            return u64(usage.ru_maxrss) * 1024;
+        #else
+            return 0;
+        #endif
+    }
+
+    // Runs a benchmark multiple times and keeps the fastest run.
+    // One additional run with allocation tracking enabled is done to measure memory usage without affecting the timings.
+    auto runStage(std::string name, std::string_view itemName, const bench::Corpus &corpus, size_t iterations, bench::Measurement (*measure)(const bench::Corpus &, size_t)) -> StageResult {
+        auto &profiler = hlp::Profiler::get();
+
+        auto best = std::chrono::nanoseconds::max();
+        for (size_t i = 0; i < iterations; i++) {
+            best = std::min(best, measure(corpus, 1).duration);
+        }
+
+        profiler.setAllocationTracking(true);
+        profiler.resetPeakHeapUsage();
+
+        auto before = profiler.getAllocationStatistics();
+        auto measurement = measure(corpus, 1);
+        auto after = profiler.getAllocationStatistics();
+
+        profiler.setAllocationTracking(false);
+
+        return {
+            .name           = std::move(name),
+            .seconds        = std::chrono::duration<double>(best).count(),
+            .bytes          = measurement.outputBytes != 0 ? measurement.outputBytes : corpus.totalBytes,
+            .items          = measurement.items,
+            .itemName       = itemName,
+            .peakHeapBytes  = after.peakBytes - std::min(after.peakBytes, before.liveBytes),
+            .allocations    = after.allocations - before.allocations,
+            .peakRssBytes   = getPeakRss()
+        };
+    }
+
+    auto toJson(const bench::CorpusConfig &config, const bench::Corpus &corpus, size_t iterations, const std::vector<StageResult> &results) -> std::string {
+        std::string json = "{\n";
+
+        json += fmt::format("  \"benchmark\": \"ddl_bench\",\n");
+        json += fmt::format("  \"iterations\": {},\n", iterations);
+        json += fmt::format("  \"config\": {{ \"drivers\": {}, \"namespaceDepth\": {}, \"inheritanceDepth\": {}, \"functionsPerDriver\": {}, \"rawCodeSize\": {} }},\n",
+                            config.drivers, config.namespaceDepth, config.inheritanceDepth, config.functionsPerDriver, config.rawCodeSize);
+        json += fmt::format("  \"corpus\": {{ \"drivers\": {}, \"bytes\": {} }},\n", corpus.drivers.size(), corpus.totalBytes);
+        json += "  \"stages\": [\n";
+
+        for (size_t i = 0; i < results.size(); i++) {
+            const auto &result = results[i];
+
+            json += fmt::format("    {{ \"name\": \"{}\", \"seconds\": {:.9f}, \"bytes\": {}, \"mbPerSecond\": {:.3f}, \"{}\": {}, \"{}PerSecond\": {:.1f}, \"allocations\": {}, \"peakHeapBytes\": {}, \"peakRssBytes\": {} }}{}\n",
+                                hlp::escapeJson(result.name), result.seconds, result.bytes, double(result.bytes) / result.seconds / 1'000'000.0,
+                                result.itemName, result.items, result.itemName, double(result.items) / result.seconds,
+                                result.allocations, result.peakHeapBytes, result.peakRssBytes,
+                                i == results.size() - 1 ? "" : ",");
+        }
+
+        json += "  ]\n}\n";
+
+        return json;
+    }
+
+    auto writeResult(const cxxopts::ParseResult &arguments, const std::string &json) {
+        if (arguments.count("output")) {
+            hlp::writeFileIfChanged(arguments["output"].as<std::string>(), json);
+        } else {
+            fmt::print("{}", json);
+        }
+    }
+
+}
+
+auto main(int argc, char **argv) -> int {
+    cxxopts::Options options("ddl_bench", "Driver Description Language compiler benchmarks");
+    options.add_options()
+        ("drivers",             "Number of generated device drivers",                   cxxopts::value<size_t>()->default_value("1000"))
+        ("namespace-depth",     "Number of namespaces the bus driver is nested in",     cxxopts::value<size_t>()->default_value("4"))
+        ("inheritance-depth",   "Length of the generated inheritance chain",            cxxopts::value<size_t>()->default_value("16"))
+        ("functions",           "Number of functions per driver",                       cxxopts::value<size_t>()->default_value("4"))
+        ("raw-code-size",       "Approximate size of every raw code block in bytes",    cxxopts::value<size_t>()->default_value("2048"))
+        ("iterations",          "Number of times every stage is run",                   cxxopts::value<size_t>()->default_value("5"))
+        ("o,output",            "Write the JSON results to this file instead of stdout", cxxopts::value<std::string>())
+        ("write-corpus",        "Write the generated corpus into this directory",       cxxopts::value<std::string>())
+        ("scaling",             "Check that no stage grows worse than O(n log n) with the input size")
+        ("scaling-steps",       "Number of times the input size is doubled",            cxxopts::value<size_t>()->default_value("5"))
+        ("max-exponent",        "Highest accepted growth exponent of the runtime",      cxxopts::value<double>()->default_value("1.35"))
+        ("h,help",              "Print this help");
+
+    auto arguments = options.parse(argc, argv);
+    if (arguments.count("help")) {
+        fmt::print("{}\n", options.help());
+        return EXIT_SUCCESS;
+    }
+
+    auto iterations = std::max<size_t>(1, arguments["iterations"].as<size_t>());
+
+    if (arguments.count("scaling")) {
+        bench::ScalingConfig config = {
+            .steps          = std::max(bench::ScalingConfig::MinimumSteps, arguments["scaling-steps"].as<size_t>()),
+            .iterations     = iterations,
+            .maxExponent    = arguments["max-exponent"].as<double>()
+        };
+
+        auto results = bench::runScalingChecks(config);
+        writeResult(arguments, bench::scalingResultsToJson(config, results));
+
+        bool passed = true;
+        for (const auto &result : results) {
+            if (!result.conclusive) {
+                fmt::print(stderr, "Stage '{}' has too few samples on scenario '{}', its growth is unknown\n", result.stage, result.scenario);
+            } else if (!result.passed) {
+                fmt::print(stderr, "Stage '{}' grows with O(n^{:.2f}) on scenario '{}'\n", result.stage, result.exponent, result.scenario);
+                passed = false;
+            }
+        }
+
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    bench::CorpusConfig config = {
+        .drivers            = arguments["drivers"].as<size_t>(),
+        .namespaceDepth     = arguments["namespace-depth"].as<size_t>(),
+        .inheritanceDepth   = arguments["inheritance-depth"].as<size_t>(),
+        .functionsPerDriver = arguments["functions"].as<size_t>(),
+        .rawCodeSize        = arguments["raw-code-size"].as<size_t>()
+    };
+
+    auto corpus = bench::generateCorpus(config);
+
+    if (arguments.count("write-corpus")) {
+        bench::writeCorpus(corpus, arguments["write-corpus"].as<std::string>());
+    }
+
+    std::vector<StageResult> results;
+    results.push_back(runStage("lexer",     "tokens",   corpus, iterations, bench::measureLexer));
+    results.push_back(runStage("parser",    "nodes",    corpus, iterations, bench::measureParser));
+    results.push_back(runStage("compiler",  "drivers",  corpus, iterations, bench::measureCompiler));
+    results.push_back(runStage("codegen",   "drivers",  corpus, iterations, bench::measureCodegen));
+    results.push_back(runStage("pipeline",  "nodes",    corpus, iterations, bench::measurePipeline));
+
+    writeResult(arguments, toJson(config, corpus, iterations, results));
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,222 @@
+#include <bench/scaling.hpp>
+#include <bench/corpus.hpp>
+#include <bench/stages.hpp>
+
+#include <compiler/helpers/json.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <optional>
+
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+
+namespace bench {
+
+    namespace {
+
+        struct Scenario {
+            std::string_view name;
+            size_t baseSize;
+            std::function<Corpus(size_t size)> generate;
+        };
+
+        auto rawCode(size_t size) -> std::string {
+            std::string result = "[[\n";
+            while (result.size() < size)
+                result += "    HAL_I2C_Master_Transmit(&hi2c1, Address, buffer, sizeof(buffer), 1000);\n";
+            result += "]]";
+
+            return result;
+        }
+
+        // Inputs that have caused superlinear behaviour before or stress a single construct
+        const auto Scenarios = std::array {
+            Scenario { "drivers", 128, [](size_t size) {
+                return generateCorpus({ .drivers = size, .namespaceDepth = 2, .inheritanceDepth = 4, .functionsPerDriver = 2, .rawCodeSize = 256 });
+            } },
+            Scenario { "inheritance chain", 64, [](size_t size) {
+                return generateCorpus({ .drivers = 0, .namespaceDepth = 0, .inheritanceDepth = size, .functionsPerDriver = 2, .rawCodeSize = 128 });
+            } },
+            Scenario { "deep instantiations", 128, [](size_t size) {
+                // Every device inherits from the end of a long inheritance chain
+                Corpus corpus;
+                corpus.addDriver("Chain0", fmt::format("driver Chain0 {{ fn f() {{ {} }} }}", rawCode(64)));
+                for (size_t i = 1; i < 64; i++)
+                    corpus.addDriver(fmt::format("Chain{}", i), fmt::format("driver Chain{} : Chain{} {{ fn f() {{ {} }} }}", i, i - 1, rawCode(64)), { }, { fmt::format("Chain{}", i - 1) });
+                for (size_t i = 0; i < size; i++)
+                    corpus.addDriver(fmt::format("Device{}", i), fmt::format("driver Device{} : Chain63 {{ fn f() {{ {} }} }}", i, rawCode(64)), { }, { "Chain63" });
+
+                return corpus;
+            } },
+            Scenario { "functions", 256, [](size_t size) {
+                std::string code = "driver Large {\n";
+                for (size_t i = 0; i < size; i++)
+                    code += fmt::format("    fn function{}(u8 a, u16 b, u32 c) {{ {} }}\n", i, rawCode(64));
+                code += "}\n";
+
+                Corpus corpus;
+                corpus.addDriver("Large", std::move(code));
+                return corpus;
+            } },
+            Scenario { "raw code block", 64, [](size_t size) {
+                Corpus corpus;
+                corpus.addDriver("Raw", fmt::format("driver Raw {{ fn f() {{ {} }} }}", rawCode(size * 1024)));
+                return corpus;
+            } },
+            Scenario { "comments", 64, [](size_t size) {
+                std::string code = "/*";
+                code.append(size * 1024, '*');
+                code += "*/\n";
+                for (size_t i = 0; i < size * 16; i++)
+                    code += "// A line comment that is long enough to matter\n";
+                code += "driver Comments { }\n";
+
+                Corpus corpus;
+                corpus.addDriver("Comments", std::move(code));
+                return corpus;
+            } },
+            Scenario { "nested namespaces", 128, [](size_t size) {
+                std::string code;
+                for (size_t i = 0; i < size; i++)
+                    code += fmt::format("namespace N{} {{\n", i);
+                code += "driver Deep { fn f() { [[ ]] } }\n";
+                for (size_t i = 0; i < size; i++)
+                    code += "}\n";
+
+                Corpus corpus;
+                corpus.addDriver("Deep", std::move(code));
+                return corpus;
+            } },
+            Scenario { "placeholders", 256, [](size_t size) {
+                std::string code = "driver Placeholders {\n";
+                for (size_t i = 0; i < size; i++)
+                    code += fmt::format("    fn function{}({{% type %}} a, {{% type %}} b) {{ [[ ]] }}\n", i);
+                code += "}\n";
+
+                Corpus corpus;
+                corpus.addDriver("Placeholders", std::move(code), { { "type", "u32" } });
+                return corpus;
+            } },
+        };
+
+        struct Stage {
+            std::string_view name;
+            Measurement (*measure)(const Corpus &, size_t);
+        };
+
+        constexpr auto Stages = std::array {
+            Stage { "lexer",    measureLexer    },
+            Stage { "parser",   measureParser   },
+            Stage { "compiler", measureCompiler },
+            Stage { "codegen",  measureCodegen  },
+        };
+
+        // Single runs shorter than this are dominated by timer resolution and noise, they're repeated until they took this long in total
+        constexpr auto MinimumMeasuredTime = std::chrono::milliseconds(10);
+
+        // Runs the stage often enough to reach the minimum measured time, returns the average time of a run in seconds
+        auto measureRepeatedly(const Stage &stage, const Corpus &corpus) -> double {
+            size_t repetitions = 1;
+            while (true) {
+                auto duration = stage.measure(corpus, repetitions).duration;
+                if (duration >= MinimumMeasuredTime)
+                    return std::chrono::duration<double>(duration).count() / double(repetitions);
+
+                // Aim a bit past the minimum so the next attempt doesn't fall just short of it
+                auto estimate = double(repetitions) * 1.2 * double(std::chrono::nanoseconds(MinimumMeasuredTime).count()) / double(std::max(duration, std::chrono::nanoseconds(1)).count());
+                repetitions = std::max(repetitions * 2, size_t(std::ceil(estimate)));
+            }
+        }
+
+        // Least squares fit of log(time) = k * log(bytes) + c. Fewer samples than this don't give a reliable fit
+        auto fitExponent(const std::vector<ScalingResult::Sample> &samples) -> std::optional<double> {
+            if (samples.size() < ScalingConfig::MinimumSteps)
+                return std::nullopt;
+
+            double meanX = 0, meanY = 0;
+            for (const auto &sample : samples) {
+                meanX += std::log(double(sample.bytes));
+                meanY += std::log(sample.seconds);
+            }
+            meanX /= double(samples.size());
+            meanY /= double(samples.size());
+
+            double covariance = 0, variance = 0;
+            for (const auto &sample : samples) {
+                auto x = std::log(double(sample.bytes)) - meanX;
+                auto y = std::log(sample.seconds) - meanY;
+
+                covariance += x * y;
+                variance += x * x;
+            }
+
+            if (variance == 0)
+                return std::nullopt;
+
+            return covariance / variance;
+        }
+
+    }
+
+    auto runScalingChecks(const ScalingConfig &config) -> std::vector<ScalingResult> {
+        std::vector<ScalingResult> results;
+
+        for (const auto &scenario : Scenarios) {
+            std::vector<ScalingResult> scenarioResults;
+            for (const auto &stage : Stages)
+                scenarioResults.push_back({ .scenario = std::string(scenario.name), .stage = std::string(stage.name) });
+
+            for (size_t step = 0; step < config.steps; step++) {
+                auto corpus = scenario.generate(scenario.baseSize << step);
+
+                for (size_t i = 0; i < Stages.size(); i++) {
+                    auto best = std::numeric_limits<double>::max();
+                    for (size_t iteration = 0; iteration < std::max<size_t>(config.iterations, 1); iteration++)
+                        best = std::min(best, measureRepeatedly(Stages[i], corpus));
+
+                    scenarioResults[i].samples.push_back({ corpus.totalBytes, best });
+                }
+            }
+
+            for (auto &result : scenarioResults) {
+                auto exponent = fitExponent(result.samples);
+                result.exponent = exponent.value_or(0);
+                result.conclusive = exponent.has_value();
+                result.passed = result.conclusive && result.exponent <= config.maxExponent;
+                results.push_back(std::move(result));
+            }
+        }
+
+        return results;
+    }
+
+    auto scalingResultsToJson(const ScalingConfig &config, const std::vector<ScalingResult> &results) -> std::string {
+        std::string json = "{\n";
+
+        json += "  \"benchmark\": \"ddl_bench scaling\",\n";
+        json += fmt::format("  \"steps\": {},\n  \"iterations\": {},\n  \"maxExponent\": {:.3f},\n", config.steps, config.iterations, config.maxExponent);
+        json += "  \"results\": [\n";
+
+        for (size_t i = 0; i < results.size(); i++) {
+            const auto &result = results[i];
+
+            std::vector<std::string> samples;
+            for (const auto &sample : result.samples)
+                samples.push_back(fmt::format("{{ \"bytes\": {}, \"seconds\": {:.9f} }}", sample.bytes, sample.seconds));
+
+            auto exponent = result.conclusive ? fmt::format("{:.3f}", result.exponent) : "null";
+            json += fmt::format("    {{ \"scenario\": \"{}\", \"stage\": \"{}\", \"exponent\": {}, \"conclusive\": {}, \"passed\": {}, \"samples\": [ {} ] }}{}\n",
+                                compiler::hlp::escapeJson(result.scenario), compiler::hlp::escapeJson(result.stage),
+                                exponent, result.conclusive, result.passed, fmt::join(samples, ", "),
+                                i == results.size() - 1 ? "" : ",");
+        }
+
+        json += "  ]\n}\n";
+
+        return json;
+    }
+
+}
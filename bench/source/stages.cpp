@@ -0,0 +1,277 @@
+#include <bench/stages.hpp>
+
+#include <compiler/language/compiler.hpp>
+#include <compiler/language/lexer.hpp>
+#include <compiler/language/parser.hpp>
+#include <compiler/visitors/visitor_c_generator.hpp>
+#include <compiler/visitors/visitor_pipeline.hpp>
+
+namespace bench {
+
+    using namespace compiler;
+    using namespace compiler::language;
+
+    namespace {
+
+        // Counts every node of an AST, including the ones of inherited drivers
+        struct VisitorNodeCounter final : ast::Visitor {
+            void visit(const ast::NodeDriver &node) override {
+                this->count++;
+
+                if (node.inheritance() != nullptr)
+                    this->visit(*node.inheritance());
+                for (const auto &parameter : node.templateParameters())
+                    this->visit(*parameter);
+                for (const auto &constant : node.constants())
+                    this->visit(*constant);
+                for (const auto &declaration : node.registers())
+                    this->visit(*declaration);
+                for (const auto &burst : node.bursts())
+                    this->visit(*burst);
+                for (const auto &buffer : node.buffers())
+                    this->visit(*buffer);
+                for (const auto &declaration : node.structs())
+                    this->visit(*declaration);
+                for (const auto &function : node.functions())
+                    this->visit(*function);
+            }
+
+            void visit(const ast::NodeFunction &node) override {
+                this->count++;
+
+                for (const auto &parameter : node.parameters())
+                    this->visit(*parameter);
+                if (node.returnType() != nullptr)
+                    this->visit(*node.returnType());
+                if (node.expression() != nullptr)
+                    this->visit(*node.expression());
+                for (const auto &statement : node.body())
+                    ast::dispatch(*statement, *this);
+            }
+
+            void visit(const ast::NodeVariable &node) override {
+                this->count++;
+                this->visit(*node.type());
+            }
+
+            void visit(const ast::NodeBuiltinType &) override {
+                this->count++;
+            }
+
+            void visit(const ast::NodeType &node) override {
+                this->count++;
+
+                // Driver types are counted as part of the inheritance
+                if (!node.isTypeParameter() && node.type()->kind() != ast::NodeKind::Driver)
+                    ast::dispatch(*node.type(), *this);
+            }
+
+            void visit(const ast::NodeRawCodeBlock &) override {
+                this->count++;
+            }
+
+            void visit(const ast::NodeExpression &node) override {
+                this->count++;
+
+                for (const auto &operand : node.operands())
+                    this->visit(*operand);
+            }
+
+            void visit(const ast::NodeConstant &node) override {
+                this->count++;
+                this->visit(*node.type());
+                this->visit(*node.expression());
+            }
+
+            void visit(const ast::NodeRegister &node) override {
+                this->count++;
+                this->visit(*node.type());
+                for (const auto &field : node.fields())
+                    this->visit(*field.type);
+            }
+
+            void visit(const ast::NodeBurst &) override {
+                this->count++;
+            }
+
+            void visit(const ast::NodeBuffer &) override {
+                this->count++;
+            }
+
+            void visit(const ast::NodeStruct &node) override {
+                this->count++;
+                for (const auto &field : node.fields())
+                    this->visit(*field.type);
+            }
+
+            u64 count = 0;
+        };
+
+        // Forwards top level drivers to the C generator while measuring how long code generation takes
+        struct VisitorTimedCGenerator final : ast::Visitor {
+            void visit(const ast::NodeDriver &node) override {
+                auto start = std::chrono::steady_clock::now();
+                this->generator.visit(node);
+                this->duration += std::chrono::steady_clock::now() - start;
+            }
+
+            void visit(const ast::NodeFunction &node) override { this->generator.visit(node); }
+            void visit(const ast::NodeVariable &node) override { this->generator.visit(node); }
+            void visit(const ast::NodeBuiltinType &node) override { this->generator.visit(node); }
+            void visit(const ast::NodeType &node) override { this->generator.visit(node); }
+            void visit(const ast::NodeRawCodeBlock &node) override { this->generator.visit(node); }
+            void visit(const ast::NodeExpression &node) override { this->generator.visit(node); }
+            void visit(const ast::NodeConstant &node) override { this->generator.visit(node); }
+            void visit(const ast::NodeRegister &node) override { this->generator.visit(node); }
+            void visit(const ast::NodeBurst &node) override { this->generator.visit(node); }
+            void visit(const ast::NodeBuffer &node) override { this->generator.visit(node); }
+            void visit(const ast::NodeStruct &node) override { this->generator.visit(node); }
+
+            visitor::VisitorCGenerator generator;
+            std::chrono::steady_clock::duration duration = { };
+        };
+
+        struct VisitorNull final : ast::Visitor {
+            void visit(const ast::NodeDriver &) override { }
+            void visit(const ast::NodeFunction &) override { }
+            void visit(const ast::NodeVariable &) override { }
+            void visit(const ast::NodeBuiltinType &) override { }
+            void visit(const ast::NodeType &) override { }
+            void visit(const ast::NodeRawCodeBlock &) override { }
+            void visit(const ast::NodeExpression &) override { }
+            void visit(const ast::NodeConstant &) override { }
+            void visit(const ast::NodeRegister &) override { }
+            void visit(const ast::NodeBurst &) override { }
+            void visit(const ast::NodeBuffer &) override { }
+            void visit(const ast::NodeStruct &) override { }
+        };
+
+        auto lexDriver(const specs::Driver &driver) -> std::vector<lexer::Token> {
+            std::vector<lexer::Token> tokens;
+
+            std::string_view code = driver.code;
+            for (auto lexer = lexer::lex(code, driver.config); lexer;) {
+                auto result = lexer();
+                if (!result.has_value())
+                    throw std::runtime_error(fmt::format("Lexer Error: {}", result.error()));
+
+                tokens.emplace_back(result.value());
+            }
+
+            return tokens;
+        }
+
+        auto elapsedSince(std::chrono::steady_clock::time_point start) -> std::chrono::nanoseconds {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        }
+
+    }
+
+    auto measureLexer(const Corpus &corpus, size_t repetitions) -> Measurement {
+        auto start = std::chrono::steady_clock::now();
+
+        u64 tokens = 0;
+        for (size_t repetition = 0; repetition < repetitions; repetition++) {
+            tokens = 0;
+            for (const auto &name : corpus.order) {
+                tokens += lexDriver(corpus.drivers.at(name)).size();
+            }
+        }
+
+        return { elapsedSince(start), tokens };
+    }
+
+    auto measureParser(const Corpus &corpus, size_t repetitions) -> Measurement {
+        std::vector<std::vector<lexer::Token>> tokens;
+        for (const auto &name : corpus.order) {
+            tokens.push_back(lexDriver(corpus.drivers.at(name)));
+        }
+
+        std::vector<std::unique_ptr<ast::Node>> nodes;
+        std::chrono::nanoseconds duration = { };
+
+        for (size_t repetition = 0; repetition < repetitions; repetition++) {
+            nodes.clear();
+            std::map<std::string, ast::NodeDriver*> drivers;
+
+            auto start = std::chrono::steady_clock::now();
+            for (const auto &driverTokens : tokens) {
+                parser::Parser parser;
+                parser.setDrivers(std::move(drivers));
+
+                for (auto parse = parser.parse(driverTokens); parse;) {
+                    auto result = parse();
+                    if (!result.has_value())
+                        throw std::runtime_error(fmt::format("Parser Error: {}", result.error()));
+
+                    nodes.emplace_back(std::move(result.value()));
+                }
+
+                drivers = parser.takeDrivers();
+            }
+            duration += elapsedSince(start);
+        }
+
+        VisitorNodeCounter counter;
+        for (const auto &node : nodes)
+            ast::dispatch(*node, counter);
+
+        return { duration, counter.count };
+    }
+
+    auto measureCompiler(const Corpus &corpus, size_t repetitions) -> Measurement {
+        std::chrono::nanoseconds duration = { };
+
+        // Every run gets a compiler of its own, a compiler that compiled the specs already would reuse its drivers
+        for (size_t repetition = 0; repetition < repetitions; repetition++) {
+            Compiler compiler((specs::SpecsFile(corpus.drivers)));
+            VisitorNull visitor;
+
+            auto start = std::chrono::steady_clock::now();
+            compiler.compile(visitor);
+            duration += elapsedSince(start);
+        }
+
+        return { duration, corpus.drivers.size() };
+    }
+
+    auto measureCodegen(const Corpus &corpus, size_t repetitions) -> Measurement {
+        Compiler compiler((specs::SpecsFile(corpus.drivers)));
+        std::chrono::nanoseconds duration = { };
+        u64 outputBytes = 0;
+
+        // The drivers are only lexed and parsed by the first run, the following ones reuse them
+        for (size_t repetition = 0; repetition < repetitions; repetition++) {
+            VisitorTimedCGenerator visitor;
+            compiler.compile(visitor);
+
+            duration += std::chrono::duration_cast<std::chrono::nanoseconds>(visitor.duration);
+            outputBytes = visitor.generator.source().size();
+        }
+
+        return { duration, corpus.drivers.size(), outputBytes };
+    }
+
+    auto measurePipeline(const Corpus &corpus, size_t repetitions) -> Measurement {
+        std::chrono::nanoseconds duration = { };
+        u64 nodes = 0, outputBytes = 0;
+
+        for (size_t repetition = 0; repetition < repetitions; repetition++) {
+            Compiler compiler((specs::SpecsFile(corpus.drivers)));
+
+            VisitorNodeCounter counter;
+            visitor::VisitorCGenerator generator;
+            visitor::VisitorPipeline pipeline(counter, generator);
+
+            auto start = std::chrono::steady_clock::now();
+            compiler.compile(pipeline);
+            duration += elapsedSince(start);
+
+            nodes = counter.count;
+            outputBytes = generator.source().size();
+        }
+
+        return { duration, nodes, outputBytes };
+    }
+
+}
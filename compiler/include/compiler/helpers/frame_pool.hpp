@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+
+namespace compiler::hlp {
+
+    // Recycles the memory of coroutine frames. Lexers and parsers start a new generator for every placeholder,
+    // namespace and parameter list, without this each of them would cost a malloc / free pair.
+    // Every thread keeps its own free lists so no locking is needed. Frames are still allocated individually,
+    // so a frame may be freed on a different thread than the one that allocated it
+    class FramePool {
+    public:
+        [[nodiscard]] static auto allocate(std::size_t size) -> void *;
+        static auto deallocate(void *pointer, std::size_t size) noexcept -> void;
+    };
+
+}
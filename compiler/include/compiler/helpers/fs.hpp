@@ -0,0 +1,16 @@
+#pragma once
+
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+namespace compiler::hlp {
+
+    // Replaces the content of a file only if it differs from the new content
+    // Returns true if the file has been written
+    auto writeFileIfChanged(const std::filesystem::path &path, std::string_view content) -> bool;
+
+    // Writes a Make / Ninja compatible depfile listing which inputs the targets depend on
+    auto writeDepfile(const std::filesystem::path &path, const std::vector<std::filesystem::path> &targets, const std::vector<std::filesystem::path> &dependencies) -> void;
+
+}
@@ -1,10 +1,29 @@
 #pragma once
 
+#include <compiler/helpers/frame_pool.hpp>
+
+#include <concepts>
 #include <coroutine>
-#include <exception>
+#include <cstddef>
+#include <utility>
 
 namespace compiler::hlp {
 
+    template <typename T>
+    struct Generator;
+
+    // Yielding elementsOf(generator) from inside a generator yields all values of the nested generator
+    // without an extra copy per value. Control is handed to the nested generator and back using symmetric transfer
+    template <typename T>
+    struct ElementsOf {
+        Generator<T> generator;
+    };
+
+    template <typename T>
+    auto elementsOf(Generator<T> &&generator) -> ElementsOf<T> {
+        return { std::move(generator) };
+    }
+
     template <typename T>
     struct Generator {
         struct promise_type;
@@ -13,23 +32,79 @@ namespace compiler::hlp {
         struct promise_type {
             promise_type() = default;
 
+            // Only used in the outermost generator, nested generators write their values into it directly
             T m_value;
-            std::exception_ptr m_exception;
+
+            // The outermost generator and the generator that's currently running inside of it
+            promise_type *m_root = this;
+            handle_type m_leaf;
+
+            // Generator this one has been nested into, resumed again once this one is done
+            handle_type m_parent;
+
+            // Coroutine frames are recycled instead of going through malloc every time
+            static auto operator new(std::size_t size) -> void * {
+                return FramePool::allocate(size);
+            }
+
+            static auto operator delete(void *pointer, std::size_t size) noexcept -> void {
+                FramePool::deallocate(pointer, size);
+            }
 
             auto get_return_object() -> Generator {
-                return Generator(handle_type::from_promise(*this));
+                this->m_leaf = handle_type::from_promise(*this);
+                return Generator(this->m_leaf);
             }
 
+            struct FinalAwaiter {
+                auto await_ready() noexcept -> bool { return false; }
+                auto await_suspend(handle_type handle) noexcept -> std::coroutine_handle<> {
+                    auto &promise = handle.promise();
+
+                    // Continue with the generator this one was nested into
+                    if (promise.m_parent) {
+                        promise.m_root->m_leaf = promise.m_parent;
+                        return promise.m_parent;
+                    }
+
+                    return std::noop_coroutine();
+                }
+                auto await_resume() noexcept -> void { }
+            };
+
+            struct NestedAwaiter {
+                Generator nested;
+
+                auto await_ready() noexcept -> bool { return !this->nested.m_handle; }
+                auto await_suspend(handle_type handle) noexcept -> std::coroutine_handle<> {
+                    auto &parent = handle.promise();
+                    auto &promise = this->nested.m_handle.promise();
+
+                    promise.m_root   = parent.m_root;
+                    promise.m_parent = handle;
+                    parent.m_root->m_leaf = this->nested.m_handle;
+
+                    return this->nested.m_handle;
+                }
+                auto await_resume() noexcept -> void { }
+            };
+
             auto initial_suspend() -> std::suspend_always { return { }; }
-            auto final_suspend() noexcept -> std::suspend_always { return { }; }
-            auto unhandled_exception() { m_exception = std::current_exception(); }
+            auto final_suspend() noexcept -> FinalAwaiter { return { }; }
+
+            // Exceptions are passed straight on to whoever resumed the generator
+            auto unhandled_exception() -> void { throw; }
 
             template<std::convertible_to<T> From>
-            auto yield_value(From&& from) -> std::suspend_always{
-                m_value = std::forward<From>(from);
+            auto yield_value(From&& from) -> std::suspend_always {
+                this->m_root->m_value = std::forward<From>(from);
                 return { };
             }
 
+            auto yield_value(ElementsOf<T> elements) -> NestedAwaiter {
+                return { std::move(elements.generator) };
+            }
+
             auto return_void() { }
         };
 
@@ -37,7 +112,28 @@ namespace compiler::hlp {
 
         explicit Generator(handle_type handle) : m_handle(handle) { }
 
-        ~Generator() { m_handle.destroy(); }
+        Generator(const Generator &) = delete;
+        Generator(Generator &&other) noexcept
+            : m_handle(std::exchange(other.m_handle, nullptr)), m_full(std::exchange(other.m_full, false)) { }
+
+        auto operator=(const Generator &) -> Generator & = delete;
+        auto operator=(Generator &&other) noexcept -> Generator & {
+            if (this != &other) {
+                if (m_handle)
+                    m_handle.destroy();
+
+                m_handle = std::exchange(other.m_handle, nullptr);
+                m_full   = std::exchange(other.m_full, false);
+            }
+
+            return *this;
+        }
+
+        ~Generator() {
+            if (m_handle)
+                m_handle.destroy();
+        }
+
         explicit operator bool() {
             fill();
             return !m_handle.done();
@@ -55,13 +151,12 @@ namespace compiler::hlp {
 
         auto fill() {
             if (!m_full) {
-                m_handle();
-                if (m_handle.promise().m_exception)
-                    std::rethrow_exception(m_handle.promise().m_exception);
+                // Resume the innermost nested generator, it transfers control back up on its own once it's done
+                m_handle.promise().m_leaf.resume();
 
                 m_full = true;
             }
         }
     };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <fmt/format.h>
+
+namespace compiler::hlp {
+
+    // Escapes a string so it can be placed between quotes in a JSON document
+    inline auto escapeJson(std::string_view string) -> std::string {
+        std::string result;
+        result.reserve(string.size());
+
+        for (char c : string) {
+            switch (c) {
+                case '"':  result += "\\\""; break;
+                case '\\': result += "\\\\"; break;
+                case '\n': result += "\\n";  break;
+                case '\r': result += "\\r";  break;
+                case '\t': result += "\\t";  break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20)
+                        result += fmt::format("\\u{:04x}", c);
+                    else
+                        result += c;
+                    break;
+            }
+        }
+
+        return result;
+    }
+
+}
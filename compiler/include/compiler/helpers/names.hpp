@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cctype>
+#include <ranges>
+#include <string>
+#include <string_view>
+
+namespace compiler::hlp {
+
+    // Prefix of everything generated for a driver, "drv_" followed by its name with "::" replaced by "_"
+    inline auto driverPrefix(std::string_view driverName) -> std::string {
+        // Build the prefix in a single pass, replacing "::" repeatedly is quadratic in the namespace depth
+        std::string prefix = "drv_";
+        prefix.reserve(prefix.size() + driverName.size());
+
+        for (const auto &part : std::views::split(driverName, std::string_view("::"))) {
+            if (prefix.size() > 4)
+                prefix += '_';
+            prefix.append(part.begin(), part.end());
+        }
+
+        return prefix;
+    }
+
+    // Prefix of a driver instantiated with template values, every set of values gets its own copy of the driver's functions.
+    // Characters that can't be part of an identifier are replaced with their hexadecimal code, so I2C<0x6D> becomes "drv_I2C_0x6D"
+    template<std::ranges::input_range TemplateValues>
+    auto driverPrefix(std::string_view driverName, const TemplateValues &templateValues) -> std::string {
+        constexpr static auto Digits = std::string_view("0123456789ABCDEF");
+
+        auto prefix = driverPrefix(driverName);
+        for (const auto &templateValue : templateValues) {
+            prefix += '_';
+            for (unsigned char c : std::string_view(templateValue.value)) {
+                if (std::isalnum(c)) {
+                    prefix += char(c);
+                } else {
+                    prefix += '_';
+                    prefix += Digits[c >> 4];
+                    prefix += Digits[c & 0x0F];
+                }
+            }
+        }
+
+        return prefix;
+    }
+
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <compiler/types.hpp>
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace compiler::hlp {
+
+    class Profiler {
+    public:
+        struct Event {
+            std::string phase;
+            std::string driver;
+            u32 thread;
+
+            std::chrono::nanoseconds start;
+            std::chrono::nanoseconds duration;
+            std::chrono::nanoseconds selfDuration;
+
+            u64 allocations;
+            u64 allocatedBytes;
+            u64 peakBytes;
+        };
+
+        struct AllocationStatistics {
+            u64 allocations;
+            u64 allocatedBytes;
+            u64 liveBytes;
+            u64 peakBytes;
+        };
+
+        static auto get() -> Profiler&;
+
+        // Enables recording of phases as well as allocation tracking
+        auto setEnabled(bool enabled) -> void;
+        [[nodiscard]] auto isEnabled() const -> bool;
+
+        // Only tracks allocations without recording any phases
+        auto setAllocationTracking(bool enabled) -> void;
+
+        // Allocation counts are per thread, heap usage is process wide
+        [[nodiscard]] auto getAllocationStatistics() const -> AllocationStatistics;
+        auto resetPeakHeapUsage() -> void;
+
+        auto addEvent(Event &&event) -> void;
+
+        // Human-readable table of time, allocations and peak memory broken down by phase and driver
+        [[nodiscard]] auto timeReport() const -> std::string;
+
+        // Chrome trace event JSON that can be loaded into chrome://tracing or Perfetto
+        [[nodiscard]] auto traceEvents() const -> std::string;
+
+    private:
+        Profiler() = default;
+
+        mutable std::mutex m_mutex;
+        std::vector<Event> m_events;
+    };
+
+    // Measures the time and memory spent between its construction and destruction.
+    // Phases can be nested, the time spent in nested phases is subtracted from the self time of the outer phase.
+    // The peak memory of a phase is measured on its own thread, phases running in parallel don't reset each other's baseline.
+    class ScopedPhase {
+    public:
+        explicit ScopedPhase(std::string_view phase, std::string_view driver = "");
+        ~ScopedPhase();
+
+        ScopedPhase(const ScopedPhase &) = delete;
+        ScopedPhase& operator=(const ScopedPhase &) = delete;
+
+    private:
+        bool m_active = false;
+        std::string_view m_phase, m_driver;
+
+        std::chrono::steady_clock::time_point m_start;
+        std::chrono::nanoseconds m_childDuration = { };
+        ScopedPhase *m_parent = nullptr;
+
+        u64 m_startAllocations = 0, m_startAllocatedBytes = 0;
+        i64 m_startLiveBytes = 0, m_outerPeakBytes = 0;
+    };
+
+}
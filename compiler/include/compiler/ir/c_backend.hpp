@@ -0,0 +1,57 @@
+#pragma once
+
+#include <compiler/ir/ir.hpp>
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace compiler::ir {
+
+    // Converts a value of the type between the given byte order and the host's by calling the drv_bigEndian16 style function for its size,
+    // or drv_bigEndianF32 for floating point values. Those are generated by the C generator, values of a single byte are returned as they are
+    [[nodiscard]] auto convertByteOrder(const std::string &value, Type type, ast::Endianness endianness) -> std::string;
+
+    // Generates the statements of a function's body from its IR. Values used once are nested into the expression using them,
+    // everything else is computed into a local first. Side effects happen in the order of the instructions
+    [[nodiscard]] auto generateC(const Function &function) -> std::string;
+
+    // Non-blocking transfer a bus operation is split into. It's started by calling begin with the arguments followed by the operation's operands,
+    // end is the value that has been read once the bus isn't busy anymore. Cached registers update the copy with the given prefix
+    struct AsyncTransfer {
+        std::string begin;
+        std::vector<std::string> arguments;
+        std::string end;
+        std::string cache;
+    };
+
+    struct AsyncTarget {
+        // Expression that's true while the bus is transferring
+        std::string busy;
+
+        // Expression that's true once the state machine may use the bus and statement handing it on after a transfer.
+        // Empty if the state machine doesn't share the bus with others
+        std::string acquire;
+        std::string release;
+
+        // Transfer of a bus operation with the type of the value it reads or writes, none if it can't be done without blocking
+        std::function<std::optional<AsyncTransfer>(const Instruction &instruction, Type type)> transfer;
+    };
+
+    struct AsyncCode {
+        // Cases of the switch over the state, starting with 1. The function is done once it returns false
+        std::string cases;
+
+        // Types and names of the parameters and values that have to be kept in the state between steps
+        std::vector<std::pair<std::string, std::string>> fields;
+    };
+
+    // Generates a function as a state machine the state s points to. Every bus operation returns until the bus is done,
+    // so the step function can be called again from an interrupt or the main loop without ever waiting for the bus.
+    // Values are kept in the state, the callback is called with the result once it's done.
+    // Returns none if the function calls something that would block
+    [[nodiscard]] auto generateAsyncC(const Function &function, const AsyncTarget &target) -> std::optional<AsyncCode>;
+
+}
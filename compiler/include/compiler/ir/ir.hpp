@@ -0,0 +1,148 @@
+#pragma once
+
+#include <compiler/types.hpp>
+#include <compiler/language/ast/node.hpp>
+
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace compiler::ir {
+
+    using namespace compiler::language;
+
+    // Type of a value, always a concrete builtin type since generic functions are lowered once per instantiation.
+    // Opaque values like string literals are only passed through and never computed with.
+    // So are bytes and strings, their values are a pointer and a length that are passed to functions as two arguments
+    struct Type {
+        enum class Kind : u8 {
+            Void,
+            Unsigned,
+            Signed,
+            FloatingPoint,
+            Boolean,
+            Opaque,
+            Bytes,
+            String
+        };
+
+        Kind kind = Kind::Void;
+        u8 size = 0;
+
+        auto operator==(const Type &) const -> bool = default;
+
+        [[nodiscard]] auto isArithmetic() const -> bool {
+            return this->kind != Kind::Void && this->kind != Kind::Opaque && !this->isSpan();
+        }
+
+        [[nodiscard]] auto isSpan() const -> bool {
+            return this->kind == Kind::Bytes || this->kind == Kind::String;
+        }
+
+        [[nodiscard]] auto isInteger() const -> bool {
+            return this->kind == Kind::Unsigned || this->kind == Kind::Signed || this->kind == Kind::Boolean;
+        }
+
+        // The builtin type to convert and format constants of this type with
+        [[nodiscard]] auto builtin() const -> ast::NodeBuiltinType;
+
+        // Name of the type in the generated code, "void" for Void and Opaque and the type of the pointer for bytes and strings
+        [[nodiscard]] auto name() const -> std::string_view;
+
+        // Type with the given name, Opaque if it's no builtin type
+        [[nodiscard]] static auto fromName(std::string_view name) -> Type;
+        [[nodiscard]] static auto fromBuiltin(const ast::NodeBuiltinType &type) -> Type;
+    };
+
+    // Integer promotion and the usual arithmetic conversions of C
+    [[nodiscard]] auto promote(Type type) -> Type;
+    [[nodiscard]] auto commonType(Type left, Type right) -> Type;
+
+    using ValueId = u32;
+
+    enum class Opcode : u8 {
+        Constant,           // constant, symbol is the literal as written if the value came straight from the source
+        Parameter,          // symbol is the name of the parameter
+        TemplateParameter,  // symbol is the function returning the template value of a driver that hasn't been instantiated
+        Index,              // symbol is the table, table points to it, operands are the index
+        Cast,               // operands are the value converted to the type
+        Unary,              // symbol is the operator
+        Binary,             // symbol is the operator
+        Select,             // operands are the condition, regions are the value if it's true and if it's false
+        LogicalAnd,         // operands are the left hand side, the region is the right hand side
+        LogicalOr,
+        Call,               // symbol is the called function, operands are the arguments
+        BusRead,            // Call of the bus driver's readRegister<T>(address) or of a cached or memory mapped register's read accessor
+        BusWrite,           // Call of the bus driver's writeRegister<T>(address, value) or of a cached or memory mapped register's write accessor
+        BusBurst,           // Reads registers at consecutive addresses in a single transfer, symbol is the burst. Its value is a struct holding them
+        BurstElement        // symbol is the member of the burst in the operands, registerDeclaration the register it holds
+    };
+
+    struct Block;
+
+    // A single instruction defining the value with its id. Every value is defined exactly once and only used after its definition.
+    // Operands that are only evaluated depending on a condition live in nested regions, those can use every value defined before
+    struct Instruction {
+        ValueId id = 0;
+        Opcode opcode = Opcode::Constant;
+        Type type;
+
+        std::string symbol;
+        std::vector<ValueId> operands;
+        std::vector<Block> regions;
+
+        ast::ConstantValue constant;
+        const ast::NodeConstant *table = nullptr;
+
+        // Declared register a bus operation or burst element accesses, the first register of a burst, nullptr for plain calls of readRegister<T> and writeRegister<T>
+        const ast::NodeRegister *registerDeclaration = nullptr;
+
+        // Calls of functions that are part of the module can be inlined
+        bool inlinable = false;
+
+        // Byte order the device transfers the value of a bus operation in. The IR always works with values in the host's byte order,
+        // they're only converted where they're passed to or returned from the bus driver. None if it returns them in the host's already
+        std::optional<ast::Endianness> endianness;
+
+        [[nodiscard]] auto hasSideEffects() const -> bool;
+    };
+
+    struct Block {
+        std::vector<Instruction> instructions;
+
+        // Value the block evaluates to, none for void
+        std::optional<ValueId> result;
+    };
+
+    struct Function {
+        std::string symbol;
+        Type returnType;
+        std::vector<std::pair<std::string, Type>> parameters;
+
+        Block body;
+        ValueId nextValue = 0;
+
+        // Declared `inline`, it's inlined into its callers whatever its size
+        bool alwaysInline = false;
+
+        auto newValue() -> ValueId {
+            return this->nextValue++;
+        }
+    };
+
+    // Functions lowered so far, ordered by their symbol so iterating over them is deterministic
+    struct Module {
+        std::map<std::string, Function, std::less<>> functions;
+
+        [[nodiscard]] auto find(std::string_view symbol) const -> const Function * {
+            auto it = this->functions.find(symbol);
+            return it != this->functions.end() ? &it->second : nullptr;
+        }
+    };
+
+    // Formats the function in a readable textual form, used to inspect what the passes did
+    [[nodiscard]] auto print(const Function &function) -> std::string;
+
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <compiler/ir/ir.hpp>
+#include <compiler/ir/passes.hpp>
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace compiler::ir {
+
+    // Lowers expression bodied functions to the IR. Raw code blocks are opaque, so functions with a block body are only ever called.
+    // Calls of the bus driver's readRegister<T>(address) and writeRegister<T>(address, value) become bus operations,
+    // so do accesses of declared registers. Fields are masked out of the register and updated by reading, modifying and writing it
+    class Lowering {
+    public:
+        using TypeArguments = std::vector<std::pair<std::string_view, std::string>>;
+
+        // Returns the symbol of a function called with the given type arguments, generic functions are instantiated on the way
+        using SymbolResolver = std::function<std::string(const ast::NodeFunction &function, const ast::NodeDriver &driver, const std::vector<std::string> &typeArguments)>;
+
+        Lowering(SymbolResolver resolver, passes::BurstResolver burstResolver) : m_resolver(std::move(resolver)), m_burstResolver(std::move(burstResolver)) { }
+
+        // Lowers and optimizes a function declared in driver, or returns the already lowered function with that symbol.
+        // Returns nullptr if the function uses something the IR can't represent, it's generated straight from the AST then
+        [[nodiscard]] auto lower(const ast::NodeFunction &function, const ast::NodeDriver &driver, const TypeArguments &typeArguments, const std::string &symbol) -> const Function *;
+
+        // Functions refer to the AST they were lowered from, the module has to be cleared before that's released
+        auto clear() -> void {
+            this->m_module.functions.clear();
+            this->m_failed.clear();
+        }
+
+        [[nodiscard]] auto module() const -> const Module & {
+            return this->m_module;
+        }
+
+    private:
+        struct Scope {
+            const ast::NodeFunction *function;
+            const ast::NodeDriver *driver;
+            const TypeArguments *typeArguments;
+            Function *target;
+
+            // Types of the values defined so far, indexed by their id
+            std::vector<Type> *types;
+        };
+
+        auto lowerExpression(const ast::NodeExpression &expression, Block &block) -> std::optional<ValueId>;
+        auto lowerIdentifier(std::string_view name, Block &block) -> std::optional<ValueId>;
+        auto lowerCall(const ast::NodeExpression &expression, Block &block) -> std::optional<ValueId>;
+        auto lowerRegion(const ast::NodeExpression &expression) -> std::optional<Block>;
+
+        auto lowerField(const ast::NodeExpression &expression, Block &block) -> std::optional<ValueId>;
+        auto lowerAssignment(const ast::NodeExpression &expression, Block &block) -> std::optional<ValueId>;
+        auto lowerRegisterAccess(const ast::NodeRegister &declaration, std::optional<ValueId> value, Block &block) -> std::optional<ValueId>;
+        auto findRegister(std::string_view name) const -> const ast::NodeRegister *;
+        auto deviceEndianness() const -> std::optional<ast::Endianness>;
+
+        auto emit(Block &block, Instruction instruction) -> ValueId;
+        auto emitInteger(Block &block, Type type, u64 value) -> ValueId;
+        auto emitCast(Block &block, ValueId value, Type type) -> ValueId;
+        auto typeOf(const ast::NodeType &type) const -> Type;
+        auto valueType(ValueId value) const -> Type;
+
+    private:
+        SymbolResolver m_resolver;
+        passes::BurstResolver m_burstResolver;
+        Module m_module;
+
+        // Symbols of functions that couldn't be lowered
+        std::vector<std::string> m_failed;
+
+        Scope m_scope = { };
+    };
+
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <compiler/ir/ir.hpp>
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace compiler::ir::passes {
+
+    // Returns the burst reading the given registers, ordered by their consecutive addresses. None if the bus driver can't transfer them at once
+    using BurstResolver = std::function<std::optional<std::string>(const std::vector<const ast::NodeRegister *> &registers)>;
+
+    // Replaces calls of functions in the module with their body, arguments and results are converted like in a call
+    auto inlineCalls(Function &function, const Module &module) -> void;
+
+    // Folds operations on known values, including template values of inherited drivers and elements of tables.
+    // Selects and logical operators with a known condition are replaced by the side that's taken
+    auto propagateConstants(Function &function) -> void;
+
+    // Reuses values that have been computed before instead of computing them again.
+    // Reading the same register again is merged into the first read unless there's a write or an opaque call in between
+    auto eliminateCommonSubexpressions(Function &function) -> void;
+
+    // Merges accesses of declared read / write registers. Reading a register after writing it uses the written value,
+    // writing it again before anything else has been transferred over the bus drops the first write.
+    // Updates of several fields of the same register become a single read, modify and write this way
+    auto coalesceRegisterAccesses(Function &function) -> void;
+
+    // Merges reads of registers at consecutive addresses into a single burst transfer. Only reads without a write
+    // or an opaque call in between are merged. Cached registers are left alone, reading them usually doesn't transfer anything
+    auto mergeRegisterReads(Function &function, const BurstResolver &resolver) -> void;
+
+    // Removes values without side effects that are never used
+    auto eliminateDeadCode(Function &function) -> void;
+
+    // Divisions by zero and shifts by a negative amount or by the width of the type or more are undefined in C.
+    // Their operands are only known once constants have been propagated, they're reported as errors instead of being emitted
+    auto rejectUndefinedOperations(const Function &function) -> void;
+
+    // Runs all passes in the order above. Callees are optimized before their callers already
+    auto optimize(Function &function, const Module &module, const BurstResolver &resolver) -> void;
+
+}
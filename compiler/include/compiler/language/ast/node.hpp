@@ -1,8 +1,13 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
+#include <optional>
+#include <string>
+#include <variant>
 #include <vector>
 
+#include <compiler/types.hpp>
 #include <compiler/helpers/utils.hpp>
 #include <compiler/language/lexer.hpp>
 
@@ -14,6 +19,28 @@ namespace compiler::language::ast {
     struct NodeBuiltinType;
     struct NodeType;
     struct NodeRawCodeBlock;
+    struct NodeExpression;
+    struct NodeConstant;
+    struct NodeRegister;
+    struct NodeBurst;
+    struct NodeBuffer;
+    struct NodeStruct;
+
+    // Kind of a node, used to dispatch to the right visit function without a virtual call per node
+    enum class NodeKind : u8 {
+        Driver,
+        Function,
+        Variable,
+        BuiltinType,
+        Type,
+        RawCodeBlock,
+        Expression,
+        Constant,
+        Register,
+        Burst,
+        Buffer,
+        Struct
+    };
 
     struct Visitor {
         virtual ~Visitor() = default;
@@ -24,13 +51,87 @@ namespace compiler::language::ast {
         virtual void visit(const NodeBuiltinType &node)     = 0;
         virtual void visit(const NodeType &node)            = 0;
         virtual void visit(const NodeRawCodeBlock &node)    = 0;
+        virtual void visit(const NodeExpression &node)      = 0;
+        virtual void visit(const NodeConstant &node)        = 0;
+        virtual void visit(const NodeRegister &node)        = 0;
+        virtual void visit(const NodeBurst &node)           = 0;
+        virtual void visit(const NodeBuffer &node)          = 0;
+        virtual void visit(const NodeStruct &node)          = 0;
+    };
+
+    // Value of a constant expression evaluated at compile time. Integers are kept in 128 bits so both
+    // the full signed and unsigned 64 bit ranges fit, they're only truncated once they're assigned to a type
+    using ConstantValue = std::variant<i128, f64>;
+
+    // Value a driver template parameter was instantiated with.
+    // Numeric values are already formatted as C literals, string and character values are stored without their quotes
+    struct TemplateValue {
+        lexer::Token::Type type;
+        std::string value;
+
+        auto operator==(const TemplateValue &other) const -> bool = default;
+    };
+
+    // Order of the bytes of values wider than a byte as the device sends and expects them
+    enum class Endianness : u8 {
+        Little,
+        Big
+    };
+
+    // Where the code of a function is placed and whether it's inlined, like `fn handle() hot ramfunc { ... }`.
+    // Drivers can declare them too, their functions use them unless they declare their own
+    struct FunctionAttributes {
+        enum class Temperature : u8 { Default, Hot, Cold };
+        enum class Inlining : u8 { Default, Always, Never };
+
+        Temperature temperature = Temperature::Default;
+        Inlining inlining = Inlining::Default;
+
+        // Linker section of functions running from RAM without quotes, empty for the default one
+        std::string_view section;
+
+        [[nodiscard]] auto empty() const -> bool {
+            return this->temperature == Temperature::Default && this->inlining == Inlining::Default && this->section.empty();
+        }
+
+        // Cold functions stay in flash even if the rest of their driver runs from RAM
+        [[nodiscard]] auto withDefaults(const FunctionAttributes &defaults) const -> FunctionAttributes {
+            auto result = *this;
+            if (result.temperature == Temperature::Default)
+                result.temperature = defaults.temperature;
+            if (result.inlining == Inlining::Default)
+                result.inlining = defaults.inlining;
+            if (result.section.empty() && this->temperature != Temperature::Cold)
+                result.section = defaults.section;
+
+            return result;
+        }
+
+        // Inlining a cold function would pull it into the hot path, inlining one placed in RAM would run it from its caller's memory
+        [[nodiscard]] auto isInlinable() const -> bool {
+            if (this->inlining != Inlining::Default)
+                return this->inlining == Inlining::Always;
+
+            return this->temperature != Temperature::Cold && this->section.empty();
+        }
     };
 
     struct Node {
+        explicit Node(NodeKind kind) : m_kind(kind) { }
         virtual ~Node() = default;
+
         [[nodiscard]] virtual auto clone() const -> std::unique_ptr<Node> = 0;
-        virtual auto accept(Visitor &visitor) const -> void = 0;
 
+        [[nodiscard]] auto kind() const -> NodeKind {
+            return this->m_kind;
+        }
+
+        // Calls the visit function of the visitor matching this node. Prefer ast::dispatch with
+        // the concrete visitor type if it's known, that lets the compiler inline the visit functions
+        auto accept(Visitor &visitor) const -> void;
+
+    private:
+        NodeKind m_kind;
     };
 
     struct NodeBuiltinType : public Node {
@@ -38,10 +139,14 @@ namespace compiler::language::ast {
             Unsigned,
             Signed,
             FloatingPoint,
-            Boolean
+            Boolean,
+            Bytes,
+            String
         };
 
-        explicit NodeBuiltinType(Type type, size_t size) : m_type(type), m_size(size) {}
+        static constexpr auto Kind = NodeKind::BuiltinType;
+
+        explicit NodeBuiltinType(Type type, size_t size) : Node(Kind), m_type(type), m_size(size) {}
 
         [[nodiscard]] auto clone() const -> std::unique_ptr<Node> override {
             return std::make_unique<NodeBuiltinType>(*this);
@@ -55,8 +160,9 @@ namespace compiler::language::ast {
             return this->m_size;
         }
 
-        void accept(Visitor &visitor) const override {
-            visitor.visit(*this);
+        // bytes and string are views of memory owned by the caller, passed as a pointer and a length. They have no size of their own
+        [[nodiscard]] auto isSpan() const -> bool {
+            return this->m_type == Type::Bytes || this->m_type == Type::String;
         }
 
     private:
@@ -64,25 +170,26 @@ namespace compiler::language::ast {
         size_t m_size;
     };
 
+    // Named reference to a builtin type or a driver. Type parameters of generic functions don't
+    // refer to anything until the function is instantiated, their type is nullptr
     struct NodeType : public Node {
+        static constexpr auto Kind = NodeKind::Type;
+
         NodeType(std::string_view name, std::unique_ptr<ast::Node> &&type)
-                : m_name(name), m_type(std::move(type)) {}
+                : Node(Kind), m_name(name), m_type(std::move(type)) {}
 
         ~NodeType() override = default;
 
-        NodeType(const NodeType &other) {
+        NodeType(const NodeType &other) : Node(Kind) {
             this->m_name = other.m_name;
-            this->m_type = hlp::unique_ptr_cast<Node>(other.m_type->clone());
+            if (other.m_type != nullptr)
+                this->m_type = hlp::unique_ptr_cast<Node>(other.m_type->clone());
         }
 
         [[nodiscard]] auto clone() const -> std::unique_ptr<Node> override {
             return std::make_unique<NodeType>(*this);
         }
 
-        void accept(Visitor &visitor) const override {
-            visitor.visit(*this);
-        }
-
         [[nodiscard]] auto name() const -> std::string_view {
             return this->m_name;
         }
@@ -91,17 +198,27 @@ namespace compiler::language::ast {
             return this->m_type.get();
         }
 
+        [[nodiscard]] auto releaseType() -> std::unique_ptr<Node> {
+            return std::move(this->m_type);
+        }
+
+        [[nodiscard]] auto isTypeParameter() const -> bool {
+            return this->m_type == nullptr;
+        }
+
     private:
         std::string_view m_name;
         std::unique_ptr<Node> m_type;
     };
 
     struct NodeVariable : public Node {
-        NodeVariable(std::string_view name, std::unique_ptr<NodeType> &&type) : m_name(name), m_type(std::move(type)) {}
+        static constexpr auto Kind = NodeKind::Variable;
+
+        NodeVariable(std::string_view name, std::unique_ptr<NodeType> &&type) : Node(Kind), m_name(name), m_type(std::move(type)) {}
 
         ~NodeVariable() override = default;
 
-        NodeVariable(const NodeVariable &other) {
+        NodeVariable(const NodeVariable &other) : Node(Kind) {
             this->m_name = other.m_name;
             this->m_type = hlp::unique_ptr_cast<NodeType>(other.m_type->clone());
         }
@@ -110,10 +227,6 @@ namespace compiler::language::ast {
             return std::make_unique<NodeVariable>(*this);
         }
 
-        void accept(Visitor &visitor) const override {
-            visitor.visit(*this);
-        }
-
         [[nodiscard]] auto name() const -> std::string_view {
             return this->m_name;
         }
@@ -127,15 +240,83 @@ namespace compiler::language::ast {
         std::unique_ptr<NodeType> m_type;
     };
 
+    struct NodeExpression : public Node {
+        enum class Operation {
+            NumericLiteral,
+            StringLiteral,
+            CharacterLiteral,
+            Identifier,         // Value is the name, possibly qualified with the driver it's declared in
+            UnaryOperator,      // Value is the operator, one operand
+            BinaryOperator,     // Value is the operator, two operands
+            TernaryOperator,    // Condition, true and false expressions
+            Call,               // Value is the function name, operands are the arguments, generic functions also have type arguments
+            Index,              // Indexed expression and the index
+            Lambda,             // Value is the parameter name, the operand is the body
+            Array,              // Operands are the elements
+            Field,              // Value is the field name, the operand is the register it's part of
+            Assignment,         // Register or register field and the value written to it
+            Sequence            // Operands are evaluated in order, the last one is the value
+        };
+
+        static constexpr auto Kind = NodeKind::Expression;
+
+        NodeExpression(Operation operation, std::string value, std::vector<std::unique_ptr<NodeExpression>> &&operands = { }, std::vector<std::string> &&typeArguments = { })
+            : Node(Kind), m_operation(operation), m_value(std::move(value)), m_operands(std::move(operands)), m_typeArguments(std::move(typeArguments)) { }
+
+        ~NodeExpression() override = default;
+
+        NodeExpression(const NodeExpression &other) : Node(Kind) {
+            this->m_operation = other.m_operation;
+            this->m_value = other.m_value;
+            for (const auto &operand : other.m_operands) {
+                this->m_operands.emplace_back(hlp::unique_ptr_cast<NodeExpression>(operand->clone()));
+            }
+            this->m_typeArguments = other.m_typeArguments;
+        }
+
+        [[nodiscard]] auto clone() const -> std::unique_ptr<Node> override {
+            return std::make_unique<NodeExpression>(*this);
+        }
+
+        [[nodiscard]] auto operation() const -> Operation {
+            return this->m_operation;
+        }
+
+        [[nodiscard]] auto value() const -> std::string_view {
+            return this->m_value;
+        }
+
+        [[nodiscard]] auto operands() const -> const std::vector<std::unique_ptr<NodeExpression>> & {
+            return this->m_operands;
+        }
+
+        // Builtin types or type parameters a generic function is called with
+        [[nodiscard]] auto typeArguments() const -> const std::vector<std::string> & {
+            return this->m_typeArguments;
+        }
+
+    private:
+        Operation m_operation;
+        std::string m_value;
+        std::vector<std::unique_ptr<NodeExpression>> m_operands;
+        std::vector<std::string> m_typeArguments;
+    };
+
     struct NodeFunction : public Node {
+        static constexpr auto Kind = NodeKind::Function;
+
         explicit NodeFunction(std::string_view name,
                               std::vector<std::unique_ptr<ast::NodeVariable>> &&parameters,
-                              std::vector<std::unique_ptr<ast::Node>> &&body)
-            : m_name(name), m_parameters(std::move(parameters)), m_body(std::move(body)) { }
+                              std::vector<std::unique_ptr<ast::Node>> &&body,
+                              std::vector<std::string_view> &&typeParameters = { },
+                              std::unique_ptr<ast::NodeType> &&returnType = nullptr,
+                              std::unique_ptr<ast::NodeExpression> &&expression = nullptr)
+            : Node(Kind), m_name(name), m_parameters(std::move(parameters)), m_body(std::move(body)),
+              m_typeParameters(std::move(typeParameters)), m_returnType(std::move(returnType)), m_expression(std::move(expression)) { }
 
         ~NodeFunction() override = default;
 
-        NodeFunction(const NodeFunction &other) {
+        NodeFunction(const NodeFunction &other) : Node(Kind) {
             this->m_name = other.m_name;
             for (const auto &parameter : other.m_parameters) {
                 this->m_parameters.emplace_back(hlp::unique_ptr_cast<NodeVariable>(parameter->clone()));
@@ -143,16 +324,20 @@ namespace compiler::language::ast {
             for (const auto &node : other.m_body) {
                 this->m_body.emplace_back(node->clone());
             }
+            this->m_typeParameters = other.m_typeParameters;
+            if (other.m_returnType != nullptr)
+                this->m_returnType = hlp::unique_ptr_cast<NodeType>(other.m_returnType->clone());
+            if (other.m_expression != nullptr)
+                this->m_expression = hlp::unique_ptr_cast<NodeExpression>(other.m_expression->clone());
+            this->m_async = other.m_async;
+            this->m_attributes = other.m_attributes;
+            this->m_interrupt = other.m_interrupt;
         }
 
         [[nodiscard]] auto clone() const -> std::unique_ptr<Node> override {
             return std::make_unique<NodeFunction>(*this);
         }
 
-        void accept(Visitor &visitor) const override {
-            visitor.visit(*this);
-        }
-
         [[nodiscard]] auto name() const -> std::string_view {
             return this->m_name;
         }
@@ -165,51 +350,424 @@ namespace compiler::language::ast {
             return this->m_body;
         }
 
+        // Names of the types a generic function is instantiated with, empty for regular functions
+        [[nodiscard]] auto typeParameters() const -> const std::vector<std::string_view> & {
+            return this->m_typeParameters;
+        }
+
+        // Declared or inferred return type, nullptr if the function doesn't return anything
+        [[nodiscard]] auto returnType() const -> const NodeType * {
+            return this->m_returnType.get();
+        }
+
+        // Body of expression bodied functions, nullptr for functions with a block body
+        [[nodiscard]] auto expression() const -> const NodeExpression * {
+            return this->m_expression.get();
+        }
+
+        // Async functions are additionally generated as a state machine that doesn't wait for the bus
+        [[nodiscard]] auto isAsync() const -> bool {
+            return this->m_async;
+        }
+
+        auto setAsync(bool async) -> void {
+            this->m_async = async;
+        }
+
+        // Attributes declared on the function itself, the ones of its driver aren't applied yet
+        [[nodiscard]] auto attributes() const -> const FunctionAttributes & {
+            return this->m_attributes;
+        }
+
+        auto setAttributes(const FunctionAttributes &attributes) -> void {
+            this->m_attributes = attributes;
+        }
+
+        // Interrupt handlers are called from the vector of their interrupt, like `isr("EXTI0_IRQHandler") fn onEdge() { ... }`
+        [[nodiscard]] auto isInterruptHandler() const -> bool {
+            return !this->m_interrupt.empty();
+        }
+
+        // Name of the interrupt vector the handler is called from, empty for regular functions
+        [[nodiscard]] auto interrupt() const -> std::string_view {
+            return this->m_interrupt;
+        }
+
+        auto setInterrupt(std::string_view vector) -> void {
+            this->m_interrupt = vector;
+        }
+
     private:
         std::string_view m_name;
         std::vector<std::unique_ptr<ast::NodeVariable>> m_parameters;
         std::vector<std::unique_ptr<ast::Node>> m_body;
+        std::vector<std::string_view> m_typeParameters;
+        std::unique_ptr<ast::NodeType> m_returnType;
+        std::unique_ptr<ast::NodeExpression> m_expression;
+        bool m_async = false;
+        FunctionAttributes m_attributes;
+        std::string_view m_interrupt;
+    };
+
+    // Scalar or table constant declared in a driver. It's evaluated while parsing, the expression is only kept around for printing
+    struct NodeConstant : public Node {
+        static constexpr auto Kind = NodeKind::Constant;
+
+        NodeConstant(std::string_view name, std::unique_ptr<NodeType> &&type, bool table, std::unique_ptr<NodeExpression> &&expression, std::vector<ConstantValue> &&values)
+            : Node(Kind), m_name(name), m_type(std::move(type)), m_table(table), m_expression(std::move(expression)), m_values(std::move(values)) { }
+
+        ~NodeConstant() override = default;
+
+        NodeConstant(const NodeConstant &other) : Node(Kind) {
+            this->m_name = other.m_name;
+            this->m_type = hlp::unique_ptr_cast<NodeType>(other.m_type->clone());
+            this->m_table = other.m_table;
+            this->m_expression = hlp::unique_ptr_cast<NodeExpression>(other.m_expression->clone());
+            this->m_values = other.m_values;
+        }
+
+        [[nodiscard]] auto clone() const -> std::unique_ptr<Node> override {
+            return std::make_unique<NodeConstant>(*this);
+        }
+
+        [[nodiscard]] auto name() const -> std::string_view {
+            return this->m_name;
+        }
+
+        [[nodiscard]] auto type() const -> const NodeType * {
+            return this->m_type.get();
+        }
+
+        // The element type of tables and the type of scalars is always a builtin type
+        [[nodiscard]] auto builtinType() const -> const NodeBuiltinType & {
+            return static_cast<const NodeBuiltinType &>(*this->m_type->type());
+        }
+
+        [[nodiscard]] auto isTable() const -> bool {
+            return this->m_table;
+        }
+
+        [[nodiscard]] auto expression() const -> const NodeExpression * {
+            return this->m_expression.get();
+        }
+
+        // One value for scalars, one per element for tables. Values have already been converted to the constant's type
+        [[nodiscard]] auto values() const -> const std::vector<ConstantValue> & {
+            return this->m_values;
+        }
+
+    private:
+        std::string_view m_name;
+        std::unique_ptr<NodeType> m_type;
+        bool m_table;
+        std::unique_ptr<NodeExpression> m_expression;
+        std::vector<ConstantValue> m_values;
+    };
+
+    // Register of a device, accessed through the bus driver's readRegister<T>(address) and writeRegister<T>(address, value).
+    // Fields are named bit ranges of its value, the address is evaluated while parsing
+    struct NodeRegister : public Node {
+        enum class Access : u8 {
+            Read,
+            Write,
+            ReadWrite
+        };
+
+        struct Field {
+            std::string_view name;
+            std::unique_ptr<NodeType> type;
+
+            // Position of the lowest bit and number of bits
+            u8 offset;
+            u8 width;
+        };
+
+        static constexpr auto Kind = NodeKind::Register;
+
+        NodeRegister(std::string_view name, std::unique_ptr<NodeType> &&type, u64 address, Access access, bool cached, std::vector<Field> &&fields, std::optional<Endianness> endianness = std::nullopt, bool memoryMapped = false)
+            : Node(Kind), m_name(name), m_type(std::move(type)), m_address(address), m_access(access), m_cached(cached), m_fields(std::move(fields)), m_endianness(endianness), m_memoryMapped(memoryMapped) { }
+
+        ~NodeRegister() override = default;
+
+        NodeRegister(const NodeRegister &other) : Node(Kind) {
+            this->m_name = other.m_name;
+            this->m_type = hlp::unique_ptr_cast<NodeType>(other.m_type->clone());
+            this->m_address = other.m_address;
+            this->m_access = other.m_access;
+            this->m_cached = other.m_cached;
+            for (const auto &field : other.m_fields)
+                this->m_fields.push_back({ field.name, hlp::unique_ptr_cast<NodeType>(field.type->clone()), field.offset, field.width });
+            this->m_endianness = other.m_endianness;
+            this->m_memoryMapped = other.m_memoryMapped;
+        }
+
+        [[nodiscard]] auto clone() const -> std::unique_ptr<Node> override {
+            return std::make_unique<NodeRegister>(*this);
+        }
+
+        [[nodiscard]] auto name() const -> std::string_view {
+            return this->m_name;
+        }
+
+        [[nodiscard]] auto type() const -> const NodeType * {
+            return this->m_type.get();
+        }
+
+        // Registers always have an integer type, the type the bus driver's functions are instantiated with
+        [[nodiscard]] auto builtinType() const -> const NodeBuiltinType & {
+            return static_cast<const NodeBuiltinType &>(*this->m_type->type());
+        }
+
+        [[nodiscard]] auto address() const -> u64 {
+            return this->m_address;
+        }
+
+        [[nodiscard]] auto access() const -> Access {
+            return this->m_access;
+        }
+
+        [[nodiscard]] auto isReadable() const -> bool {
+            return this->m_access != Access::Write;
+        }
+
+        [[nodiscard]] auto isWritable() const -> bool {
+            return this->m_access != Access::Read;
+        }
+
+        // Cached registers are only read from the device until they've been written or invalidated, after that a copy in RAM is used
+        [[nodiscard]] auto isCached() const -> bool {
+            return this->m_cached;
+        }
+
+        [[nodiscard]] auto fields() const -> const std::vector<Field> & {
+            return this->m_fields;
+        }
+
+        // Byte order the device transfers the register in, none if the bus driver's functions already return it in the host's
+        [[nodiscard]] auto endianness() const -> std::optional<Endianness> {
+            return this->m_endianness;
+        }
+
+        // Registers of memory mapped peripherals are accessed in place, their address is the offset from the peripheral's base address
+        [[nodiscard]] auto isMemoryMapped() const -> bool {
+            return this->m_memoryMapped;
+        }
+
+        [[nodiscard]] auto findField(std::string_view name) const -> const Field * {
+            for (const auto &field : this->m_fields) {
+                if (field.name == name)
+                    return &field;
+            }
+
+            return nullptr;
+        }
+
+    private:
+        std::string_view m_name;
+        std::unique_ptr<NodeType> m_type;
+        u64 m_address;
+        Access m_access;
+        bool m_cached;
+        std::vector<Field> m_fields;
+        std::optional<Endianness> m_endianness;
+        bool m_memoryMapped;
+    };
+
+    // Registers at consecutive addresses that are read in a single transfer through the bus driver's readRegisters<T>(address).
+    // They're referred to by name since the registers of a driver are cloned with it
+    struct NodeBurst : public Node {
+        static constexpr auto Kind = NodeKind::Burst;
+
+        NodeBurst(std::string_view name, std::vector<std::string_view> &&registers) : Node(Kind), m_name(name), m_registers(std::move(registers)) { }
+        ~NodeBurst() override = default;
+
+        NodeBurst(const NodeBurst &other) = default;
+
+        [[nodiscard]] auto clone() const -> std::unique_ptr<Node> override {
+            return std::make_unique<NodeBurst>(*this);
+        }
+
+        [[nodiscard]] auto name() const -> std::string_view {
+            return this->m_name;
+        }
+
+        // Names of the registers ordered by their address
+        [[nodiscard]] auto registers() const -> const std::vector<std::string_view> & {
+            return this->m_registers;
+        }
+
+    private:
+        std::string_view m_name;
+        std::vector<std::string_view> m_registers;
+    };
+
+    // Statically allocated buffer of bytes, like `bytes Frame[64] aligned(32) section(".dma");`.
+    // The alignment and section let DMA controllers with restrictions on the memory they can access transfer from and to it directly
+    struct NodeBuffer : public Node {
+        static constexpr auto Kind = NodeKind::Buffer;
+
+        NodeBuffer(std::string_view name, u64 size, u64 alignment, std::string_view section)
+            : Node(Kind), m_name(name), m_size(size), m_alignment(alignment), m_section(section) { }
+        ~NodeBuffer() override = default;
+
+        NodeBuffer(const NodeBuffer &other) = default;
+
+        [[nodiscard]] auto clone() const -> std::unique_ptr<Node> override {
+            return std::make_unique<NodeBuffer>(*this);
+        }
+
+        [[nodiscard]] auto name() const -> std::string_view {
+            return this->m_name;
+        }
+
+        [[nodiscard]] auto size() const -> u64 {
+            return this->m_size;
+        }
+
+        // 0 if the buffer doesn't need to be aligned
+        [[nodiscard]] auto alignment() const -> u64 {
+            return this->m_alignment;
+        }
+
+        // Linker section without quotes, empty for the default one
+        [[nodiscard]] auto section() const -> std::string_view {
+            return this->m_section;
+        }
+
+    private:
+        std::string_view m_name;
+        u64 m_size;
+        u64 m_alignment;
+        std::string_view m_section;
+    };
+
+    // Packed frame a device sends or expects, like `struct Sample big { u16 Voltage; i32 Pressure @ 4 : 3; }`.
+    // Offsets and widths are in bytes, fields narrower than their type are sign or zero extended when they're decoded
+    struct NodeStruct : public Node {
+        struct Field {
+            std::string_view name;
+            std::unique_ptr<NodeType> type;
+
+            // Position of the first byte and number of bytes
+            u32 offset;
+            u8 width;
+            Endianness endianness;
+        };
+
+        static constexpr auto Kind = NodeKind::Struct;
+
+        NodeStruct(std::string_view name, Endianness endianness, u32 size, std::vector<Field> &&fields)
+            : Node(Kind), m_name(name), m_endianness(endianness), m_size(size), m_fields(std::move(fields)) { }
+
+        ~NodeStruct() override = default;
+
+        NodeStruct(const NodeStruct &other) : Node(Kind) {
+            this->m_name = other.m_name;
+            this->m_endianness = other.m_endianness;
+            this->m_size = other.m_size;
+            for (const auto &field : other.m_fields)
+                this->m_fields.push_back({ field.name, hlp::unique_ptr_cast<NodeType>(field.type->clone()), field.offset, field.width, field.endianness });
+        }
+
+        [[nodiscard]] auto clone() const -> std::unique_ptr<Node> override {
+            return std::make_unique<NodeStruct>(*this);
+        }
+
+        [[nodiscard]] auto name() const -> std::string_view {
+            return this->m_name;
+        }
+
+        // Byte order of fields that don't declare their own
+        [[nodiscard]] auto endianness() const -> Endianness {
+            return this->m_endianness;
+        }
+
+        // Size of the frame in bytes, including gaps between fields
+        [[nodiscard]] auto size() const -> u32 {
+            return this->m_size;
+        }
+
+        // Fields ordered by their offset, they never overlap
+        [[nodiscard]] auto fields() const -> const std::vector<Field> & {
+            return this->m_fields;
+        }
+
+        // Fields always have a numeric or boolean type
+        [[nodiscard]] static auto builtinType(const Field &field) -> const NodeBuiltinType & {
+            return static_cast<const NodeBuiltinType &>(*field.type->type());
+        }
+
+        // Frames whose fields are exactly as wide as their types can be overlaid with a packed C struct.
+        // Flags are excluded, any value other than 0 or 1 in a C bool is undefined
+        [[nodiscard]] auto isOverlay() const -> bool {
+            return std::ranges::all_of(this->m_fields, [](const Field &field) {
+                const auto &type = builtinType(field);
+                return type.type() != NodeBuiltinType::Type::Boolean && type.size() == field.width;
+            });
+        }
+
+    private:
+        std::string_view m_name;
+        Endianness m_endianness;
+        u32 m_size;
+        std::vector<Field> m_fields;
     };
 
     struct NodeDriver : public Node {
+        static constexpr auto Kind = NodeKind::Driver;
+
+        // Transfers of devices on a shared bus are queued on one of this many priority levels
+        static constexpr u8 PriorityLevels = 8;
+
         NodeDriver(
                 std::string name,
                 std::unique_ptr<NodeDriver> &&inheritance,
                 std::vector<std::unique_ptr<NodeVariable>> &&templateParameters,
-                std::vector<std::unique_ptr<NodeFunction>> &&functions
+                std::vector<std::unique_ptr<NodeFunction>> &&functions,
+                std::vector<std::unique_ptr<NodeConstant>> &&constants = { },
+                std::vector<std::unique_ptr<NodeRegister>> &&registers = { },
+                std::vector<std::unique_ptr<NodeBurst>> &&bursts = { },
+                std::vector<std::unique_ptr<NodeBuffer>> &&buffers = { },
+                std::vector<std::unique_ptr<NodeStruct>> &&structs = { },
+                std::optional<Endianness> endianness = std::nullopt,
+                std::optional<u8> priority = std::nullopt,
+                std::optional<u64> baseAddress = std::nullopt,
+                FunctionAttributes functionAttributes = { }
                 ) :
+                Node(Kind),
                 m_name(std::move(name)),
                 m_inheritance(std::move(inheritance)),
-                m_templateParameters(std::move(templateParameters)),
-                m_functions(std::move(functions)) { }
-
-        ~NodeDriver() override = default;
-
-        NodeDriver(const NodeDriver &other) {
-            this->m_name = other.m_name;
-
-            if (other.m_inheritance != nullptr)
-                this->m_inheritance = hlp::unique_ptr_cast<NodeDriver>(other.m_inheritance->clone());
-
-            for (const auto &parameter : other.m_templateParameters) {
-                this->m_templateParameters.emplace_back(hlp::unique_ptr_cast<NodeVariable>(parameter->clone()));
+                m_templateParameters(std::make_shared<const std::vector<std::unique_ptr<NodeVariable>>>(std::move(templateParameters))),
+                m_functions(std::make_shared<const std::vector<std::unique_ptr<NodeFunction>>>(std::move(functions))),
+                m_constants(std::make_shared<const std::vector<std::unique_ptr<NodeConstant>>>(std::move(constants))),
+                m_registers(std::make_shared<const std::vector<std::unique_ptr<NodeRegister>>>(std::move(registers))),
+                m_bursts(std::make_shared<const std::vector<std::unique_ptr<NodeBurst>>>(std::move(bursts))),
+                m_buffers(std::make_shared<const std::vector<std::unique_ptr<NodeBuffer>>>(std::move(buffers))),
+                m_structs(std::make_shared<const std::vector<std::unique_ptr<NodeStruct>>>(std::move(structs))),
+                m_endianness(endianness),
+                m_deviceEndianness(endianness),
+                m_priority(priority),
+                m_baseAddress(baseAddress),
+                m_functionAttributes(functionAttributes) {
+            // Resolved once here instead of walking the inheritance chain every time, which made generating long chains quadratic
+            if (this->m_inheritance != nullptr) {
+                if (!this->m_deviceEndianness.has_value())
+                    this->m_deviceEndianness = this->m_inheritance->deviceEndianness();
+
+                this->m_inheritedInstance = this->m_inheritance->templateValues().empty() ? this->m_inheritance->inheritedInstance() : this->m_inheritance.get();
             }
+        }
 
-            this->m_templateValues = other.m_templateValues;
+        ~NodeDriver() override = default;
 
-            for (const auto &function : other.m_functions) {
-                this->m_functions.emplace_back(hlp::unique_ptr_cast<NodeFunction>(function->clone()));
-            }
-        }
+        // The inherited driver, template parameters, functions, constants, registers, bursts, buffers and structs are never modified once parsed.
+        // They're shared between copies so instantiating a driver doesn't copy its entire inheritance chain
+        NodeDriver(const NodeDriver &other) = default;
 
         [[nodiscard]] auto clone() const -> std::unique_ptr<Node> override {
             return std::make_unique<NodeDriver>(*this);
         }
 
-        void accept(Visitor &visitor) const override {
-            visitor.visit(*this);
-        }
-
         [[nodiscard]] auto name() const -> std::string_view {
             return this->m_name;
         }
@@ -219,34 +777,101 @@ namespace compiler::language::ast {
         }
 
         [[nodiscard]] auto functions() const -> const std::vector<std::unique_ptr<NodeFunction>> & {
-            return this->m_functions;
+            return *this->m_functions;
         }
 
         [[nodiscard]] auto templateParameters() const -> const std::vector<std::unique_ptr<NodeVariable>> & {
-            return this->m_templateParameters;
+            return *this->m_templateParameters;
+        }
+
+        [[nodiscard]] auto constants() const -> const std::vector<std::unique_ptr<NodeConstant>> & {
+            return *this->m_constants;
         }
 
-        [[nodiscard]] auto templateValues() const -> const std::vector<lexer::Token> & {
+        [[nodiscard]] auto registers() const -> const std::vector<std::unique_ptr<NodeRegister>> & {
+            return *this->m_registers;
+        }
+
+        [[nodiscard]] auto bursts() const -> const std::vector<std::unique_ptr<NodeBurst>> & {
+            return *this->m_bursts;
+        }
+
+        [[nodiscard]] auto buffers() const -> const std::vector<std::unique_ptr<NodeBuffer>> & {
+            return *this->m_buffers;
+        }
+
+        [[nodiscard]] auto structs() const -> const std::vector<std::unique_ptr<NodeStruct>> & {
+            return *this->m_structs;
+        }
+
+        // Byte order of the device, the default of its registers and structs. None if it hasn't been declared
+        [[nodiscard]] auto endianness() const -> std::optional<Endianness> {
+            return this->m_endianness;
+        }
+
+        // Byte order of the device, the one of the closest driver in its inheritance chain that declares one
+        [[nodiscard]] auto deviceEndianness() const -> std::optional<Endianness> {
+            return this->m_deviceEndianness;
+        }
+
+        // Priority of the device's transfers on a bus shared with other devices, higher ones go first. None if it hasn't been declared
+        [[nodiscard]] auto priority() const -> std::optional<u8> {
+            return this->m_priority;
+        }
+
+        // Memory mapped peripherals have their registers at a fixed base address instead of being accessed through a bus driver
+        [[nodiscard]] auto isMemoryMapped() const -> bool {
+            return this->m_baseAddress.has_value();
+        }
+
+        [[nodiscard]] auto baseAddress() const -> std::optional<u64> {
+            return this->m_baseAddress;
+        }
+
+        // Attributes of the functions declared in the driver that don't declare their own
+        [[nodiscard]] auto functionAttributes() const -> const FunctionAttributes & {
+            return this->m_functionAttributes;
+        }
+
+        [[nodiscard]] auto templateValues() const -> const std::vector<TemplateValue> & {
             return this->m_templateValues;
         }
 
-        auto setTemplateValues(std::vector<lexer::Token> &&arguments) -> void {
+        auto setTemplateValues(std::vector<TemplateValue> &&arguments) -> void {
             this->m_templateValues = std::move(arguments);
         }
 
+        // Closest driver in the inheritance chain that's been inherited with template values, null if there's none
+        [[nodiscard]] auto inheritedInstance() const -> const NodeDriver * {
+            return this->m_inheritedInstance;
+        }
+
     private:
         std::string m_name;
-        std::unique_ptr<NodeDriver> m_inheritance;
-        std::vector<std::unique_ptr<NodeVariable>> m_templateParameters;
-        std::vector<lexer::Token> m_templateValues;
-        std::vector<std::unique_ptr<NodeFunction>> m_functions;
+        std::shared_ptr<const NodeDriver> m_inheritance;
+        std::shared_ptr<const std::vector<std::unique_ptr<NodeVariable>>> m_templateParameters;
+        std::vector<TemplateValue> m_templateValues;
+        std::shared_ptr<const std::vector<std::unique_ptr<NodeFunction>>> m_functions;
+        std::shared_ptr<const std::vector<std::unique_ptr<NodeConstant>>> m_constants;
+        std::shared_ptr<const std::vector<std::unique_ptr<NodeRegister>>> m_registers;
+        std::shared_ptr<const std::vector<std::unique_ptr<NodeBurst>>> m_bursts;
+        std::shared_ptr<const std::vector<std::unique_ptr<NodeBuffer>>> m_buffers;
+        std::shared_ptr<const std::vector<std::unique_ptr<NodeStruct>>> m_structs;
+        std::optional<Endianness> m_endianness;
+        std::optional<Endianness> m_deviceEndianness;
+        const NodeDriver *m_inheritedInstance = nullptr;
+        std::optional<u8> m_priority;
+        std::optional<u64> m_baseAddress;
+        FunctionAttributes m_functionAttributes;
     };
 
     struct NodeRawCodeBlock : public Node {
-        explicit NodeRawCodeBlock(std::string_view code) : m_code(code) { }
+        static constexpr auto Kind = NodeKind::RawCodeBlock;
+
+        explicit NodeRawCodeBlock(std::string_view code) : Node(Kind), m_code(code) { }
         ~NodeRawCodeBlock() override = default;
 
-        NodeRawCodeBlock(const NodeRawCodeBlock &other) {
+        NodeRawCodeBlock(const NodeRawCodeBlock &other) : Node(Kind) {
             this->m_code = other.m_code;
         }
 
@@ -254,10 +879,6 @@ namespace compiler::language::ast {
             return std::make_unique<NodeRawCodeBlock>(*this);
         }
 
-        void accept(Visitor &visitor) const override {
-            visitor.visit(*this);
-        }
-
         [[nodiscard]] auto code() const -> std::string_view {
             return this->m_code;
         }
@@ -265,4 +886,29 @@ namespace compiler::language::ast {
         std::string_view m_code;
     };
 
-}
\ No newline at end of file
+    // Statically dispatches a node to the visit function of the visitor matching its kind.
+    // With a concrete visitor type the visit functions are called directly and can be inlined
+    template<typename V>
+    auto dispatch(const Node &node, V &visitor) -> void {
+        switch (node.kind()) {
+            using enum NodeKind;
+            case Driver:        visitor.visit(static_cast<const NodeDriver &>(node));        break;
+            case Function:      visitor.visit(static_cast<const NodeFunction &>(node));      break;
+            case Variable:      visitor.visit(static_cast<const NodeVariable &>(node));      break;
+            case BuiltinType:   visitor.visit(static_cast<const NodeBuiltinType &>(node));   break;
+            case Type:          visitor.visit(static_cast<const NodeType &>(node));          break;
+            case RawCodeBlock:  visitor.visit(static_cast<const NodeRawCodeBlock &>(node));  break;
+            case Expression:    visitor.visit(static_cast<const NodeExpression &>(node));    break;
+            case Constant:      visitor.visit(static_cast<const NodeConstant &>(node));      break;
+            case Register:      visitor.visit(static_cast<const NodeRegister &>(node));      break;
+            case Burst:         visitor.visit(static_cast<const NodeBurst &>(node));         break;
+            case Buffer:        visitor.visit(static_cast<const NodeBuffer &>(node));        break;
+            case Struct:        visitor.visit(static_cast<const NodeStruct &>(node));        break;
+        }
+    }
+
+    inline auto Node::accept(Visitor &visitor) const -> void {
+        dispatch(*this, visitor);
+    }
+
+}
@@ -1,35 +1,85 @@
 #pragma once
 
+#include <concepts>
 #include <filesystem>
+#include <map>
 #include <set>
 #include <string>
+#include <vector>
 
+#include <compiler/helpers/profiler.hpp>
 #include <compiler/specs/specs_file.hpp>
 #include <compiler/language/ast/node.hpp>
+#include <compiler/language/driver_cache.hpp>
 
 namespace compiler::language {
 
     class Compiler {
     public:
-        explicit Compiler(const std::filesystem::path &path) : m_specsFile(path) {}
+        // Compilers sharing a driver cache only lex and parse drivers with identical code, config and dependencies once
+        explicit Compiler(const std::filesystem::path &path, std::shared_ptr<DriverCache> driverCache = nullptr)
+            : m_specsFile(path), m_driverCache(driverCache != nullptr ? std::move(driverCache) : std::make_shared<DriverCache>()) {}
+        explicit Compiler(compiler::specs::SpecsFile specsFile, std::shared_ptr<DriverCache> driverCache = nullptr)
+            : m_specsFile(std::move(specsFile)), m_driverCache(driverCache != nullptr ? std::move(driverCache) : std::make_shared<DriverCache>()) {}
 
-        auto compile(ast::Visitor &visitor) {
-            auto nodes = this->processSpecsFile(this->m_specsFile);
+        // Visits all top level nodes. Passing the concrete visitor type instead of an ast::Visitor lets the visit calls be inlined
+        template<std::derived_from<ast::Visitor> V>
+        auto compile(V &visitor) -> void {
+            auto drivers = this->processSpecsFile(this->m_specsFile);
 
-            for (auto &node : nodes) {
-                node->accept(visitor);
+            for (auto &driver : drivers) {
+                for (auto &node : driver->nodes) {
+                    auto name = node->kind() == ast::NodeKind::Driver ? static_cast<const ast::NodeDriver &>(*node).name() : "";
+                    hlp::ScopedPhase phase("codegen", name);
+
+                    ast::dispatch(*node, visitor);
+                }
             }
         }
 
+        // Generates code for every driver as soon as it and its dependencies are compiled and releases its AST
+        // again once no driver left to compile depends on it. Peak memory is bounded by the largest dependency
+        // closure instead of by all drivers together. Neither the driver cache nor the instantiation memo are used
+        auto compileStreaming(ast::Visitor &visitor) -> void;
+
+        [[nodiscard]] auto specsFile() const -> const compiler::specs::SpecsFile & {
+            return this->m_specsFile;
+        }
+
     private:
-        auto processSpecsFile(const compiler::specs::SpecsFile &specsFile) -> std::vector<std::unique_ptr<ast::Node>>;
-        auto processDriver(const compiler::specs::Driver &driver) -> std::vector<std::unique_ptr<ast::Node>>;
-        auto compileCode(std::string_view code, const std::map<std::string, std::string> &placeholders) -> std::vector<std::unique_ptr<ast::Node>>;
+        auto processSpecsFile(const compiler::specs::SpecsFile &specsFile) -> std::vector<DriverCache::Entry>;
+        auto processDriver(const std::string &name, const compiler::specs::Driver &driver, std::vector<DriverCache::Entry> &result) -> DriverCache::Entry;
+        struct StreamingState {
+            // Number of dependents of every driver that haven't been compiled yet
+            std::map<std::string, size_t> remainingDependents;
+
+            // Drivers that are still needed by a dependent, everything else is released right after code generation
+            std::map<std::string, DriverCache::Entry> alive;
+            std::set<std::string> emitted;
+        };
+
+        auto streamDriver(const std::string &name, const compiler::specs::Driver &driver, ast::Visitor &visitor, StreamingState &state) -> DriverCache::Entry;
+        auto compileDriver(std::string_view name, const compiler::specs::Driver &driver, std::string key, std::vector<DriverCache::Entry> &&dependencies) -> DriverCache::Entry;
 
     private:
         compiler::specs::SpecsFile m_specsFile;
-        std::set<std::string> m_compiledDrivers;
-        std::map<std::string, ast::NodeDriver*> m_drivers;
+        std::shared_ptr<DriverCache> m_driverCache;
+
+        // Every driver is instantiated once per placeholder config and set of dependencies. The memo outlives a single compile call,
+        // compiling the same specs file again doesn't have to look up any driver in the cache
+        struct InstantiationKey {
+            std::string name;
+            u64 configHash;
+            std::vector<std::string> dependencyKeys;
+
+            auto operator<=>(const InstantiationKey &other) const = default;
+        };
+        std::map<InstantiationKey, DriverCache::Entry> m_instantiations;
+
+        // Drivers already handled by the current compile call, shared dependencies are only processed once
+        std::map<std::string, DriverCache::Entry> m_processedDrivers;
+        std::set<DriverCache::Entry> m_resultInstantiations;
+        std::set<std::string> m_driversInProgress;
     };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <compiler/types.hpp>
+#include <compiler/language/ast/node.hpp>
+
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace compiler::language {
+
+    // Lexed and parsed driver file of a specs file.
+    // It's never modified once created so it can be shared between the compilations of multiple specs files
+    struct CompiledDriver {
+        std::string key;
+
+        // The AST refers into the code and config so the compiled driver keeps its own copy of them
+        std::string code;
+        std::map<std::string, std::string> config;
+
+        // Inherited drivers share parts of their AST with the drivers they were inherited from
+        std::vector<std::shared_ptr<const CompiledDriver>> dependencies;
+
+        std::vector<std::unique_ptr<ast::Node>> nodes;
+
+        // Drivers declared in this file by their fully qualified name
+        std::map<std::string, ast::NodeDriver*> exports;
+    };
+
+    // Cache of compiled drivers that can be shared between multiple compilers, even across threads.
+    // Drivers are identified by their code, their config and the drivers they depend on
+    class DriverCache {
+    public:
+        using Entry = std::shared_ptr<const CompiledDriver>;
+
+        [[nodiscard]] static auto makeKey(std::string_view code, const std::map<std::string, std::string> &config, const std::vector<Entry> &dependencies) -> std::string;
+
+        // Hash of a placeholder config that doesn't depend on how the config was written down
+        [[nodiscard]] static auto hashConfig(const std::map<std::string, std::string> &config) -> u64;
+
+        // Returns the cached driver or compiles it if it's not cached yet.
+        // If another thread is compiling the same driver already, this waits for its result instead of compiling it again
+        auto getOrCompile(const std::string &key, const std::function<Entry()> &compile) -> Entry;
+
+        [[nodiscard]] auto hits() const -> size_t;
+        [[nodiscard]] auto misses() const -> size_t;
+
+    private:
+        mutable std::mutex m_mutex;
+        std::map<std::string, std::shared_future<Entry>> m_entries;
+        size_t m_hits = 0, m_misses = 0;
+    };
+
+}
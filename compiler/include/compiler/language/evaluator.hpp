@@ -0,0 +1,91 @@
+#pragma once
+
+#include <compiler/types.hpp>
+#include <compiler/language/ast/node.hpp>
+
+#include <expected>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace compiler::language::evaluator {
+
+    enum class EvaluationError {
+        UnknownIdentifier,
+        InvalidOperation,
+        DivisionByZero,
+        IndexOutOfRange,
+        InvalidNumericLiteral,
+        LimitExceeded
+    };
+
+    using EvaluationResult = std::expected<ast::ConstantValue, EvaluationError>;
+
+    // Finds a constant by its name as written in the expression, returns nullptr if there's no such constant
+    using ConstantLookup = std::function<const ast::NodeConstant *(std::string_view name)>;
+
+    // Interprets constant expressions at compile time.
+    // Integer arithmetic is done in 128 bits and wraps around, mixing integers and floats promotes to float like in C
+    class Evaluator {
+    public:
+        explicit Evaluator(ConstantLookup lookup) : m_lookup(std::move(lookup)) { }
+
+        [[nodiscard]] auto evaluate(const ast::NodeExpression &expression) -> EvaluationResult;
+
+        // Evaluates the body of a lambda expression with its parameter bound to the argument
+        [[nodiscard]] auto evaluateLambda(const ast::NodeExpression &lambda, ast::ConstantValue argument) -> EvaluationResult;
+
+    private:
+        auto evaluateIdentifier(const ast::NodeExpression &expression) -> EvaluationResult;
+        auto evaluateUnary(const ast::NodeExpression &expression) -> EvaluationResult;
+        auto evaluateBinary(const ast::NodeExpression &expression) -> EvaluationResult;
+        auto evaluateCall(const ast::NodeExpression &expression) -> EvaluationResult;
+        auto evaluateIndex(const ast::NodeExpression &expression) -> EvaluationResult;
+
+    private:
+        ConstantLookup m_lookup;
+
+        // Lambda parameters currently in scope, innermost last
+        std::vector<std::pair<std::string_view, ast::ConstantValue>> m_bindings;
+
+        // Number of evaluated expressions, bounds the time spent on generated tables and folds
+        u64 m_steps = 0;
+    };
+
+    // Applies an operator to values that are already known, with the same semantics as in constant expressions
+    [[nodiscard]] auto applyUnaryOperator(std::string_view op, const ast::ConstantValue &operand) -> EvaluationResult;
+    [[nodiscard]] auto applyBinaryOperator(std::string_view op, const ast::ConstantValue &left, const ast::ConstantValue &right) -> EvaluationResult;
+
+    // Parses a numeric literal token, including the hexadecimal, binary, octal and floating point forms
+    [[nodiscard]] auto parseNumericLiteral(std::string_view literal) -> EvaluationResult;
+
+    // Converts a value the way C would when assigning it to a variable of the given type
+    [[nodiscard]] auto convert(const ast::ConstantValue &value, const ast::NodeBuiltinType &type) -> ast::ConstantValue;
+
+    // Formats an already converted value as a C literal of the given type
+    [[nodiscard]] auto formatValue(const ast::ConstantValue &value, const ast::NodeBuiltinType &type) -> std::string;
+
+}
+
+template <> struct fmt::formatter<compiler::language::evaluator::EvaluationError>: formatter<std::string_view> {
+    template <typename FormatContext>
+    auto format(compiler::language::evaluator::EvaluationError error, FormatContext& ctx) const {
+        string_view name = "unknown";
+
+        switch (error) {
+            using enum compiler::language::evaluator::EvaluationError;
+            case UnknownIdentifier:     name = "unknown identifier";        break;
+            case InvalidOperation:      name = "invalid operation";         break;
+            case DivisionByZero:        name = "division by zero";          break;
+            case IndexOutOfRange:       name = "index out of range";        break;
+            case InvalidNumericLiteral: name = "invalid numeric literal";   break;
+            case LimitExceeded:         name = "evaluation limit exceeded"; break;
+        }
+
+        return formatter<string_view>::format(name, ctx);
+    }
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <compiler/language/lexer.hpp>
+#include <compiler/language/ast/node.hpp>
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace compiler::language {
+
+    struct Diagnostic {
+        size_t offset = 0, length = 0;
+        std::string message;
+    };
+
+    // A driver declared by a document and where its name is written
+    struct Symbol {
+        ast::NodeDriver *driver = nullptr;
+
+        // Keeps the declaration alive, the driver's AST points into its source
+        std::shared_ptr<const void> owner;
+
+        std::string document;
+        size_t offset = 0, length = 0;
+    };
+
+    using SymbolTable = std::map<std::string, Symbol>;
+
+    // A driver file that is kept parsed while it's being edited.
+    // The document is split into its top level declarations, only declarations whose text changed or
+    // whose referenced drivers changed are parsed again on an update. All others keep their AST
+    class IncrementalDocument {
+    public:
+        IncrementalDocument(std::string name, std::map<std::string, std::string> config = {})
+            : m_name(std::move(name)), m_config(std::move(config)) { }
+
+        // Tokens point into the document's text
+        IncrementalDocument(const IncrementalDocument &) = delete;
+        IncrementalDocument &operator=(const IncrementalDocument &) = delete;
+
+        // Replaces the text of the document. External symbols are the drivers exported by the documents this one depends on
+        auto update(std::string text, const SymbolTable &external) -> void;
+
+        // Looks up the driver that's referenced by the type name at the given offset
+        [[nodiscard]] auto findDefinition(size_t offset) const -> std::optional<Symbol>;
+
+        [[nodiscard]] auto name() const -> const std::string & { return this->m_name; }
+        [[nodiscard]] auto text() const -> const std::string & { return this->m_text; }
+        [[nodiscard]] auto diagnostics() const -> const std::vector<Diagnostic> & { return this->m_diagnostics; }
+
+        // Drivers declared by this document itself
+        [[nodiscard]] auto exports() const -> const SymbolTable & { return this->m_exports; }
+
+        // Number of declarations that were reused or parsed again by the last update
+        [[nodiscard]] auto reused() const -> size_t { return this->m_reused; }
+        [[nodiscard]] auto reparsed() const -> size_t { return this->m_reparsed; }
+
+    private:
+        struct Declaration;
+
+        struct Entry {
+            std::shared_ptr<const Declaration> declaration;
+            std::vector<std::string> namespaces;
+
+            // Range of the declaration in the document
+            size_t begin = 0, end = 0;
+        };
+
+        // Lexes the changed part of the text again, tokens before and after it are kept
+        auto relex(std::string_view previousText, std::vector<Diagnostic> &diagnostics) -> void;
+        auto split() -> std::vector<Entry>;
+
+        // Declared symbols are the drivers declared above the declaration in the same document
+        auto parse(const Entry &entry, std::string source, size_t prefixLength, const SymbolTable &declared) const -> std::shared_ptr<const Declaration>;
+        [[nodiscard]] auto isReusable(const Declaration &declaration, const SymbolTable &declared) const -> bool;
+
+        [[nodiscard]] static auto findSymbol(const SymbolTable &declared, const SymbolTable &external, const std::string &name) -> const Symbol *;
+        [[nodiscard]] static auto getFullName(const std::vector<std::string> &namespaces, std::string_view name) -> std::string;
+
+        [[nodiscard]] auto toDocumentOffset(const Entry &entry, size_t offset) const -> size_t;
+
+    private:
+        std::string m_name;
+        std::map<std::string, std::string> m_config;
+
+        std::string m_text;
+        std::vector<lexer::Token> m_tokens;
+        bool m_lexError = false;
+
+        std::vector<Entry> m_entries;
+        std::vector<Diagnostic> m_diagnostics;
+        SymbolTable m_external, m_exports;
+
+        size_t m_reused = 0, m_reparsed = 0;
+    };
+
+}
@@ -35,6 +35,16 @@ namespace compiler::language::lexer {
 
         [[nodiscard]] auto value() -> std::string_view& { return m_value; }
 
+        // Byte range of the token in the lexed source. Tokens expanded from a placeholder cover the entire placeholder
+        [[nodiscard]] auto offset() const -> size_t { return m_offset; }
+        [[nodiscard]] auto length() const -> size_t { return m_length; }
+
+        auto setLocation(size_t offset, size_t length) -> void {
+            this->m_offset = offset;
+            this->m_length = length;
+        }
+
+        // The location is intentionally not compared, tokens are equal if they mean the same thing
         auto operator==(const Token &other) const -> bool {
             return this->m_type == other.m_type && this->m_value == other.m_value;
         }
@@ -42,6 +52,7 @@ namespace compiler::language::lexer {
     private:
         Type m_type = Type::EndOfInput;
         std::string_view m_value;
+        size_t m_offset = 0, m_length = 0;
     };
 
     struct LexedData {
@@ -63,21 +74,39 @@ namespace compiler::language::lexer {
     constexpr static inline auto KeywordDriver              = Token(Token::Type::Keyword, "driver");
     constexpr static inline auto KeywordFunction            = Token(Token::Type::Keyword, "fn");
     constexpr static inline auto KeywordNamespace           = Token(Token::Type::Keyword, "namespace");
+    constexpr static inline auto KeywordConst               = Token(Token::Type::Keyword, "const");
+    constexpr static inline auto KeywordRegister            = Token(Token::Type::Keyword, "register");
+    constexpr static inline auto KeywordBurst               = Token(Token::Type::Keyword, "burst");
+    constexpr static inline auto KeywordAsync               = Token(Token::Type::Keyword, "async");
+    constexpr static inline auto KeywordIsr                 = Token(Token::Type::Keyword, "isr");
+    constexpr static inline auto KeywordStruct              = Token(Token::Type::Keyword, "struct");
 
     constexpr static inline auto RawCodeBlock               = Token(Token::Type::RawCodeBlock);
 
     constexpr static inline auto BuiltinType                = Token(Token::Type::BuiltinType);
+    constexpr static inline auto BuiltinTypeBytes           = Token(Token::Type::BuiltinType, "bytes");
 
     constexpr static inline auto SeparatorOpenBrace         = Token(Token::Type::Separator, "{");
     constexpr static inline auto SeparatorCloseBrace        = Token(Token::Type::Separator, "}");
     constexpr static inline auto SeparatorOpenParenthesis   = Token(Token::Type::Separator, "(");
     constexpr static inline auto SeparatorCloseParenthesis  = Token(Token::Type::Separator, ")");
     constexpr static inline auto SeparatorSemicolon         = Token(Token::Type::Separator, ";");
+    constexpr static inline auto SeparatorOpenBracket       = Token(Token::Type::Separator, "[");
+    constexpr static inline auto SeparatorCloseBracket      = Token(Token::Type::Separator, "]");
     constexpr static inline auto SeparatorComma             = Token(Token::Type::Separator, ",");
 
     constexpr static inline auto OperatorColon              = Token(Token::Type::Operator, ":");
     constexpr static inline auto OperatorLessThan           = Token(Token::Type::Operator, "<");
     constexpr static inline auto OperatorGreaterThan        = Token(Token::Type::Operator, ">");
+    constexpr static inline auto OperatorAssign             = Token(Token::Type::Operator, "=");
+    constexpr static inline auto OperatorQuestionMark       = Token(Token::Type::Operator, "?");
+    constexpr static inline auto OperatorLambda             = Token(Token::Type::Operator, "=>");
+    constexpr static inline auto OperatorArrow              = Token(Token::Type::Operator, "->");
+    constexpr static inline auto OperatorAt                 = Token(Token::Type::Operator, "@");
+    constexpr static inline auto OperatorDot                = Token(Token::Type::Operator, ".");
+
+    // Any operator, the parser decides what it means based on its value
+    constexpr static inline auto Operator                   = Token(Token::Type::Operator);
 
     constexpr static inline auto Identifier                 = Token(Token::Type::Identifier);
 
@@ -88,6 +117,7 @@ namespace compiler::language::lexer {
     using LexResult = std::expected<LexedData, LexError>;
     using TokenGenerator = hlp::Generator<std::expected<Token, LexError>>;
 
+    // Lexes the source into tokens. On error, source is left pointing at the offending input
     auto lex(std::string_view &source, const std::map<std::string, std::string> &placeholders) -> TokenGenerator;
 
 }
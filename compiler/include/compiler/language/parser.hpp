@@ -4,6 +4,8 @@
 #include <compiler/language/lexer.hpp>
 #include <compiler/language/ast/node.hpp>
 
+#include <optional>
+#include <string_view>
 #include <vector>
 
 namespace compiler::language::parser {
@@ -13,6 +15,29 @@ namespace compiler::language::parser {
         EndOfInput,
         UnknownType,
         InvalidTemplateParameterCount,
+        UnknownIdentifier,
+        InvalidConstantExpression,
+        RedefinedConstant,
+        InvalidArgumentCount,
+        InvalidExpressionType,
+        UnknownReturnType,
+        InvalidRegister,
+        InvalidBurst,
+        InvalidAsyncFunction,
+        InvalidBuffer,
+        InvalidStruct,
+        InvalidPriority,
+        InvalidMemoryMap,
+        InvalidFunctionAttributes,
+        InvalidInterruptHandler,
+    };
+
+    // Type of an expression in a function body. Builtin types have their name and size set, type parameters only their name.
+    // Functions without a return type are "void" and types that can't be inferred, like the ones of string literals, have no name
+    struct ExpressionType {
+        std::string_view name;
+        std::optional<ast::NodeBuiltinType::Type> builtin;
+        size_t size = 0;
     };
 
     template<typename T>
@@ -32,8 +57,22 @@ namespace compiler::language::parser {
             this->m_drivers = std::move(drivers);
         }
 
+        [[nodiscard]] auto takeDrivers() -> std::map<std::string, ast::NodeDriver*> {
+            return std::move(this->m_drivers);
+        }
+
+        // Source location the parser is currently at. After an error, this is the token that couldn't be parsed
+        [[nodiscard]] auto location() const -> std::pair<size_t, size_t> {
+            if (this->m_current != this->m_end)
+                return { this->m_current->offset(), this->m_current->length() };
+            else if (this->m_current != this->m_begin)
+                return { this->m_current[-1].offset() + this->m_current[-1].length(), 0 };
+            else
+                return { 0, 0 };
+        }
+
     private:
-        auto getFullTypeName(std::string_view typeName) -> std::string;
+        auto getFullTypeName(std::string_view typeName) const -> std::string;
 
         [[nodiscard]] auto parseDriver() -> ParseResult<ast::Node>;
         [[nodiscard]] auto parseFunction() -> ParseResult<ast::NodeFunction>;
@@ -41,6 +80,48 @@ namespace compiler::language::parser {
         [[nodiscard]] auto parseParameterList() -> hlp::Generator<ParseResult<ast::NodeVariable>>;
         [[nodiscard]] auto parseNamespace() -> ASTGenerator;
 
+        [[nodiscard]] auto parseConstant() -> ParseResult<ast::NodeConstant>;
+        [[nodiscard]] auto parseRegister() -> ParseResult<ast::NodeRegister>;
+        [[nodiscard]] auto parseBurst() -> ParseResult<ast::NodeBurst>;
+        [[nodiscard]] auto parseBuffer() -> ParseResult<ast::NodeBuffer>;
+        [[nodiscard]] auto parseStruct() -> ParseResult<ast::NodeStruct>;
+        [[nodiscard]] auto parseEndianness() -> std::optional<ast::Endianness>;
+        [[nodiscard]] auto parsePriority() -> std::expected<std::optional<u8>, ParseError>;
+        [[nodiscard]] auto parseBaseAddress() -> std::expected<std::optional<u64>, ParseError>;
+        [[nodiscard]] auto parseFunctionAttributes() -> std::expected<ast::FunctionAttributes, ParseError>;
+
+        // Byte order declared by the driver that's being parsed or the closest driver it inherits from that declares one
+        [[nodiscard]] auto defaultEndianness() const -> std::optional<ast::Endianness>;
+        [[nodiscard]] auto parseUnsignedConstant(u64 limit) -> std::expected<u64, ParseError>;
+        [[nodiscard]] auto parseTemplateValue(const ast::NodeVariable *parameter) -> std::expected<ast::TemplateValue, ParseError>;
+
+        // Expressions are parsed by precedence, from lowest to highest
+        [[nodiscard]] auto parseSequence() -> ParseResult<ast::NodeExpression>;
+        [[nodiscard]] auto parseExpression() -> ParseResult<ast::NodeExpression>;
+        [[nodiscard]] auto parseTernary() -> ParseResult<ast::NodeExpression>;
+        [[nodiscard]] auto parseBinary(u32 minPrecedence) -> ParseResult<ast::NodeExpression>;
+        [[nodiscard]] auto parseUnary() -> ParseResult<ast::NodeExpression>;
+        [[nodiscard]] auto parsePostfix() -> ParseResult<ast::NodeExpression>;
+        [[nodiscard]] auto parsePrimary() -> ParseResult<ast::NodeExpression>;
+        [[nodiscard]] auto parseNested(const lexer::Token &end) -> ParseResult<ast::NodeExpression>;
+
+        // Finds a constant visible from the driver that's currently being parsed, or in another driver if the name is qualified
+        [[nodiscard]] auto findConstant(std::string_view name) const -> const ast::NodeConstant *;
+        [[nodiscard]] auto findRegister(std::string_view name) const -> const ast::NodeRegister *;
+        [[nodiscard]] auto findBuffer(std::string_view name) const -> const ast::NodeBuffer *;
+        [[nodiscard]] auto findStruct(std::string_view name) const -> const ast::NodeStruct *;
+
+        // Checks that an expression only waits for the bus, it must not call functions with a raw code body other than the bus driver's
+        [[nodiscard]] auto checkAsync(const ast::NodeExpression &expression, bool &reads, bool &writes) const -> bool;
+        [[nodiscard]] auto evaluate(const ast::NodeExpression &expression) const -> std::expected<ast::ConstantValue, ParseError>;
+
+        // Checks that every name used in a function body exists and infers the type the expression evaluates to
+        [[nodiscard]] auto inferType(const ast::NodeExpression &expression) const -> std::expected<ExpressionType, ParseError>;
+
+        // Finds a function declared before the current one in the same driver or in one of the drivers it inherits from
+        [[nodiscard]] auto findFunction(std::string_view name) const -> const ast::NodeFunction *;
+        [[nodiscard]] auto isTypeParameter(std::string_view name) const -> bool;
+
     private:
         [[nodiscard]] auto peek() const -> const lexer::Token & {
             return *this->m_current;
@@ -77,11 +158,32 @@ namespace compiler::language::parser {
         }
 
     private:
+        std::vector<lexer::Token>::const_iterator m_begin;
         std::vector<lexer::Token>::const_iterator m_current;
         std::vector<lexer::Token>::const_iterator m_end;
 
         std::map<std::string, ast::NodeDriver*> m_drivers;
         std::vector<std::string_view> m_namespaces;
+
+        // Constants, registers, bursts, buffers and structs declared so far in the driver that's being parsed and the driver it inherits from
+        const std::vector<std::unique_ptr<ast::NodeConstant>> *m_constants = nullptr;
+        const std::vector<std::unique_ptr<ast::NodeRegister>> *m_registers = nullptr;
+        const std::vector<std::unique_ptr<ast::NodeBurst>> *m_bursts = nullptr;
+        const std::vector<std::unique_ptr<ast::NodeBuffer>> *m_buffers = nullptr;
+        const std::vector<std::unique_ptr<ast::NodeStruct>> *m_structs = nullptr;
+        const ast::NodeDriver *m_inheritance = nullptr;
+        std::optional<ast::Endianness> m_endianness;
+        bool m_memoryMapped = false;
+
+        // Scope of the function that's being parsed, the driver's template parameters and functions declared before it
+        const std::vector<std::unique_ptr<ast::NodeVariable>> *m_templateParameters = nullptr;
+        const std::vector<std::unique_ptr<ast::NodeFunction>> *m_functions = nullptr;
+        const std::vector<std::unique_ptr<ast::NodeVariable>> *m_parameters = nullptr;
+        std::vector<std::string_view> m_typeParameters;
+
+        // Inside template argument lists, '>' closes the list instead of being a comparison unless it's in parentheses
+        bool m_templateArguments = false;
+        u32 m_expressionDepth = 0;
     };
 
 }
@@ -97,6 +199,21 @@ template <> struct fmt::formatter<compiler::language::parser::ParseError>: forma
             case EndOfInput:      name = "end of input";     break;
             case UnknownType:     name = "unknown type";     break;
             case InvalidTemplateParameterCount: name = "invalid template parameter count"; break;
+            case UnknownIdentifier: name = "unknown identifier"; break;
+            case InvalidConstantExpression: name = "invalid constant expression"; break;
+            case RedefinedConstant: name = "redefined constant"; break;
+            case InvalidArgumentCount: name = "invalid argument count"; break;
+            case InvalidExpressionType: name = "invalid expression type"; break;
+            case UnknownReturnType: name = "return type can't be inferred"; break;
+            case InvalidRegister: name = "invalid register declaration"; break;
+            case InvalidBurst: name = "invalid burst declaration"; break;
+            case InvalidAsyncFunction: name = "function can't be async"; break;
+            case InvalidBuffer: name = "invalid buffer declaration"; break;
+            case InvalidStruct: name = "invalid struct declaration"; break;
+            case InvalidPriority: name = "invalid driver priority"; break;
+            case InvalidMemoryMap: name = "invalid memory mapped driver"; break;
+            case InvalidFunctionAttributes: name = "invalid function attributes"; break;
+            case InvalidInterruptHandler: name = "invalid interrupt handler"; break;
         }
 
         return formatter<string_view>::format(name, ctx);
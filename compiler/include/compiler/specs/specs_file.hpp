@@ -8,6 +8,7 @@
 namespace compiler::specs {
 
     struct Driver {
+        std::filesystem::path path;
         std::string code;
         std::map<std::string, std::string> config;
         std::vector<std::string> dependencies;
@@ -17,13 +18,20 @@ namespace compiler::specs {
     public:
         SpecsFile() = default;
         explicit SpecsFile(const std::filesystem::path &path);
+        explicit SpecsFile(std::map<std::string, Driver> drivers) : m_drivers(std::move(drivers)) { }
 
         [[nodiscard]] auto drivers() const -> const std::map<std::string, Driver>& {
             return m_drivers;
         }
 
+        // The specs file itself followed by every driver file it referenced
+        [[nodiscard]] auto inputFiles() const -> const std::vector<std::filesystem::path>& {
+            return m_inputFiles;
+        }
+
     private:
         std::map<std::string, Driver> m_drivers;
+        std::vector<std::filesystem::path> m_inputFiles;
     };
 
 }
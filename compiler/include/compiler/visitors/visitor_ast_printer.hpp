@@ -2,119 +2,353 @@
 
 #include <compiler/language/ast/node.hpp>
 
+#include <iterator>
+#include <string>
+#include <utility>
+
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+
 namespace compiler::visitor {
 
     using namespace compiler::language;
     using namespace compiler::language::ast;
 
-    struct VisitorASTPrinter : Visitor {
+    struct VisitorASTPrinter final : Visitor {
         auto visit(const NodeDriver &node) -> void override{
             this->handleIndent();
 
-            fmt::print("driver {}", node.name());
+            this->print("driver {}", node.name());
 
             if (!node.templateParameters().empty()) {
-                fmt::print("<");
+                this->print("<");
                 for (size_t i = 0; i < node.templateParameters().size(); i++) {
-                    node.templateParameters()[i]->accept(*this);
+                    this->visit(*node.templateParameters()[i]);
 
                     if (i != node.templateParameters().size() - 1)
-                        fmt::print(", ");
+                        this->print(", ");
                 }
-                fmt::print("> ");
+                this->print("> ");
             } else {
-                fmt::print(" ");
+                this->print(" ");
             }
 
             if (node.inheritance() != nullptr) {
-                fmt::print(": {}", node.inheritance()->name());
+                this->print(": {}", node.inheritance()->name());
 
                 if (auto &values = node.inheritance()->templateValues(); !values.empty()) {
-                    fmt::print("<");
+                    this->print("<");
                     for (size_t i = 0; i < values.size(); i++) {
                         auto &value = values[i];
 
-                        switch (value.type()) {
+                        switch (value.type) {
                             case lexer::Token::Type::StringLiteral:
-                                fmt::print("\"{}\"", value.value());
+                                this->print("\"{}\"", value.value);
                                 break;
                             case lexer::Token::Type::NumericLiteral:
-                                fmt::print("{}", value.value());
+                                this->print("{}", value.value);
                                 break;
                             case lexer::Token::Type::CharacterLiteral:
-                                fmt::print("'{}'", value.value());
+                                this->print("'{}'", value.value);
                                 break;
                             default:
                                 break;
                         }
 
                         if (i != values.size() - 1)
-                            fmt::print(", ");
+                            this->print(", ");
                     }
-                    fmt::print("> ");
+                    this->print("> ");
                 } else {
-                    fmt::print(" ");
+                    this->print(" ");
                 }
             }
 
-            fmt::print("{{\n\n");
+            if (node.endianness().has_value())
+                this->print("{} ", endiannessName(*node.endianness()));
+            if (node.priority().has_value())
+                this->print("priority({}) ", *node.priority());
+            if (node.baseAddress().has_value())
+                this->print("mmio(0x{:08X}) ", *node.baseAddress());
+            this->printAttributes(node.functionAttributes());
+
+            this->print("{{\n\n");
 
             this->increaseIndent();
+            for (auto &constant : node.constants()) {
+                this->visit(*constant);
+            }
+            for (auto &declaration : node.registers()) {
+                this->visit(*declaration);
+            }
+            for (auto &burst : node.bursts()) {
+                this->visit(*burst);
+            }
+            for (auto &buffer : node.buffers()) {
+                this->visit(*buffer);
+            }
+            for (auto &declaration : node.structs()) {
+                this->visit(*declaration);
+            }
             for (auto &function : node.functions()) {
-                function->accept(*this);
+                this->visit(*function);
             }
             this->decreaseIndent();
 
             this->handleIndent();
-            fmt::print("}}\n\n");
+            this->print("}}\n\n");
         }
 
         auto visit(const NodeFunction &node) -> void override {
             this->handleIndent();
 
-            fmt::print("fn {}(", node.name());
+            if (node.isInterruptHandler())
+                this->print("isr(\"{}\") ", node.interrupt());
+            this->print("{}fn {}", node.isAsync() ? "async " : "", node.name());
+            if (!node.typeParameters().empty())
+                this->print("<{}>", fmt::join(node.typeParameters(), ", "));
+            this->print("(");
 
             auto &parameters = node.parameters();
             for (size_t i = 0; i < parameters.size(); i++) {
-                node.parameters()[i]->accept(*this);
+                this->visit(*node.parameters()[i]);
 
                 if (i != parameters.size() - 1)
-                    fmt::print(", ");
+                    this->print(", ");
             }
-            fmt::print(") {{\n");
+            this->print(") ");
+
+            if (node.returnType() != nullptr) {
+                this->print("-> ");
+                this->visit(*node.returnType());
+            }
+            this->printAttributes(node.attributes());
+
+            if (node.expression() != nullptr) {
+                this->print("=> ");
+                this->visit(*node.expression());
+                this->print(";\n\n");
+                return;
+            }
+
+            this->print("{{\n");
 
             this->increaseIndent();
             for (auto &statement : node.body()) {
-                statement->accept(*this);
+                ast::dispatch(*statement, *this);
             }
             this->decreaseIndent();
 
             this->handleIndent();
-            fmt::print("}}\n\n");
+            this->print("}}\n\n");
 
         }
 
         auto visit(const NodeVariable &node) -> void override {
-            node.type()->accept(*this);
-            fmt::print("{}", node.name());
+            this->visit(*node.type());
+            this->print("{}", node.name());
         }
 
         auto visit(const NodeBuiltinType &node) -> void override {
-            fmt::print("(0x{:02X}) ", node.size());
+            this->print("(0x{:02X}) ", node.size());
         }
 
         auto visit(const NodeType &node) -> void override {
-            fmt::print("{} ", node.name());
-            node.type()->accept(*this);
+            this->print("{} ", node.name());
+            if (!node.isTypeParameter())
+                ast::dispatch(*node.type(), *this);
         }
 
         auto visit(const NodeRawCodeBlock &node) -> void override {
             this->handleIndent();
 
-            fmt::print("{}\n", node.code());
+            this->print("{}\n", node.code());
+        }
+
+        auto visit(const NodeExpression &node) -> void override {
+            using enum NodeExpression::Operation;
+
+            const auto &operands = node.operands();
+            switch (node.operation()) {
+                case NumericLiteral:
+                case Identifier:
+                    this->print("{}", node.value());
+                    break;
+                case StringLiteral:
+                    this->print("\"{}\"", node.value());
+                    break;
+                case CharacterLiteral:
+                    this->print("'{}'", node.value());
+                    break;
+                case UnaryOperator:
+                    this->print("{}", node.value());
+                    this->visit(*operands[0]);
+                    break;
+                case BinaryOperator:
+                    // Every operation is parenthesized so the printed tree can't be misread
+                    this->print("(");
+                    this->visit(*operands[0]);
+                    this->print(" {} ", node.value());
+                    this->visit(*operands[1]);
+                    this->print(")");
+                    break;
+                case TernaryOperator:
+                    this->print("(");
+                    this->visit(*operands[0]);
+                    this->print(" ? ");
+                    this->visit(*operands[1]);
+                    this->print(" : ");
+                    this->visit(*operands[2]);
+                    this->print(")");
+                    break;
+                case Call:
+                    this->print("{}", node.value());
+                    if (!node.typeArguments().empty())
+                        this->print("<{}>", fmt::join(node.typeArguments(), ", "));
+                    this->print("(");
+                    this->printList(operands);
+                    this->print(")");
+                    break;
+                case Index:
+                    this->visit(*operands[0]);
+                    this->print("[");
+                    this->visit(*operands[1]);
+                    this->print("]");
+                    break;
+                case Lambda:
+                    this->print("{} => ", node.value());
+                    this->visit(*operands[0]);
+                    break;
+                case Array:
+                    this->print("[");
+                    this->printList(operands);
+                    this->print("]");
+                    break;
+                case Field:
+                    this->visit(*operands[0]);
+                    this->print(".{}", node.value());
+                    break;
+                case Assignment:
+                    this->print("(");
+                    this->visit(*operands[0]);
+                    this->print(" = ");
+                    this->visit(*operands[1]);
+                    this->print(")");
+                    break;
+                case Sequence:
+                    this->printList(operands);
+                    break;
+            }
+        }
+
+        auto visit(const NodeConstant &node) -> void override {
+            this->handleIndent();
+
+            this->print("const ");
+            this->visit(*node.type());
+            this->print("{}", node.name());
+            if (node.isTable())
+                this->print("[{}]", node.values().size());
+            this->print(" = ");
+            this->visit(*node.expression());
+            this->print(";\n\n");
+        }
+
+        auto visit(const NodeRegister &node) -> void override {
+            this->handleIndent();
+
+            this->print("register ");
+            this->visit(*node.type());
+            this->print("{} @ 0x{:02X} {}{}", node.name(), node.address(), accessName(node.access()), node.isCached() ? " cached" : "");
+            if (node.endianness().has_value())
+                this->print(" {}", endiannessName(*node.endianness()));
+            this->print(" {{\n");
+
+            this->increaseIndent();
+            for (const auto &field : node.fields()) {
+                this->handleIndent();
+                this->visit(*field.type);
+                this->print("{} @ {} : {};\n", field.name, field.offset, field.width);
+            }
+            this->decreaseIndent();
+
+            this->handleIndent();
+            this->print("}}\n\n");
+        }
+
+        auto visit(const NodeBurst &node) -> void override {
+            this->handleIndent();
+            this->print("burst {} {{ {} }}\n\n", node.name(), fmt::join(node.registers(), ", "));
+        }
+
+        auto visit(const NodeBuffer &node) -> void override {
+            this->handleIndent();
+            this->print("bytes {}[{}]", node.name(), node.size());
+            if (node.alignment() != 0)
+                this->print(" aligned({})", node.alignment());
+            if (!node.section().empty())
+                this->print(" section(\"{}\")", node.section());
+            this->print(";\n\n");
+        }
+
+        auto visit(const NodeStruct &node) -> void override {
+            this->handleIndent();
+            this->print("struct {} {} {{\n", node.name(), endiannessName(node.endianness()));
+
+            this->increaseIndent();
+            for (const auto &field : node.fields()) {
+                this->handleIndent();
+                this->visit(*field.type);
+                this->print("{} @ {} : {} {};\n", field.name, field.offset, field.width, endiannessName(field.endianness));
+            }
+            this->decreaseIndent();
+
+            this->handleIndent();
+            this->print("}}\n\n");
+        }
+
+        [[nodiscard]] auto output() const -> const std::string & {
+            return this->m_output;
         }
 
     private:
+        template<typename ... Args>
+        auto print(fmt::format_string<Args...> format, Args &&...args) -> void {
+            fmt::format_to(std::back_inserter(this->m_output), format, std::forward<Args>(args)...);
+        }
+
+        static auto accessName(NodeRegister::Access access) -> std::string_view {
+            switch (access) {
+                case NodeRegister::Access::Read:    return "r";
+                case NodeRegister::Access::Write:   return "w";
+                default:                            return "rw";
+            }
+        }
+
+        static auto endiannessName(Endianness endianness) -> std::string_view {
+            return endianness == Endianness::Big ? "big" : "little";
+        }
+
+        auto printAttributes(const FunctionAttributes &attributes) -> void {
+            if (attributes.temperature != FunctionAttributes::Temperature::Default)
+                this->print("{} ", attributes.temperature == FunctionAttributes::Temperature::Hot ? "hot" : "cold");
+            if (attributes.inlining != FunctionAttributes::Inlining::Default)
+                this->print("{} ", attributes.inlining == FunctionAttributes::Inlining::Always ? "inline" : "noinline");
+            if (attributes.section == ".ramfunc")
+                this->print("ramfunc ");
+            else if (!attributes.section.empty())
+                this->print("ramfunc(\"{}\") ", attributes.section);
+        }
+
+        auto printList(const std::vector<std::unique_ptr<NodeExpression>> &expressions) -> void {
+            for (size_t i = 0; i < expressions.size(); i++) {
+                if (i != 0)
+                    this->print(", ");
+
+                this->visit(*expressions[i]);
+            }
+        }
+
         auto increaseIndent() -> void {
             m_indent++;
         }
@@ -123,13 +357,14 @@ namespace compiler::visitor {
             m_indent--;
         }
 
-        auto handleIndent() const -> void {
-            for (size_t i = 0; i < m_indent; i++) {
-                fmt::print("    ");
-            }
+        auto handleIndent() -> void {
+            this->m_output.append(m_indent * 4, ' ');
         }
 
         size_t m_indent = 0;
+
+        // Everything is rendered into one buffer so printing a large AST doesn't cost a locked write per fragment
+        std::string m_output;
     };
 
 }
\ No newline at end of file
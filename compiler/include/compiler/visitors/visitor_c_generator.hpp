@@ -1,10 +1,20 @@
 #pragma once
 
+#include <compiler/helpers/names.hpp>
+#include <compiler/ir/c_backend.hpp>
+#include <compiler/ir/lowering.hpp>
 #include <compiler/language/ast/node.hpp>
+#include <compiler/language/evaluator.hpp>
 
 #include <wolv/utils/string.hpp>
 
+#include <algorithm>
+#include <bit>
+#include <map>
+#include <ranges>
 #include <string>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace compiler::visitor {
@@ -12,7 +22,13 @@ namespace compiler::visitor {
     using namespace compiler::language;
     using namespace compiler::language::ast;
 
-    struct VisitorCGenerator : Visitor {
+    struct VisitorCGenerator final : Visitor {
+        VisitorCGenerator() = default;
+
+        // The lowering refers back to the generator to resolve calls
+        VisitorCGenerator(const VisitorCGenerator &) = delete;
+        auto operator=(const VisitorCGenerator &) -> VisitorCGenerator & = delete;
+
         auto visit(const NodeDriver &node) -> void override {
             this->pushPrefix(node);
 
@@ -20,63 +36,78 @@ namespace compiler::visitor {
                 this->m_templateParameters.emplace_back(parameter.get(), lexer::Token());
             }
 
-            {
-                const auto &inheritance = node.inheritance();
-                if (inheritance != nullptr) {
-                    this->pushPrefix(*inheritance);
-
-                    const auto &templateParameters = inheritance->templateParameters();
-                    const auto &templateValues = inheritance->templateValues();
+            for (auto instance = node.inheritedInstance(); instance != nullptr; instance = instance->inheritedInstance())
+                this->instantiateDriver(*instance);
 
-                    for (size_t i = 0; i < templateParameters.size(); i++) {
-                        auto templateParameterFunction = fmt::format("static {} {}_{}() {{ return {}; }}\n",
-                                                                     templateParameters[i]->type()->name(),
-                                                                     this->m_prefixes.back(),
-                                                                     templateParameters[i]->name(),
-                                                                     templateValues[i].value());
+            this->m_driver = &node;
 
-                        this->m_forwardDecls += templateParameterFunction;
-                    }
-
-                    this->popPrefix();
-                }
+            // Registers of devices with a different byte order than the host's are converted by the accessors and bus operations
+            if (auto endianness = this->deviceEndianness(); endianness.has_value())
+                this->addByteOrderHelpers(*endianness);
+            for (auto &declaration : node.registers()) {
+                if (declaration->endianness().has_value())
+                    this->addByteOrderHelpers(*declaration->endianness());
             }
 
-            for (auto &child : node.functions())
-                child->accept(*this);
+            for (auto &constant : node.constants())
+                this->visit(*constant);
 
-            this->m_templateParameters.clear();
+            for (auto &buffer : node.buffers())
+                this->visit(*buffer);
 
-            this->popPrefix();
-        }
+            for (auto &declaration : node.structs())
+                this->visit(*declaration);
 
-        auto visit(const NodeFunction &node) -> void override {
-            std::string function = fmt::format("static void {}_{}(", this->m_prefixes.back(), node.name());
+            if (node.isMemoryMapped() && !node.registers().empty())
+                this->addRegisterOverlay(node);
 
-            for (size_t i = 0; i < node.parameters().size(); i++) {
-                auto &parameter = node.parameters()[i];
+            for (auto &declaration : node.registers())
+                this->visit(*declaration);
 
-                function += fmt::format("{} {}", parameter->type()->name(), parameter->name());
+            // Drops the copies of all cached registers at once, for example after the device has been reset
+            if (std::ranges::any_of(node.registers(), &NodeRegister::isCached)) {
+                std::string statements;
+                for (auto &declaration : node.registers()) {
+                    if (declaration->isCached())
+                        statements += fmt::format("{}{}_{}_invalidate();", statements.empty() ? "" : "\n", this->m_prefixes.back(), declaration->name());
+                }
 
-                if (i != node.parameters().size() - 1)
-                    function += ", ";
+                this->addFunction(fmt::format("void {}_invalidateRegisters()", this->m_prefixes.back()), statements);
             }
 
-            function += ")";
+            for (auto &burst : node.bursts())
+                this->visit(*burst);
 
-            this->m_source += function + " {\n";
-            this->m_forwardDecls += function + ";\n";
+            // Functions of drivers with template parameters are generated for every set of template values the driver is inherited with
+            bool instantiated = !node.templateParameters().empty() && node.templateValues().empty();
+            if (!instantiated) {
+                for (auto &child : node.functions())
+                    this->visit(*child);
 
-            for (auto &[parameter, value] : this->m_templateParameters) {
-                this->m_source += fmt::format("    const {} {} = {}_{}();\n", parameter->type()->name(), parameter->name(), this->m_prefixes.back(), parameter->name());
+                this->addPoll(node);
             }
 
-            this->m_source += "\n";
+            this->m_templateParameters.clear();
+            this->m_driver = nullptr;
 
-            for (auto &child : node.body())
-                child->accept(*this);
+            // The driver's AST may be released after this, lowered functions refer to it
+            this->m_lowering.clear();
 
-            this->m_source += "}\n\n";
+            this->popPrefix();
+        }
+
+        auto visit(const NodeFunction &node) -> void override {
+            // Generic functions are emitted once for every set of types they're called with
+            if (!node.typeParameters().empty())
+                return;
+
+            auto name = fmt::format("{}_{}", this->m_prefixes.back(), node.name());
+            this->m_source += this->generateFunction(node, name);
+
+            if (node.isAsync())
+                this->generateStateMachine(node, name);
+            if (node.isInterruptHandler())
+                this->addInterruptHandler(node, name);
         }
 
         auto visit(const NodeVariable &node) -> void override {
@@ -97,20 +128,1112 @@ namespace compiler::visitor {
             }
         }
 
+        auto visit(const NodeExpression &node) -> void override {
+            // Expressions are evaluated by the parser, only their values end up in the generated code
+        }
+
+        auto visit(const NodeConstant &node) -> void override {
+            const auto &type = node.builtinType();
+            const auto &values = node.values();
+
+            if (!node.isTable()) {
+                this->m_forwardDecls += fmt::format("static const {} {}_{} = {};\n", node.type()->name(), this->m_prefixes.back(), node.name(), evaluator::formatValue(values.front(), type));
+                return;
+            }
+
+            this->m_forwardDecls += fmt::format("static const {} {}_{}[{}] = {{", node.type()->name(), this->m_prefixes.back(), node.name(), values.size());
+            for (size_t i = 0; i < values.size(); i++) {
+                this->m_forwardDecls += i % 8 == 0 ? "\n    " : " ";
+                this->m_forwardDecls += evaluator::formatValue(values[i], type);
+
+                if (i != values.size() - 1)
+                    this->m_forwardDecls += ',';
+            }
+            this->m_forwardDecls += "\n};\n";
+        }
+
+        auto visit(const NodeRegister &node) -> void override {
+            const auto &prefix = this->m_prefixes.back();
+            auto type = node.type()->name();
+            auto unsignedType = fmt::format("u{}", node.builtinType().size() * 8);
+
+            // Fields get their mask and shift, plus accessors to extract them from and insert them into a value of the register
+            for (const auto &field : node.fields()) {
+                auto name = fmt::format("{}_{}_{}", prefix, node.name(), field.name);
+                auto mask = (field.width == 64 ? ~u64(0) : (u64(1) << field.width) - 1) << field.offset;
+                bool flag = field.type->name() == "bool";
+
+                this->m_forwardDecls += fmt::format("static const {} {}_Mask = 0x{:0{}X};\n", unsignedType, name, mask, node.builtinType().size() * 2);
+                this->m_forwardDecls += fmt::format("static const u8 {}_Shift = {};\n", name, field.offset);
+
+                this->addFunction(fmt::format("{} {}_get({} value)", field.type->name(), name, type), flag
+                    ? fmt::format("return (value & {0}_Mask) != 0;", name)
+                    : fmt::format("return ({1})((({2})value & {0}_Mask) >> {0}_Shift);", name, field.type->name(), unsignedType));
+                this->addFunction(fmt::format("{} {}_set({} value, {} field)", type, name, type, field.type->name()),
+                    fmt::format("return ({1})((({2})value & ({2})~{0}_Mask) | ((({2})field << {0}_Shift) & {0}_Mask));", name, type, unsignedType));
+            }
+
+            // Registers are transferred through the bus driver, fields are updated by reading, modifying and writing the register
+            auto busFunction = [&](std::string_view functionName) -> std::string {
+                return this->busFunction(functionName, { std::string(type) });
+            };
+
+            // Values are converted between the register's byte order and the host's right at the bus, everything else sees them in the host's
+            auto convert = [&](const std::string &value) -> std::string {
+                if (!node.endianness().has_value())
+                    return value;
+
+                return ir::convertByteOrder(value, ir::Type::fromBuiltin(node.builtinType()), *node.endianness());
+            };
+
+            auto name = fmt::format("{}_{}", prefix, node.name());
+            auto read = [&] { return convert(fmt::format("{}(0x{:02X})", busFunction("readRegister"), node.address())); };
+            auto write = [&] { return fmt::format("{}(0x{:02X}, {});", busFunction("writeRegister"), node.address(), convert("value")); };
+            if (node.isMemoryMapped()) {
+                // Registers of memory mapped peripherals are accessed in place through the overlay, every access is a single load or store
+                auto member = fmt::format("{}_registers->{}", prefix, node.name());
+                if (node.isReadable())
+                    this->addFunction(fmt::format("{} {}_read()", type, name), fmt::format("return {};", member));
+                if (node.isWritable())
+                    this->addFunction(fmt::format("void {}_write({} value)", name, type), fmt::format("{} = value;", member));
+            } else if (node.isCached()) {
+                // Cached registers keep a copy in RAM. It's filled by the first read, updated by every write and dropped by invalidating it
+                this->m_forwardDecls += fmt::format("static {} {}_cache;\nstatic bool {}_cacheValid;\n", type, name, name);
+
+                this->addFunction(fmt::format("{} {}_read()", type, name), fmt::format("if (!{0}_cacheValid) {{\n    {0}_cache = {1};\n    {0}_cacheValid = true;\n}}\nreturn {0}_cache;", name, read()));
+                if (node.isWritable())
+                    this->addFunction(fmt::format("void {}_write({} value)", name, type), fmt::format("{1}\n{0}_cache = value;\n{0}_cacheValid = true;", name, write()));
+                this->addFunction(fmt::format("void {}_invalidate()", name), fmt::format("{}_cacheValid = false;", name));
+            } else {
+                if (node.isReadable())
+                    this->addFunction(fmt::format("{} {}_read()", type, name), fmt::format("return {};", read()));
+                if (node.isWritable())
+                    this->addFunction(fmt::format("void {}_write({} value)", name, type), write());
+            }
+
+            for (const auto &field : node.fields()) {
+                auto fieldName = fmt::format("{}_{}", name, field.name);
+
+                if (node.isReadable())
+                    this->addFunction(fmt::format("{} {}_read()", field.type->name(), fieldName), fmt::format("return {0}_get({1}_read());", fieldName, name));
+                if (node.isReadable() && node.isWritable())
+                    this->addFunction(fmt::format("void {}_write({} field)", fieldName, field.type->name()), fmt::format("{1}_write({0}_set({1}_read(), field));", fieldName, name));
+            }
+        }
+
+        auto visit(const NodeBurst &node) -> void override {
+            // The parser made sure all of the registers exist
+            std::vector<const NodeRegister *> registers;
+            for (auto name : node.registers())
+                registers.push_back(this->findRegister(name));
+
+            this->addBurst(fmt::format("{}_{}", this->m_prefixes.back(), node.name()), registers);
+        }
+
+        auto visit(const NodeBuffer &node) -> void override {
+            std::vector<std::string> attributes;
+            if (node.alignment() != 0)
+                attributes.push_back(fmt::format("aligned({})", node.alignment()));
+            if (!node.section().empty())
+                attributes.push_back(fmt::format("section(\"{}\")", node.section()));
+
+            this->m_forwardDecls += fmt::format("static u8 {}_{}[{}]", this->m_prefixes.back(), node.name(), node.size());
+            if (!attributes.empty())
+                this->m_forwardDecls += fmt::format(" __attribute__(({}))", fmt::join(attributes, ", "));
+            this->m_forwardDecls += ";\n";
+        }
+
+        auto visit(const NodeStruct &node) -> void override {
+            auto name = fmt::format("{}_{}", this->m_prefixes.back(), node.name());
+            bool overlay = node.isOverlay();
+            this->addInclude("string.h");
+
+            // Frames that can be overlaid are mirrored byte for byte by a packed struct, skipped bytes become reserved members.
+            // Others get a regular struct their fields are decoded into one by one
+            std::string members;
+            u32 offset = 0;
+            for (const auto &field : node.fields()) {
+                if (overlay && field.offset != offset)
+                    members += fmt::format("    u8 _reserved{}[{}];\n", offset, field.offset - offset);
+                members += fmt::format("    {} {};\n", field.type->name(), field.name);
+                offset = field.offset + field.width;
+            }
+
+            this->m_forwardDecls += fmt::format("enum {{ {}_Size = {} }};\n", name, node.size());
+            this->m_forwardDecls += fmt::format("typedef struct{} {{\n{}}} {};\n", overlay ? " __attribute__((packed, may_alias))" : "", members, name);
+
+            // Fields are read from and written to the frame in place, so a single value doesn't need the whole frame to be decoded
+            for (const auto &field : node.fields()) {
+                auto fieldName = fmt::format("{}_{}", name, field.name);
+                this->addFunction(fmt::format("{} {}_get(const u8 *data)", field.type->name(), fieldName), loadField(field));
+                this->addFunction(fmt::format("void {}_set(u8 *data, {} value)", fieldName, field.type->name()), storeField(field));
+            }
+
+            // Fields whose byte order differs from the one of the host are swapped after copying the frame, all others are copied as they are
+            auto swapFields = [&](std::string_view pattern) -> std::string {
+                std::string statements;
+                for (auto endianness : { Endianness::Little, Endianness::Big }) {
+                    std::string swaps;
+                    for (const auto &field : node.fields()) {
+                        if (field.endianness == endianness && field.width > 1)
+                            swaps += fmt::format(fmt::runtime(pattern), name, field.name);
+                    }
+
+                    if (!swaps.empty())
+                        statements += fmt::format("\n#if __BYTE_ORDER__ != {}{}\n#endif", byteOrderMacro(endianness), swaps);
+                }
+
+                return statements;
+            };
+
+            std::string decode, encode;
+            if (overlay) {
+                decode = fmt::format("{} result;\nmemcpy(&result, data, sizeof(result));{}\nreturn result;", name, swapFields("\nresult.{1} = {0}_{1}_get(data);"));
+                encode = fmt::format("memcpy(data, value, sizeof(*value));{}", swapFields("\n{0}_{1}_set(data, value->{1});"));
+            } else {
+                // Reserved bytes are cleared, fields never overlap so there are some if they don't cover the whole frame
+                u32 used = 0;
+                for (const auto &field : node.fields())
+                    used += field.width;
+
+                decode = fmt::format("{} result;", name);
+                encode = used != node.size() ? fmt::format("memset(data, 0, {}_Size);", name) : std::string();
+                for (const auto &field : node.fields()) {
+                    decode += fmt::format("\nresult.{1} = {0}_{1}_get(data);", name, field.name);
+                    encode += fmt::format("{2}{0}_{1}_set(data, value->{1});", name, field.name, encode.empty() ? "" : "\n");
+                }
+                decode += "\nreturn result;";
+            }
+
+            this->addFunction(fmt::format("{0} {0}_decode(const u8 *data)", name), decode);
+            this->addFunction(fmt::format("void {0}_encode(u8 *data, const {0} *value)", name), encode);
+
+            // If the byte order of all fields is the one of the host, received frames can be used without copying them at all
+            if (overlay) {
+                std::optional<Endianness> endianness;
+                bool mixed = false;
+                for (const auto &field : node.fields()) {
+                    if (field.width == 1)
+                        continue;
+
+                    mixed = mixed || (endianness.has_value() && *endianness != field.endianness);
+                    endianness = field.endianness;
+                }
+
+                if (!mixed) {
+                    auto signature = fmt::format("const {0} *{0}_view(const u8 *data)", name);
+                    auto definition = functionDefinition(signature, fmt::format("return (const {} *)data;", name));
+
+                    if (endianness.has_value()) {
+                        auto guard = fmt::format("#if __BYTE_ORDER__ == {}\n", byteOrderMacro(*endianness));
+                        this->m_forwardDecls += fmt::format("{}static inline {};\n#endif\n", guard, signature);
+                        this->m_source += fmt::format("{}{}#endif\n\n", guard, definition.substr(0, definition.size() - 1));
+                    } else {
+                        this->m_forwardDecls += fmt::format("static inline {};\n", signature);
+                        this->m_source += definition;
+                    }
+                }
+            }
+        }
+
         [[nodiscard]] auto source() const -> std::string {
-            return fmt::format("{}\n{}", this->m_forwardDecls, this->m_source);
+            // Schedulers are sized once all drivers sharing their bus are known
+            std::string schedulers;
+            for (const auto &[bus, schedule] : this->m_schedules)
+                schedulers += schedulerSource(bus, schedule);
+
+            // So are the vectors, once all handlers of their interrupt are known
+            std::string vectors;
+            for (const auto &[vector, handlers] : this->m_interrupts)
+                vectors += vectorSource(vector, handlers);
+
+            return fmt::format("{}{}{}\n{}{}{}{}", this->m_include, this->m_include.empty() ? "" : "\n", this->m_forwardDecls, schedulers, this->m_instantiations, this->m_source, vectors);
         }
 
         [[nodiscard]] auto include() const -> const std::string& {
             return this->m_include;
         }
 
+        // Adds an include of a standard header to the top of the generated code, unless it's been included already
+        auto addInclude(std::string_view header) -> void {
+            auto include = fmt::format("#include <{}>\n", header);
+            if (this->m_include.find(include) == std::string::npos)
+                this->m_include += include;
+        }
+
+        // Optimized IR of every function that has been generated from it
+        [[nodiscard]] auto ir() const -> const std::string& {
+            return this->m_ir;
+        }
+
     private:
-        
+        // Schedulers are generated after the drivers using them, whose AST may have been released by then. Everything is kept as owned strings
+        struct BusSchedule {
+            size_t tasks = 0;
+            u8 levels = 1;
+            std::string attributes;
+            bool inlinable = true;
+        };
+
+        // Vectors are generated once all drivers have been, the handler's placement is copied out of its AST
+        struct InterruptHandler {
+            std::string symbol;
+            u8 priority = 0;
+            bool returnsHandled = false;
+            ast::FunctionAttributes::Temperature temperature = ast::FunctionAttributes::Temperature::Default;
+            std::string section;
+        };
+
+        static auto templateValueLiteral(const TemplateValue &value) -> std::string {
+            switch (value.type) {
+                case lexer::Token::Type::StringLiteral:
+                    return fmt::format("\"{}\"", value.value);
+                case lexer::Token::Type::CharacterLiteral:
+                    return fmt::format("'{}'", value.value);
+                default:
+                    return value.value;
+            }
+        }
+
+        static auto byteOrderMacro(Endianness endianness) -> std::string_view {
+            return endianness == Endianness::Big ? "__ORDER_BIG_ENDIAN__" : "__ORDER_LITTLE_ENDIAN__";
+        }
+
+        // Reads a field of a struct out of a frame. Fields as wide as their type are copied and swapped if needed, which compiles
+        // to a single load and byte swap instruction. Narrower ones are assembled byte by byte and sign extended
+        static auto loadField(const NodeStruct::Field &field) -> std::string {
+            const auto &type = NodeStruct::builtinType(field);
+            auto typeName = field.type->name();
+
+            auto bits = type.size() * 8;
+            bool rawType = typeName == fmt::format("u{}", bits);
+
+            if (type.size() == 1) {
+                if (type.type() == NodeBuiltinType::Type::Boolean)
+                    return fmt::format("return data[{}] != 0;", field.offset);
+
+                return rawType ? fmt::format("return data[{}];", field.offset) : fmt::format("return ({})data[{}];", typeName, field.offset);
+            }
+
+            std::string statements;
+            if (field.width == type.size()) {
+                statements = fmt::format("u{0} raw;\nmemcpy(&raw, data{1}, sizeof(raw));\n#if __BYTE_ORDER__ != {2}\nraw = __builtin_bswap{0}(raw);\n#endif", bits, byteOffset(field.offset), byteOrderMacro(field.endianness));
+            } else {
+                std::vector<std::string> bytes;
+                for (u32 i = 0; i < field.width; i++) {
+                    auto shift = 8 * (field.endianness == Endianness::Big ? field.width - 1 - i : i);
+                    bytes.push_back(shift == 0 ? fmt::format("(u{})data[{}]", bits, field.offset + i) : fmt::format("(u{})data[{}] << {}", bits, field.offset + i, shift));
+                }
+                statements = fmt::format("u{} raw = {};", bits, fmt::join(bytes, " | "));
+            }
+
+            if (type.type() == NodeBuiltinType::Type::FloatingPoint)
+                return statements + fmt::format("\n{} value;\nmemcpy(&value, &raw, sizeof(value));\nreturn value;", typeName);
+            if (type.type() == NodeBuiltinType::Type::Signed && field.width != type.size())
+                return statements + fmt::format("\nreturn ({0})((raw ^ 0x{1:X}) - 0x{1:X});", typeName, u64(1) << (field.width * 8 - 1));
+
+            return statements + (rawType ? "\nreturn raw;" : fmt::format("\nreturn ({})raw;", typeName));
+        }
+
+        // Writes a field of a struct into a frame, the inverse of loadField. Narrow fields are truncated to their width
+        static auto storeField(const NodeStruct::Field &field) -> std::string {
+            const auto &type = NodeStruct::builtinType(field);
+
+            auto bits = type.size() * 8;
+            bool rawType = field.type->name() == fmt::format("u{}", bits);
+
+            if (type.size() == 1)
+                return rawType ? fmt::format("data[{}] = value;", field.offset) : fmt::format("data[{}] = (u8)value;", field.offset);
+
+            std::string statements;
+            if (type.type() == NodeBuiltinType::Type::FloatingPoint)
+                statements = fmt::format("u{} raw;\nmemcpy(&raw, &value, sizeof(raw));", bits);
+            else
+                statements = rawType ? fmt::format("u{} raw = value;", bits) : fmt::format("u{0} raw = (u{0})value;", bits);
+
+            if (field.width == type.size())
+                return statements + fmt::format("\n#if __BYTE_ORDER__ != {1}\nraw = __builtin_bswap{0}(raw);\n#endif\nmemcpy(data{2}, &raw, sizeof(raw));", bits, byteOrderMacro(field.endianness), byteOffset(field.offset));
+
+            for (u32 i = 0; i < field.width; i++) {
+                auto shift = 8 * (field.endianness == Endianness::Big ? field.width - 1 - i : i);
+                statements += shift == 0 ? fmt::format("\ndata[{}] = (u8)raw;", field.offset + i) : fmt::format("\ndata[{}] = (u8)(raw >> {});", field.offset + i, shift);
+            }
+
+            return statements;
+        }
+
+        static auto byteOffset(u32 offset) -> std::string {
+            return offset == 0 ? std::string() : fmt::format(" + {}", offset);
+        }
+
+        // Adds a static inline function with one statement per line, used for the accessors of registers
+        auto addFunction(const std::string &signature, const std::string &statements) -> void {
+            this->m_forwardDecls += fmt::format("static inline {};\n", signature);
+            this->m_source += functionDefinition(signature, statements);
+        }
+
+        static auto functionDefinition(const std::string &signature, const std::string &statements, bool inlinable = true) -> std::string {
+            auto definition = fmt::format("static {}{} {{\n", inlinable ? "inline " : "", signature);
+            for (const auto &line : wolv::util::splitString(statements, "\n"))
+                definition += line.empty() ? "\n" : fmt::format("    {}\n", line);
+
+            return definition + "}\n\n";
+        }
+
+        // The byte order the device's registers are transferred in unless they declare their own, nullopt for the host's
+        [[nodiscard]] auto deviceEndianness() const -> std::optional<Endianness> {
+            return this->m_driver != nullptr ? this->m_driver->deviceEndianness() : std::nullopt;
+        }
+
+        // Attributes of a function, falling back to the ones of the driver generating it
+        [[nodiscard]] auto attributesOf(const NodeFunction &node) const -> ast::FunctionAttributes {
+            return this->m_driver != nullptr ? node.attributes().withDefaults(this->m_driver->functionAttributes()) : node.attributes();
+        }
+
+        // GCC and Clang attributes placing a function and controlling its inlining. Empty if it has none
+        static auto functionAttributes(const ast::FunctionAttributes &attributes) -> std::string {
+            std::vector<std::string> result;
+            if (attributes.temperature != ast::FunctionAttributes::Temperature::Default)
+                result.emplace_back(attributes.temperature == ast::FunctionAttributes::Temperature::Hot ? "hot" : "cold");
+            if (attributes.inlining == ast::FunctionAttributes::Inlining::Always)
+                result.emplace_back("always_inline");
+            else if (!attributes.isInlinable())
+                result.emplace_back("noinline");
+            if (!attributes.section.empty())
+                result.push_back(fmt::format("section(\"{}\")", attributes.section));
+
+            return result.empty() ? std::string() : fmt::format("__attribute__(({})) ", fmt::join(result, ", "));
+        }
+
+        // Generates a struct of volatile members laid out like the peripheral's registers and a pointer to it at the peripheral's base address.
+        // Gaps between registers are reserved, registers that can only be read are const so raw code can't write them by accident
+        auto addRegisterOverlay(const NodeDriver &node) -> void {
+            const auto &prefix = this->m_prefixes.back();
+
+            std::vector<const NodeRegister *> registers;
+            for (const auto &declaration : node.registers())
+                registers.push_back(declaration.get());
+            std::ranges::sort(registers, { }, &NodeRegister::address);
+
+            std::string members;
+            u64 offset = 0;
+            for (const auto *declaration : registers) {
+                if (declaration->address() > offset)
+                    members += fmt::format("    u8 _reserved{}[{}];\n", offset, declaration->address() - offset);
+
+                auto qualifier = declaration->isWritable() ? "volatile" : "const volatile";
+                members += fmt::format("    {} {} {};\n", qualifier, declaration->type()->name(), declaration->name());
+                offset = declaration->address() + declaration->builtinType().size();
+            }
+
+            this->m_forwardDecls += fmt::format("typedef struct {{\n{}}} {}_Registers;\n", members, prefix);
+            this->m_forwardDecls += fmt::format("static {0}_Registers *const {0}_registers = ({0}_Registers *)0x{1:08X};\n", prefix, *node.baseAddress());
+        }
+
+        // Priority of the device's transfers on its bus, the lowest one unless it or a driver it inherits from declares one
+        [[nodiscard]] auto devicePriority() const -> u8 {
+            for (auto driver = this->m_driver; driver != nullptr; driver = driver->inheritance()) {
+                if (driver->priority().has_value())
+                    return *driver->priority();
+            }
+
+            return 0;
+        }
+
+        // Registers a state machine of the device that's being generated with the scheduler of its bus and returns the bus' prefix.
+        // The task type is declared right away, the queues are generated once it's known how many tasks and priorities they need
+        auto addScheduler(const std::string &bus, const NodeDriver &busDriver) -> const std::string & {
+            auto [it, inserted] = this->m_schedules.try_emplace(bus);
+            if (inserted) {
+                // _complete() runs from the bus' interrupt, it's placed like the bus driver's functions
+                auto placement = busDriver.functionAttributes();
+                placement.inlining = ast::FunctionAttributes::Inlining::Default;
+                it->second.attributes = functionAttributes(placement);
+                it->second.inlinable = placement.isInlinable();
+
+                this->addInclude("stddef.h");
+                this->m_forwardDecls += fmt::format("typedef struct {0}_Task {{\n    bool (*step)(void);\n    u8 priority;\n    u8 queued;\n}} {0}_Task;\n", bus);
+            }
+
+            it->second.tasks += 1;
+            it->second.levels = std::max<u8>(it->second.levels, this->devicePriority() + 1);
+
+            return it->first;
+        }
+
+        // Transfers of all tasks on a bus are queued in a ring per priority level. Submitting reserves a slot with a single atomic increment
+        // and publishes it with its sequence number, so tasks can be started from interrupts while the main loop submits too.
+        // The bus is handed to the next task right when the owner is done with its transfer, so queued transfers run back to back from the
+        // transfer complete interrupt if that's where _complete() is called. Every task waits at most once at a time, rings with a slot per task
+        // never overflow. Their size is a power of two so slot indices stay consistent when the counters wrap around
+        static auto schedulerSource(const std::string &bus, const BusSchedule &schedule) -> std::string {
+            auto capacity = std::bit_ceil(schedule.tasks);
+            auto levels = schedule.levels;
+
+            auto source = fmt::format("static {0}_Task *{0}_tasks[{1}][{2}];\nstatic u32 {0}_published[{1}][{2}];\nstatic u32 {0}_head[{1}];\nstatic u32 {0}_tail[{1}];\n", bus, levels, capacity);
+            source += fmt::format("static {0}_Task *{0}_owner;\nstatic bool {0}_dispatching;\n\n", bus);
+
+            source += functionDefinition(fmt::format("void {}_submit({}_Task *task)", bus, bus), fmt::format(
+                "if (__atomic_exchange_n(&task->queued, 1, __ATOMIC_ACQ_REL))\n"
+                "    return;\n"
+                "\n"
+                "u32 index = __atomic_fetch_add(&{0}_tail[task->priority], 1, __ATOMIC_RELAXED);\n"
+                "{0}_tasks[task->priority][index % {1}] = task;\n"
+                "__atomic_store_n(&{0}_published[task->priority][index % {1}], index + 1, __ATOMIC_RELEASE);", bus, capacity));
+
+            source += functionDefinition(fmt::format("bool {}_waiting(void)", bus), fmt::format(
+                "for (u8 priority = 0; priority < {1}; priority++) {{\n"
+                "    u32 head = __atomic_load_n(&{0}_head[priority], __ATOMIC_RELAXED);\n"
+                "    if (__atomic_load_n(&{0}_published[priority][head % {2}], __ATOMIC_ACQUIRE) == head + 1)\n"
+                "        return true;\n"
+                "}}\n"
+                "return false;", bus, levels, capacity));
+
+            // Only called by whoever holds the dispatching flag, so there's a single consumer
+            source += functionDefinition(fmt::format("{0}_Task *{0}_next(void)", bus), fmt::format(
+                "for (u8 priority = {1}; priority-- > 0;) {{\n"
+                "    u32 head = {0}_head[priority];\n"
+                "    if (__atomic_load_n(&{0}_published[priority][head % {2}], __ATOMIC_ACQUIRE) != head + 1)\n"
+                "        continue;\n"
+                "\n"
+                "    __atomic_store_n(&{0}_head[priority], head + 1, __ATOMIC_RELAXED);\n"
+                "    return {0}_tasks[priority][head % {2}];\n"
+                "}}\n"
+                "return NULL;", bus, levels, capacity));
+
+            // A task submitted by an interrupt while the flag is held is picked up by the holder's next iteration
+            source += functionDefinition(fmt::format("{0}_Task *{0}_dispatch(void)", bus), fmt::format(
+                "{0}_Task *task = NULL;\n"
+                "while (task == NULL && __atomic_load_n(&{0}_owner, __ATOMIC_ACQUIRE) == NULL && {0}_waiting()) {{\n"
+                "    if (__atomic_test_and_set(&{0}_dispatching, __ATOMIC_ACQUIRE))\n"
+                "        return NULL;\n"
+                "\n"
+                "    if (__atomic_load_n(&{0}_owner, __ATOMIC_ACQUIRE) == NULL && (task = {0}_next()) != NULL) {{\n"
+                "        __atomic_store_n(&{0}_owner, task, __ATOMIC_RELEASE);\n"
+                "        __atomic_store_n(&task->queued, 0, __ATOMIC_RELEASE);\n"
+                "    }}\n"
+                "    __atomic_clear(&{0}_dispatching, __ATOMIC_RELEASE);\n"
+                "}}\n"
+                "return task;", bus));
+
+            source += functionDefinition(fmt::format("bool {0}_acquire({0}_Task *task)", bus), fmt::format(
+                "if (__atomic_load_n(&{0}_owner, __ATOMIC_ACQUIRE) == task)\n"
+                "    return true;\n"
+                "\n"
+                "{0}_submit(task);\n"
+                "{0}_Task *next = {0}_dispatch();\n"
+                "if (next == task)\n"
+                "    return true;\n"
+                "if (next != NULL)\n"
+                "    next->step();\n"
+                "return false;", bus));
+
+            source += functionDefinition(fmt::format("void {}_release(void)", bus), fmt::format(
+                "__atomic_store_n(&{0}_owner, NULL, __ATOMIC_RELEASE);\n"
+                "\n"
+                "{0}_Task *next = {0}_dispatch();\n"
+                "if (next != NULL)\n"
+                "    next->step();", bus));
+
+            // Called from the bus' transfer complete interrupt or the main loop, continues the task that's using the bus
+            source += functionDefinition(fmt::format("{}void {}_complete(void)", schedule.attributes, bus), fmt::format(
+                "{0}_Task *task = __atomic_load_n(&{0}_owner, __ATOMIC_ACQUIRE);\n"
+                "if (task == NULL)\n"
+                "    task = {0}_dispatch();\n"
+                "if (task != NULL)\n"
+                "    task->step();", bus), schedule.inlinable);
+
+            return source;
+        }
+
+        // Registers a handler with the vector of its interrupt. Handlers of devices with a higher priority are called first,
+        // the ones of the same priority in the order their drivers have been generated in
+        auto addInterruptHandler(const NodeFunction &node, const std::string &name) -> void {
+            auto &handlers = this->m_interrupts[std::string(node.interrupt())];
+            if (std::ranges::any_of(handlers, [&](const auto &handler) { return handler.symbol == name; }))
+                return;
+
+            auto attributes = this->attributesOf(node);
+            InterruptHandler handler = { name, this->devicePriority(), node.returnType() != nullptr, attributes.temperature, std::string(attributes.section) };
+            auto position = std::ranges::find_if(handlers, [&](const auto &other) { return other.priority < handler.priority; });
+            handlers.insert(position, std::move(handler));
+        }
+
+        // Generates the vector of an interrupt, the function the vector table points to. It calls its handlers directly, the ones of interrupts
+        // that aren't shared get inlined into it. Shared ones are called one after the other, it returns early once one of them handled it.
+        // It's placed like its handlers if they all agree on where to
+        static auto vectorSource(const std::string &vector, const std::vector<InterruptHandler> &handlers) -> std::string {
+            ast::FunctionAttributes placement = { .temperature = handlers.front().temperature, .section = handlers.front().section };
+            for (const auto &handler : handlers) {
+                if (handler.temperature != placement.temperature)
+                    placement.temperature = ast::FunctionAttributes::Temperature::Default;
+                if (handler.section != placement.section)
+                    placement.section = { };
+            }
+
+            std::string statements;
+            for (size_t i = 0; i < handlers.size(); i++) {
+                if (handlers[i].returnsHandled && i != handlers.size() - 1)
+                    statements += fmt::format("    if ({}())\n        return;\n", handlers[i].symbol);
+                else
+                    statements += fmt::format("    {}();\n", handlers[i].symbol);
+            }
+
+            return fmt::format("{}void {}(void) {{\n{}}}\n\n", functionAttributes(placement), vector, statements);
+        }
+
+        // Adds drv_bigEndian16(value) and its siblings converting values between the given byte order and the host's, unless that has been done already.
+        // They're defined right away so structs and raw code blocks can use them too. On hosts of the same byte order they don't do anything.
+        // Floating point values are swapped as the unsigned integer of their size, drv_bigEndianF32(value) copies them through a u32
+        auto addByteOrderHelpers(Endianness endianness) -> void {
+            auto order = endianness == Endianness::Big ? "big" : "little";
+            if (!this->m_instantiated.insert(fmt::format("drv_{}Endian", order)).second)
+                return;
+
+            for (u32 bits : { 16, 32, 64 }) {
+                auto statements = fmt::format("#if __BYTE_ORDER__ == {}\nreturn value;\n#else\nreturn __builtin_bswap{}(value);\n#endif", byteOrderMacro(endianness), bits);
+                this->m_forwardDecls += functionDefinition(fmt::format("u{0} drv_{1}Endian{0}(u{0} value)", bits, order), statements);
+            }
+
+            this->addInclude("string.h");
+            for (u32 bits : { 32, 64 }) {
+                auto statements = fmt::format("u{0} raw;\nmemcpy(&raw, &value, sizeof(raw));\nraw = drv_{1}Endian{0}(raw);\nmemcpy(&value, &raw, sizeof(value));\nreturn value;", bits, order);
+                this->m_forwardDecls += functionDefinition(fmt::format("f{0} drv_{1}EndianF{0}(f{0} value)", bits, order), statements);
+            }
+        }
+
+        // Generates the struct holding the registers of a burst and the accessor reading all of them, unless that has been done already.
+        // The bus driver's readRegisters<T>(address) is instantiated with a struct of the bytes that are transferred.
+        // Bursts are generated on demand while lowering functions, so they end up with the instantiations
+        auto addBurst(const std::string &name, const std::vector<const NodeRegister *> &registers) -> bool {
+            if (this->m_instantiated.contains(name))
+                return true;
+
+            const NodeFunction *function = nullptr;
+            const NodeDriver *owner = nullptr;
+            for (auto driver = this->m_driver; driver != nullptr && function == nullptr; driver = driver->inheritance()) {
+                for (const auto &candidate : driver->functions()) {
+                    if (candidate->name() == "readRegisters" && candidate->typeParameters().size() == 1 && candidate->parameters().size() == 1) {
+                        function = candidate.get();
+                        owner = driver;
+                        break;
+                    }
+                }
+            }
+
+            if (function == nullptr || function->expression() != nullptr || registers.empty())
+                return false;
+            this->m_instantiated.insert(name);
+
+            std::string members, statements;
+            size_t size = 0;
+            for (const auto *declaration : registers) {
+                members += fmt::format("    {} {};\n", declaration->type()->name(), declaration->name());
+
+                // Registers are copied out of the transferred bytes as they are, just like readRegister<T> would return them
+                statements += fmt::format("\nmemcpy(&result.{0}, data.bytes + {1}, sizeof(result.{0}));", declaration->name(), size);
+                if (declaration->endianness().has_value() && declaration->builtinType().size() > 1)
+                    statements += fmt::format("\nresult.{0} = {1};", declaration->name(), ir::convertByteOrder(fmt::format("result.{}", declaration->name()), ir::Type::fromBuiltin(declaration->builtinType()), *declaration->endianness()));
+                if (declaration->isCached())
+                    statements += fmt::format("\n{0}_cache = result.{1};\n{0}_cacheValid = true;", this->resolveRegister(declaration->name()), declaration->name());
+
+                size += declaration->builtinType().size();
+            }
+
+            this->m_forwardDecls += fmt::format("typedef struct {{\n    u8 bytes[{}];\n}} {}_Data;\n", size, name);
+            this->m_forwardDecls += fmt::format("typedef struct {{\n{}}} {};\n", members, name);
+            this->addInclude("string.h");
+
+            // Decoding is separate from reading so state machines can decode the bytes they received
+            auto decode = fmt::format("{0} {0}_decode({0}_Data data)", name);
+            this->m_forwardDecls += fmt::format("static inline {};\n", decode);
+            this->m_instantiations += functionDefinition(decode, fmt::format("{0} result;{1}\nreturn result;", name, statements));
+
+            auto busFunction = this->functionSymbol(*function, *owner, { name + "_Data" });
+            auto signature = fmt::format("{0} {0}_read()", name);
+            this->m_forwardDecls += fmt::format("static inline {};\n", signature);
+            this->m_instantiations += functionDefinition(signature, fmt::format("return {0}_decode({1}(0x{2:02X}));", name, busFunction, registers.front()->address()));
+
+            return true;
+        }
+
+        // Generates an async function as a state machine next to its blocking version. _start(...) starts it, _step() continues it
+        // whenever the bus may have become free and returns whether it's still running. The callback gets the result once it's done
+        auto generateStateMachine(const NodeFunction &node, const std::string &name) -> void {
+            auto busy = fmt::format("{}()", this->busFunction("busy", { }));
+
+            // State machines of all devices on the same bus take turns, each of them holds it for a single transfer
+            std::string bus;
+            const NodeDriver *busDriver = nullptr;
+            for (auto driver = this->m_driver; driver != nullptr && bus.empty(); driver = driver->inheritance()) {
+                if (std::ranges::any_of(driver->functions(), [](const auto &function) { return function->name() == "busy" && function->typeParameters().empty(); })) {
+                    bus = getPrefix(driver->name());
+                    busDriver = driver;
+                }
+            }
+
+            auto acquire = bus.empty() ? std::string() : fmt::format("{}_acquire(&{}_task)", bus, name);
+            auto release = bus.empty() ? std::string() : fmt::format("{}_release()", bus);
+
+            ir::AsyncTarget target = { busy, acquire, release, [this](const ir::Instruction &instruction, ir::Type type) -> std::optional<ir::AsyncTransfer> {
+                const auto *declaration = instruction.registerDeclaration;
+                bool burst = instruction.opcode == ir::Opcode::BusBurst;
+                bool cached = declaration != nullptr && declaration->isCached() && !burst;
+                if ((burst || cached) && declaration == nullptr)
+                    return std::nullopt;
+
+                // Bursts are transferred as the struct of their bytes, just like readRegisters<T> would
+                auto typeArgument = burst ? fmt::format("{}_Data", instruction.symbol) : std::string(type.name());
+
+                ir::AsyncTransfer transfer;
+                if (instruction.opcode == ir::Opcode::BusWrite) {
+                    transfer.begin = this->busFunction("beginWriteRegister", { typeArgument });
+                } else {
+                    transfer.begin = this->busFunction("beginReadRegister", { typeArgument });
+                    transfer.end = fmt::format("{}()", this->busFunction("endReadRegister", { typeArgument }));
+                    if (burst)
+                        transfer.end = fmt::format("{}_decode({})", instruction.symbol, transfer.end);
+                }
+
+                // Accessors of cached registers and bursts have no operands, they know their address
+                if (burst || cached)
+                    transfer.arguments.push_back(fmt::format("0x{:02X}", declaration->address()));
+                if (cached)
+                    transfer.cache = this->resolveRegister(declaration->name());
+
+                return transfer;
+            } };
+
+            const auto *lowered = this->m_lowering.lower(node, *this->m_driver, this->m_typeArguments, name);
+            auto code = lowered != nullptr ? ir::generateAsyncC(*lowered, target) : std::nullopt;
+            if (!code.has_value()) {
+                this->m_source += fmt::format("#error \"{} can't be generated as a state machine\"\n\n", name);
+                return;
+            }
+
+            auto callback = lowered->returnType.kind == ir::Type::Kind::Void ? std::string("void *user") : fmt::format("{} result, void *user", lowered->returnType.name());
+            this->m_forwardDecls += fmt::format("typedef void (*{}_Callback)({});\n", name, callback);
+
+            std::string fields;
+            for (const auto &[type, field] : code->fields)
+                fields += fmt::format("    {}{}{};\n", type, type.ends_with('*') ? "" : " ", field);
+            this->m_forwardDecls += fmt::format("typedef struct {{\n    u8 _state;\n    {0}_Callback _callback;\n    void *_user;\n{1}}} {0}_State;\n", name, fields);
+            this->m_forwardDecls += fmt::format("static {0}_State {0}_state;\n", name);
+
+            // The step function is what runs from the bus' interrupt, it's placed like the function itself.
+            // It's called through the task of the bus, so it's never inlined
+            auto placement = this->attributesOf(node);
+            placement.inlining = ast::FunctionAttributes::Inlining::Default;
+            auto attributes = functionAttributes(placement);
+            this->m_forwardDecls += fmt::format("static {}bool {}_step();\n", attributes, name);
+            if (!bus.empty())
+                this->m_forwardDecls += fmt::format("static {}_Task {}_task = {{ {}_step, {}, 0 }};\n", this->addScheduler(bus, *busDriver), name, name, this->devicePriority());
+            this->m_source += fmt::format("static {2}bool {0}_step() {{\n    {0}_State *const s = &{0}_state;\n\n    switch (s->_state) {{\n    case 0:\n        return false;\n{1}    }}\n\n    return false;\n}}\n\n", name, code->cases, attributes);
+
+            // Starting it again while it's still running is refused, there's only a single state per function
+            std::vector<std::string> parameters;
+            std::string statements = "if (s->_state != 0)\n    return false;";
+            for (const auto &parameter : node.parameters()) {
+                parameters.push_back(this->parameterDeclaration(*parameter));
+                statements += fmt::format("\ns->{0} = {0};", parameter->name());
+                if (isSpan(*parameter->type()))
+                    statements += fmt::format("\ns->{0}_size = {0}_size;", parameter->name());
+            }
+            parameters.push_back(fmt::format("{}_Callback callback", name));
+            parameters.push_back("void *user");
+
+            statements = fmt::format("{0}_State *const s = &{0}_state;\n{1}\ns->_callback = callback;\ns->_user = user;\ns->_state = 1;\n{0}_step();\nreturn true;", name, statements);
+            this->addFunction(fmt::format("bool {}_start({})", name, fmt::join(parameters, ", ")), statements);
+        }
+
+        // Generates the definition of a function and adds its declaration to the forward declarations
+        auto generateFunction(const NodeFunction &node, const std::string &name) -> std::string {
+            // Expression bodied functions are thin wrappers, inlining them makes them free
+            auto returnType = node.returnType() != nullptr ? this->typeName(*node.returnType()) : "void";
+            auto attributes = this->attributesOf(node);
+            std::string function = fmt::format("static {}{}{} {}(", functionAttributes(attributes), node.expression() != nullptr && attributes.isInlinable() ? "inline " : "", returnType, name);
+
+            std::vector<std::string> parameters;
+            for (const auto &parameter : node.parameters())
+                parameters.push_back(this->parameterDeclaration(*parameter));
+
+            function += fmt::format("{})", fmt::join(parameters, ", "));
+
+            this->m_forwardDecls += function + ";\n";
+
+            // The body is generated into its own buffer so functions instantiated while generating it don't end up inside of it
+            auto previousSource   = std::exchange(this->m_source, function + " {\n");
+            auto previousFunction = std::exchange(this->m_function, &node);
+
+            if (node.expression() != nullptr) {
+                // Expression bodies go through the IR so calls get inlined and constants folded.
+                // The few things it can't represent yet, like constants of other drivers, are generated straight from the AST
+                auto lowered = this->m_driver != nullptr ? this->m_lowering.lower(node, *this->m_driver, this->m_typeArguments, name) : nullptr;
+
+                if (lowered != nullptr) {
+                    this->m_source += ir::generateC(*lowered);
+                    this->m_ir += ir::print(*lowered);
+                } else {
+                    auto expression = this->generateExpression(*node.expression());
+
+                    if (node.returnType() != nullptr)
+                        this->m_source += fmt::format("    return {};\n", expression);
+                    else
+                        this->m_source += fmt::format("    {};\n", expression);
+                }
+            } else {
+                for (auto &[parameter, argument] : this->m_typeArguments) {
+                    this->m_source += fmt::format("    typedef {} {};\n", argument, parameter);
+                }
+
+                for (auto &[parameter, value] : this->m_templateParameters) {
+                    this->m_source += fmt::format("    const {} {} = {}_{}();\n", parameter->type()->name(), parameter->name(), this->m_prefixes.back(), parameter->name());
+                }
+
+                // Constants and buffers are emitted once per driver, not per set of template values. Functions refer to them by their short name
+                if (this->m_driver != nullptr) {
+                    auto prefix = getPrefix(this->m_driver->name());
+                    for (auto &constant : this->m_driver->constants()) {
+                        auto pattern = constant->isTable() ? "    const {} *const {} = {}_{};\n" : "    const {} {} = {}_{};\n";
+                        this->m_source += fmt::format(fmt::runtime(pattern), constant->type()->name(), constant->name(), prefix, constant->name());
+                    }
+
+                    for (auto &buffer : this->m_driver->buffers()) {
+                        this->addInclude("stddef.h");
+                        this->m_source += fmt::format("    u8 *const {0} = {1}_{0};\n", buffer->name(), prefix);
+                        this->m_source += fmt::format("    const size_t {0}_size = sizeof({1}_{0});\n", buffer->name(), prefix);
+                    }
+                }
+
+                this->m_source += "\n";
+
+                for (auto &child : node.body())
+                    ast::dispatch(*child, *this);
+            }
+
+            this->m_source += "}\n\n";
+
+            this->m_function = previousFunction;
+            return std::exchange(this->m_source, std::move(previousSource));
+        }
+
+        // Steps every state machine of the driver, returns whether any of them is still running
+        auto addPoll(const NodeDriver &driver) -> void {
+            if (!std::ranges::any_of(driver.functions(), &NodeFunction::isAsync))
+                return;
+
+            std::string statements = "bool running = false;";
+            for (auto &function : driver.functions()) {
+                if (function->isAsync())
+                    statements += fmt::format("\nrunning |= {}_{}_step();", this->m_prefixes.back(), function->name());
+            }
+
+            this->addFunction(fmt::format("bool {}_poll()", this->m_prefixes.back()), statements + "\nreturn running;");
+        }
+
+        // Generates the template parameters and all functions of a driver inherited with template values, unless that has been done already.
+        // Devices inheriting with the same template values share the instance of the driver
+        auto instantiateDriver(const NodeDriver &driver) -> void {
+            this->pushPrefix(driver);
+            if (!this->m_instantiated.insert(this->m_prefixes.back()).second) {
+                this->popPrefix();
+                return;
+            }
+
+            const auto &templateParameters = driver.templateParameters();
+            const auto &templateValues = driver.templateValues();
+            for (size_t i = 0; i < templateParameters.size(); i++) {
+                auto templateParameterFunction = fmt::format("static {} {}_{}() {{ return {}; }}\n",
+                                                             templateParameters[i]->type()->name(),
+                                                             this->m_prefixes.back(),
+                                                             templateParameters[i]->name(),
+                                                             templateValueLiteral(templateValues[i]));
+
+                this->m_forwardDecls += templateParameterFunction;
+            }
+
+            auto previousDriver             = std::exchange(this->m_driver, &driver);
+            auto previousTemplateParameters = std::exchange(this->m_templateParameters, { });
+
+            for (const auto &parameter : templateParameters)
+                this->m_templateParameters.emplace_back(parameter.get(), lexer::Token());
+            for (auto &child : driver.functions())
+                this->visit(*child);
+
+            this->addPoll(driver);
+
+            this->m_driver             = previousDriver;
+            this->m_templateParameters = std::move(previousTemplateParameters);
+
+            this->popPrefix();
+        }
+
+        // Generates a generic function with the given type arguments in the context of the driver declaring it, unless that has been done already
+        auto instantiate(const NodeFunction &node, const NodeDriver &driver, const std::vector<std::string> &typeArguments, const std::string &name) -> void {
+            if (!this->m_instantiated.insert(name).second)
+                return;
+
+            auto previousDriver             = std::exchange(this->m_driver, &driver);
+            auto previousTemplateParameters = std::exchange(this->m_templateParameters, { });
+            auto previousTypeArguments      = std::exchange(this->m_typeArguments, { });
+
+            for (const auto &parameter : driver.templateParameters())
+                this->m_templateParameters.emplace_back(parameter.get(), lexer::Token());
+            for (size_t i = 0; i < typeArguments.size(); i++)
+                this->m_typeArguments.emplace_back(node.typeParameters()[i], typeArguments[i]);
+
+            this->pushPrefix(driver);
+            this->m_instantiations += this->generateFunction(node, name);
+            this->popPrefix();
+
+            this->m_driver             = previousDriver;
+            this->m_templateParameters = std::move(previousTemplateParameters);
+            this->m_typeArguments      = std::move(previousTypeArguments);
+        }
+
+        // Lowers an expression of a function body to C. Names are resolved the same way the parser resolved them
+        auto generateExpression(const NodeExpression &node) -> std::string {
+            using enum NodeExpression::Operation;
+
+            const auto &operands = node.operands();
+            switch (node.operation()) {
+                case NumericLiteral:
+                    return numericLiteral(node.value());
+                case StringLiteral:
+                    return fmt::format("\"{}\"", node.value());
+                case CharacterLiteral:
+                    return fmt::format("'{}'", node.value());
+                case Identifier:
+                    return this->resolveIdentifier(node.value());
+                case UnaryOperator:
+                    return fmt::format("({}{})", node.value(), this->generateExpression(*operands[0]));
+                case BinaryOperator:
+                    return fmt::format("({} {} {})", this->generateExpression(*operands[0]), node.value(), this->generateExpression(*operands[1]));
+                case TernaryOperator:
+                    return fmt::format("({} ? {} : {})", this->generateExpression(*operands[0]), this->generateExpression(*operands[1]), this->generateExpression(*operands[2]));
+                case Index:
+                    return fmt::format("{}[{}]", this->resolveIdentifier(operands[0]->value()), this->generateExpression(*operands[1]));
+                case Call: {
+                    const auto *function = this->findFunction(node.value());
+
+                    std::vector<std::string> arguments;
+                    for (size_t i = 0; i < operands.size(); i++) {
+                        // String literals passed as a string get their length, it's known at compile time
+                        if (operands[i]->operation() == StringLiteral && function != nullptr && function->parameters()[i]->type()->name() == "string")
+                            arguments.push_back(fmt::format("\"{0}\", sizeof(\"{0}\") - 1", operands[i]->value()));
+                        else
+                            arguments.push_back(this->generateExpression(*operands[i]));
+                    }
+
+                    // Plain register transfers are converted to and from the device's byte order the same way the IR converts them
+                    auto endianness = this->deviceEndianness();
+                    bool transfer = function != nullptr && function->expression() == nullptr && node.typeArguments().size() == 1 &&
+                                    ((function->name() == "readRegister" && operands.size() == 1) || (function->name() == "writeRegister" && operands.size() == 2));
+                    if (!endianness.has_value() || !transfer)
+                        return fmt::format("{}({})", this->resolveFunction(node), fmt::join(arguments, ", "));
+
+                    auto argument = std::ranges::find(this->m_typeArguments, std::string_view(node.typeArguments().front()), &decltype(this->m_typeArguments)::value_type::first);
+                    auto type = ir::Type::fromName(argument != this->m_typeArguments.end() ? std::string_view(argument->second) : std::string_view(node.typeArguments().front()));
+                    if (operands.size() == 2)
+                        arguments.back() = ir::convertByteOrder(arguments.back(), type, *endianness);
+
+                    auto call = fmt::format("{}({})", this->resolveFunction(node), fmt::join(arguments, ", "));
+                    return operands.size() == 1 ? ir::convertByteOrder(call, type, *endianness) : call;
+                }
+                case Field: {
+                    auto declaration = this->resolveRegister(operands[0]->value());
+                    return fmt::format("{}_{}_read()", declaration, node.value());
+                }
+                case Assignment: {
+                    const auto &target = *operands[0];
+                    auto value = this->generateExpression(*operands[1]);
+
+                    if (target.operation() == Field)
+                        return fmt::format("{}_{}_write({})", this->resolveRegister(target.operands()[0]->value()), target.value(), value);
+
+                    return fmt::format("{}_write({})", this->resolveRegister(target.value()), value);
+                }
+                case Sequence: {
+                    std::vector<std::string> expressions;
+                    for (const auto &operand : operands)
+                        expressions.push_back(this->generateExpression(*operand));
+
+                    return fmt::format("({})", fmt::join(expressions, ", "));
+                }
+                case Lambda:
+                case Array:
+                    // Rejected by the parser, they only exist in constant expressions
+                    break;
+            }
+
+            return { };
+        }
+
+        auto resolveIdentifier(std::string_view name) -> std::string {
+            if (this->m_function != nullptr) {
+                for (const auto &parameter : this->m_function->parameters()) {
+                    if (parameter->name() == name)
+                        return isSpan(*parameter->type()) ? fmt::format("{0}, {0}_size", name) : std::string(name);
+                }
+            }
+
+            // Template parameters are passed through functions of the driver's instance, constants are emitted once per driver
+            for (auto driver = this->m_driver; driver != nullptr; driver = driver->inheritance()) {
+                for (const auto &parameter : driver->templateParameters()) {
+                    if (parameter->name() == name)
+                        return fmt::format("{}_{}()", getPrefix(*driver), name);
+                }
+            }
+            for (auto driver = this->m_driver; driver != nullptr; driver = driver->inheritance()) {
+                for (const auto &constant : driver->constants()) {
+                    if (constant->name() == name)
+                        return fmt::format("{}_{}", getPrefix(driver->name()), name);
+                }
+            }
+
+            // Registers are read through their accessor
+            if (auto declaration = this->resolveRegister(name); !declaration.empty())
+                return fmt::format("{}_read()", declaration);
+
+            for (auto driver = this->m_driver; driver != nullptr; driver = driver->inheritance()) {
+                for (const auto &buffer : driver->buffers()) {
+                    if (buffer->name() == name)
+                        return fmt::format("{0}_{1}, sizeof({0}_{1})", getPrefix(driver->name()), name);
+                }
+            }
+
+            // Constants of other drivers are named after the driver they're declared in
+            if (auto separator = name.rfind("::"); separator != std::string_view::npos)
+                return fmt::format("{}_{}", getPrefix(name.substr(0, separator)), name.substr(separator + 2));
+
+            return std::string(name);
+        }
+
+        auto findFunction(std::string_view name) const -> const NodeFunction * {
+            for (auto driver = this->m_driver; driver != nullptr; driver = driver->inheritance()) {
+                for (const auto &function : driver->functions()) {
+                    if (function->name() == name)
+                        return function.get();
+                }
+            }
+
+            return nullptr;
+        }
+
+        auto findRegister(std::string_view name) const -> const NodeRegister * {
+            for (auto driver = this->m_driver; driver != nullptr; driver = driver->inheritance()) {
+                for (const auto &declaration : driver->registers()) {
+                    if (declaration->name() == name)
+                        return declaration.get();
+                }
+            }
+
+            return nullptr;
+        }
+
+        // Prefix of the accessors of a register declared in the driver or one it inherits from, empty if there's no such register
+        auto resolveRegister(std::string_view name) const -> std::string {
+            for (auto driver = this->m_driver; driver != nullptr; driver = driver->inheritance()) {
+                for (const auto &declaration : driver->registers()) {
+                    if (declaration->name() == name)
+                        return fmt::format("{}_{}", getPrefix(driver->name()), name);
+                }
+            }
+
+            return { };
+        }
+
+        auto resolveFunction(const NodeExpression &call) -> std::string {
+            for (auto driver = this->m_driver; driver != nullptr; driver = driver->inheritance()) {
+                for (const auto &function : driver->functions()) {
+                    if (function->name() != call.value())
+                        continue;
+
+                    // Type parameters of the function that's currently being instantiated are replaced with their types
+                    std::vector<std::string> typeArguments;
+                    for (const auto &argument : call.typeArguments()) {
+                        auto it = std::ranges::find(this->m_typeArguments, std::string_view(argument), &std::pair<std::string_view, std::string>::first);
+                        typeArguments.emplace_back(it != this->m_typeArguments.end() ? it->second : argument);
+                    }
+
+                    return this->functionSymbol(*function, *driver, typeArguments);
+                }
+            }
+
+            return std::string(call.value());
+        }
+
+        // Name of a function of the bus driver, instantiated with the given types
+        auto busFunction(std::string_view name, const std::vector<std::string> &typeArguments) -> std::string {
+            for (auto driver = this->m_driver; driver != nullptr; driver = driver->inheritance()) {
+                for (const auto &function : driver->functions()) {
+                    if (function->name() == name && function->typeParameters().size() == typeArguments.size())
+                        return this->functionSymbol(*function, *driver, typeArguments);
+                }
+            }
+
+            return std::string(name);
+        }
+
+        // Name of a function in the generated code, generic functions are instantiated with the given types on the way
+        auto functionSymbol(const NodeFunction &function, const NodeDriver &driver, const std::vector<std::string> &typeArguments) -> std::string {
+            auto name = fmt::format("{}_{}", getPrefix(driver), function.name());
+            if (function.typeParameters().empty())
+                return name;
+
+            name += fmt::format("_{}", fmt::join(typeArguments, "_"));
+            this->instantiate(function, driver, typeArguments, name);
+
+            return name;
+        }
+
+        static auto isSpan(const NodeType &type) -> bool {
+            return !type.isTypeParameter() && type.type()->kind() == NodeKind::BuiltinType && static_cast<const NodeBuiltinType &>(*type.type()).isSpan();
+        }
+
+        // bytes and strings are passed as a pointer to the caller's memory and its length in bytes, named after the parameter with a _size suffix
+        auto parameterDeclaration(const NodeVariable &parameter) -> std::string {
+            const auto &type = *parameter.type();
+            if (!isSpan(type))
+                return fmt::format("{} {}", this->typeName(type), parameter.name());
+
+            this->addInclude("stddef.h");
+            return fmt::format("{0}{1}, size_t {1}_size", type.name() == "bytes" ? "u8 *" : "const char *", parameter.name());
+        }
+
+        auto typeName(const NodeType &type) const -> std::string {
+            if (type.isTypeParameter()) {
+                auto it = std::ranges::find(this->m_typeArguments, type.name(), &std::pair<std::string_view, std::string>::first);
+                if (it != this->m_typeArguments.end())
+                    return it->second;
+            }
+
+            return std::string(type.name());
+        }
+
+        // C has no binary or octal literals with these prefixes, they're passed on in hexadecimal
+        static auto numericLiteral(std::string_view literal) -> std::string {
+            if (!literal.starts_with("0b") && !literal.starts_with("0o"))
+                return std::string(literal);
+
+            auto value = evaluator::parseNumericLiteral(literal);
+            if (!value.has_value() || !std::holds_alternative<i128>(*value))
+                return std::string(literal);
+
+            return fmt::format("0x{:X}", u64(std::get<i128>(*value)));
+        }
+
+        static auto getPrefix(std::string_view driverName) -> std::string {
+            return hlp::driverPrefix(driverName);
+        }
+
+        // Drivers inherited with template values are instantiated once for every set of values
+        static auto getPrefix(const ast::NodeDriver &node) -> std::string {
+            return hlp::driverPrefix(node.name(), node.templateValues());
+        }
 
         auto pushPrefix(const ast::NodeDriver &node) -> void {
-            auto prefix = wolv::util::replaceStrings(std::string(node.name()), "::", "_");
-            this->m_prefixes.emplace_back("drv_" + prefix);
+            this->m_prefixes.emplace_back(getPrefix(node));
         }
 
         auto popPrefix() -> void {
@@ -118,10 +1241,43 @@ namespace compiler::visitor {
         }
 
     private:
-        std::string m_source, m_forwardDecls, m_include;
+        std::string m_source, m_forwardDecls, m_include, m_instantiations, m_ir;
 
         std::vector<std::string> m_prefixes;
         std::vector<std::pair<NodeVariable*, lexer::Token>> m_templateParameters;
+
+        // Driver and function code is currently generated for
+        const NodeDriver *m_driver = nullptr;
+        const NodeFunction *m_function = nullptr;
+
+        // Types the generic function that's currently being instantiated is instantiated with, and every instantiation generated so far
+        std::vector<std::pair<std::string_view, std::string>> m_typeArguments;
+        std::unordered_set<std::string> m_instantiated;
+
+        // Number of state machines and priority levels of every bus async functions are generated for, by the bus' prefix
+        std::map<std::string, BusSchedule> m_schedules;
+        std::map<std::string, std::vector<InterruptHandler>> m_interrupts;
+
+        ir::Lowering m_lowering {
+            [this](const NodeFunction &function, const NodeDriver &driver, const std::vector<std::string> &typeArguments) {
+                return this->functionSymbol(function, driver, typeArguments);
+            },
+            [this](const std::vector<const NodeRegister *> &registers) -> std::optional<std::string> {
+                // Registers read together in a function that aren't a declared burst get one named after the first and the last of them
+                auto name = fmt::format("{}_{}_to_{}", getPrefix(this->m_driver->name()), registers.front()->name(), registers.back()->name());
+                for (auto driver = this->m_driver; driver != nullptr; driver = driver->inheritance()) {
+                    for (const auto &burst : driver->bursts()) {
+                        if (std::ranges::equal(burst->registers(), registers, { }, { }, &NodeRegister::name))
+                            name = fmt::format("{}_{}", getPrefix(driver->name()), burst->name());
+                    }
+                }
+
+                if (!this->addBurst(name, registers))
+                    return std::nullopt;
+
+                return name;
+            }
+        };
     };
 
 }
\ No newline at end of file
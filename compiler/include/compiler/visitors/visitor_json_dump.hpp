@@ -0,0 +1,397 @@
+#pragma once
+
+#include <compiler/helpers/json.hpp>
+#include <compiler/language/ast/node.hpp>
+
+#include <variant>
+
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <fmt/format.h>
+
+namespace compiler::visitor {
+
+    using namespace compiler::language;
+    using namespace compiler::language::ast;
+
+    // Dumps the AST as a compact JSON array with one object per top level driver, meant to be read by other tools.
+    // Inherited drivers and driver types are only referenced by name and template values, every driver is dumped once on its own
+    struct VisitorJsonDump final : Visitor {
+        auto visit(const NodeDriver &node) -> void override {
+            this->beginNode("driver");
+            this->print(R"(,"name":"{}")", hlp::escapeJson(node.name()));
+
+            this->m_output += R"(,"inherits":)";
+            if (node.inheritance() != nullptr)
+                this->driverReference(*node.inheritance());
+            else
+                this->m_output += "null";
+
+            this->m_output += R"(,"endianness":)";
+            this->endianness(node.endianness());
+
+            this->m_output += R"(,"priority":)";
+            if (node.priority().has_value())
+                this->print("{}", *node.priority());
+            else
+                this->m_output += "null";
+
+            this->m_output += R"(,"baseAddress":)";
+            if (node.baseAddress().has_value())
+                this->print("{}", *node.baseAddress());
+            else
+                this->m_output += "null";
+
+            this->m_output += R"(,"functionAttributes":)";
+            this->attributes(node.functionAttributes());
+
+            this->m_output += R"(,"templateParameters":)";
+            this->list(node.templateParameters());
+
+            this->m_output += R"(,"constants":)";
+            this->list(node.constants());
+
+            this->m_output += R"(,"registers":)";
+            this->list(node.registers());
+
+            this->m_output += R"(,"bursts":)";
+            this->list(node.bursts());
+
+            this->m_output += R"(,"buffers":)";
+            this->list(node.buffers());
+
+            this->m_output += R"(,"structs":)";
+            this->list(node.structs());
+
+            this->m_output += R"(,"functions":)";
+            this->list(node.functions());
+
+            this->endNode();
+        }
+
+        auto visit(const NodeFunction &node) -> void override {
+            this->beginNode("function");
+            this->print(R"(,"name":"{}","async":{})", hlp::escapeJson(node.name()), node.isAsync());
+
+            this->m_output += R"(,"attributes":)";
+            this->attributes(node.attributes());
+
+            this->m_output += R"(,"interrupt":)";
+            if (node.isInterruptHandler())
+                this->print(R"("{}")", hlp::escapeJson(node.interrupt()));
+            else
+                this->m_output += "null";
+
+            this->m_output += R"(,"typeParameters":[)";
+            for (size_t i = 0; i < node.typeParameters().size(); i++) {
+                if (i != 0)
+                    this->m_output += ',';
+                this->print(R"("{}")", hlp::escapeJson(node.typeParameters()[i]));
+            }
+            this->m_output += ']';
+
+            this->m_output += R"(,"parameters":)";
+            this->list(node.parameters());
+
+            this->m_output += R"(,"returnType":)";
+            if (node.returnType() != nullptr)
+                this->visit(*node.returnType());
+            else
+                this->m_output += "null";
+
+            this->m_output += R"(,"body":)";
+            if (node.expression() != nullptr)
+                this->visit(*node.expression());
+            else
+                this->list(node.body());
+
+            this->endNode();
+        }
+
+        auto visit(const NodeVariable &node) -> void override {
+            this->beginNode("variable");
+            this->print(R"(,"name":"{}","type":)", hlp::escapeJson(node.name()));
+            this->visit(*node.type());
+            this->endNode();
+        }
+
+        auto visit(const NodeBuiltinType &node) -> void override {
+            auto type = [&] {
+                switch (node.type()) {
+                    using enum NodeBuiltinType::Type;
+                    case Unsigned:      return "unsigned";
+                    case Signed:        return "signed";
+                    case FloatingPoint: return "float";
+                    case Boolean:       return "bool";
+                    case Bytes:         return "bytes";
+                    case String:        return "string";
+                }
+
+                return "unknown";
+            }();
+
+            this->beginNode("builtinType");
+            this->print(R"(,"type":"{}","size":{})", type, node.size());
+            this->endNode();
+        }
+
+        auto visit(const NodeType &node) -> void override {
+            this->beginNode("type");
+            this->print(R"(,"name":"{}")", hlp::escapeJson(node.name()));
+
+            if (node.isTypeParameter()) {
+                this->m_output += R"(,"typeParameter":true)";
+            } else if (node.type()->kind() == NodeKind::Driver) {
+                this->m_output += R"(,"driver":)";
+                this->driverReference(static_cast<const NodeDriver &>(*node.type()));
+            } else {
+                this->m_output += R"(,"type":)";
+                ast::dispatch(*node.type(), *this);
+            }
+
+            this->endNode();
+        }
+
+        auto visit(const NodeRawCodeBlock &node) -> void override {
+            this->beginNode("rawCode");
+            this->print(R"(,"code":"{}")", hlp::escapeJson(node.code()));
+            this->endNode();
+        }
+
+        auto visit(const NodeExpression &node) -> void override {
+            auto operation = [&] {
+                switch (node.operation()) {
+                    using enum NodeExpression::Operation;
+                    case NumericLiteral:    return "numeric";
+                    case StringLiteral:     return "string";
+                    case CharacterLiteral:  return "character";
+                    case Identifier:        return "identifier";
+                    case UnaryOperator:     return "unary";
+                    case BinaryOperator:    return "binary";
+                    case TernaryOperator:   return "ternary";
+                    case Call:              return "call";
+                    case Index:             return "index";
+                    case Lambda:            return "lambda";
+                    case Array:             return "array";
+                    case Field:             return "field";
+                    case Assignment:        return "assignment";
+                    case Sequence:          return "sequence";
+                }
+
+                return "unknown";
+            }();
+
+            this->beginNode("expression");
+            this->print(R"(,"operation":"{}","value":"{}","operands":)", operation, hlp::escapeJson(node.value()));
+            this->list(node.operands());
+
+            if (!node.typeArguments().empty()) {
+                this->m_output += R"(,"typeArguments":[)";
+                for (size_t i = 0; i < node.typeArguments().size(); i++) {
+                    if (i != 0)
+                        this->m_output += ',';
+                    this->print(R"("{}")", hlp::escapeJson(node.typeArguments()[i]));
+                }
+                this->m_output += ']';
+            }
+            this->endNode();
+        }
+
+        auto visit(const NodeConstant &node) -> void override {
+            this->beginNode("constant");
+            this->print(R"(,"name":"{}","table":{},"type":)", hlp::escapeJson(node.name()), node.isTable());
+            this->visit(*node.type());
+
+            // Values have already been converted to the constant's type, so they fit into 64 bits
+            this->m_output += R"(,"values":[)";
+            const auto &type = node.builtinType();
+            for (size_t i = 0; i < node.values().size(); i++) {
+                if (i != 0)
+                    this->m_output += ',';
+
+                std::visit([&]<typename T>(T value) {
+                    if constexpr (std::same_as<T, f64>)
+                        this->print("{}", value);
+                    else if (type.type() == NodeBuiltinType::Type::Signed)
+                        this->print("{}", i64(value));
+                    else
+                        this->print("{}", u64(value));
+                }, node.values()[i]);
+            }
+            this->m_output += ']';
+
+            this->m_output += R"(,"expression":)";
+            this->visit(*node.expression());
+            this->endNode();
+        }
+
+        auto visit(const NodeRegister &node) -> void override {
+            auto access = [&] {
+                switch (node.access()) {
+                    using enum NodeRegister::Access;
+                    case Read:      return "r";
+                    case Write:     return "w";
+                    case ReadWrite: return "rw";
+                }
+
+                return "unknown";
+            }();
+
+            this->beginNode("register");
+            this->print(R"(,"name":"{}","address":{},"access":"{}","cached":{},"endianness":)", hlp::escapeJson(node.name()), node.address(), access, node.isCached());
+            this->endianness(node.endianness());
+            this->m_output += R"(,"type":)";
+            this->visit(*node.type());
+
+            this->m_output += R"(,"fields":[)";
+            for (size_t i = 0; i < node.fields().size(); i++) {
+                const auto &field = node.fields()[i];
+                if (i != 0)
+                    this->m_output += ',';
+
+                this->print(R"({{"name":"{}","offset":{},"width":{},"type":)", hlp::escapeJson(field.name), field.offset, field.width);
+                this->visit(*field.type);
+                this->m_output += '}';
+            }
+            this->m_output += ']';
+
+            this->endNode();
+        }
+
+        auto visit(const NodeBurst &node) -> void override {
+            this->beginNode("burst");
+            this->print(R"(,"name":"{}","registers":[)", hlp::escapeJson(node.name()));
+            for (size_t i = 0; i < node.registers().size(); i++)
+                this->print(R"({}"{}")", i == 0 ? "" : ",", hlp::escapeJson(node.registers()[i]));
+            this->m_output += ']';
+            this->endNode();
+        }
+
+        auto visit(const NodeBuffer &node) -> void override {
+            this->beginNode("buffer");
+            this->print(R"(,"name":"{}","size":{},"alignment":{},"section":"{}")", hlp::escapeJson(node.name()), node.size(), node.alignment(), hlp::escapeJson(node.section()));
+            this->endNode();
+        }
+
+        auto visit(const NodeStruct &node) -> void override {
+            this->beginNode("struct");
+            this->print(R"(,"name":"{}","endianness":"{}","size":{})", hlp::escapeJson(node.name()), endiannessName(node.endianness()), node.size());
+
+            this->m_output += R"(,"fields":[)";
+            for (size_t i = 0; i < node.fields().size(); i++) {
+                const auto &field = node.fields()[i];
+                if (i != 0)
+                    this->m_output += ',';
+
+                this->print(R"({{"name":"{}","offset":{},"width":{},"endianness":"{}","type":)", hlp::escapeJson(field.name), field.offset, field.width, endiannessName(field.endianness));
+                this->visit(*field.type);
+                this->m_output += '}';
+            }
+            this->m_output += ']';
+
+            this->endNode();
+        }
+
+        // The complete JSON document
+        [[nodiscard]] auto output() const -> std::string {
+            return fmt::format("[{}\n]\n", this->m_output);
+        }
+
+    private:
+        template<typename ... Args>
+        auto print(fmt::format_string<Args...> format, Args &&...args) -> void {
+            fmt::format_to(std::back_inserter(this->m_output), format, std::forward<Args>(args)...);
+        }
+
+        static auto endiannessName(Endianness endianness) -> std::string_view {
+            return endianness == Endianness::Big ? "big" : "little";
+        }
+
+        // Drivers and registers that don't declare their byte order are null
+        auto endianness(std::optional<Endianness> endianness) -> void {
+            if (endianness.has_value())
+                this->print(R"("{}")", endiannessName(*endianness));
+            else
+                this->m_output += "null";
+        }
+
+        // Attributes that haven't been declared are null
+        auto attributes(const FunctionAttributes &attributes) -> void {
+            this->m_output += R"({"temperature":)";
+            if (attributes.temperature != FunctionAttributes::Temperature::Default)
+                this->print(R"("{}")", attributes.temperature == FunctionAttributes::Temperature::Hot ? "hot" : "cold");
+            else
+                this->m_output += "null";
+
+            this->m_output += R"(,"inlining":)";
+            if (attributes.inlining != FunctionAttributes::Inlining::Default)
+                this->print(R"("{}")", attributes.inlining == FunctionAttributes::Inlining::Always ? "always" : "never");
+            else
+                this->m_output += "null";
+
+            this->m_output += R"(,"section":)";
+            if (!attributes.section.empty())
+                this->print(R"("{}")", hlp::escapeJson(attributes.section));
+            else
+                this->m_output += "null";
+
+            this->m_output += '}';
+        }
+
+        auto beginNode(std::string_view kind) -> void {
+            // Top level nodes are separated by new lines so large dumps can still be diffed
+            if (this->m_depth == 0)
+                this->m_output += this->m_topLevelNodes++ == 0 ? "\n" : ",\n";
+
+            this->m_depth += 1;
+            this->print(R"({{"kind":"{}")", kind);
+        }
+
+        auto endNode() -> void {
+            this->m_output += '}';
+            this->m_depth -= 1;
+        }
+
+        template<typename T>
+        auto list(const std::vector<std::unique_ptr<T>> &nodes) -> void {
+            this->m_output += '[';
+            for (size_t i = 0; i < nodes.size(); i++) {
+                if (i != 0)
+                    this->m_output += ',';
+
+                ast::dispatch(*nodes[i], *this);
+            }
+            this->m_output += ']';
+        }
+
+        auto driverReference(const NodeDriver &driver) -> void {
+            this->print(R"({{"name":"{}","templateValues":[)", hlp::escapeJson(driver.name()));
+
+            const auto &values = driver.templateValues();
+            for (size_t i = 0; i < values.size(); i++) {
+                if (i != 0)
+                    this->m_output += ',';
+
+                auto type = [&] {
+                    switch (values[i].type) {
+                        case lexer::Token::Type::StringLiteral:     return "string";
+                        case lexer::Token::Type::CharacterLiteral:  return "character";
+                        default:                                    return "numeric";
+                    }
+                }();
+
+                this->print(R"({{"type":"{}","value":"{}"}})", type, hlp::escapeJson(values[i].value));
+            }
+
+            this->m_output += "]}";
+        }
+
+    private:
+        std::string m_output;
+        size_t m_depth = 0, m_topLevelNodes = 0;
+    };
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <compiler/language/ast/node.hpp>
+
+#include <tuple>
+
+namespace compiler::visitor {
+
+    using namespace compiler::language;
+    using namespace compiler::language::ast;
+
+    // Runs several visitors in a single traversal of the top level nodes. Every node is handed to all visitors
+    // one after another while it's still in cache instead of walking the whole AST once per visitor.
+    // The visitors are called in the order they were passed in and are statically dispatched
+    template<typename ... Visitors>
+    struct VisitorPipeline final : Visitor {
+        explicit VisitorPipeline(Visitors &...visitors) : m_visitors(visitors...) { }
+
+        auto visit(const NodeDriver &node) -> void override       { this->forward(node); }
+        auto visit(const NodeFunction &node) -> void override     { this->forward(node); }
+        auto visit(const NodeVariable &node) -> void override     { this->forward(node); }
+        auto visit(const NodeBuiltinType &node) -> void override  { this->forward(node); }
+        auto visit(const NodeType &node) -> void override         { this->forward(node); }
+        auto visit(const NodeRawCodeBlock &node) -> void override { this->forward(node); }
+        auto visit(const NodeExpression &node) -> void override   { this->forward(node); }
+        auto visit(const NodeConstant &node) -> void override     { this->forward(node); }
+        auto visit(const NodeRegister &node) -> void override     { this->forward(node); }
+        auto visit(const NodeBurst &node) -> void override        { this->forward(node); }
+        auto visit(const NodeBuffer &node) -> void override       { this->forward(node); }
+        auto visit(const NodeStruct &node) -> void override       { this->forward(node); }
+
+    private:
+        template<typename T>
+        auto forward(const T &node) -> void {
+            std::apply([&node](auto &...visitors) {
+                (visitors.visit(node), ...);
+            }, this->m_visitors);
+        }
+
+    private:
+        std::tuple<Visitors&...> m_visitors;
+    };
+
+}
@@ -0,0 +1,85 @@
+#include <compiler/helpers/frame_pool.hpp>
+
+#include <compiler/types.hpp>
+
+#include <array>
+#include <new>
+
+namespace compiler::hlp {
+
+    namespace {
+
+        // Frames are rounded up to a multiple of the granularity, larger frames aren't pooled at all
+        constexpr std::size_t Granularity   = 64;
+        constexpr std::size_t MaxPooledSize = 4096;
+        constexpr std::size_t SizeClasses   = MaxPooledSize / Granularity;
+
+        // Upper limit of cached frames per size class so a burst of deeply nested generators doesn't stay allocated forever
+        constexpr u32 MaxCachedFrames = 64;
+
+        struct FreeFrame {
+            FreeFrame *next;
+        };
+
+        struct FreeLists {
+            std::array<FreeFrame *, SizeClasses> heads  = { };
+            std::array<u32, SizeClasses>         counts = { };
+
+            ~FreeLists() {
+                for (auto &head : this->heads) {
+                    while (head != nullptr) {
+                        auto next = head->next;
+                        ::operator delete(head);
+                        head = next;
+                    }
+                }
+            }
+        };
+
+        thread_local FreeLists freeLists;
+
+        constexpr auto getSizeClass(std::size_t size) -> std::size_t {
+            return (size + Granularity - 1) / Granularity - 1;
+        }
+
+    }
+
+    auto FramePool::allocate(std::size_t size) -> void * {
+        if (size == 0 || size > MaxPooledSize)
+            return ::operator new(size);
+
+        auto sizeClass = getSizeClass(size);
+        auto &head = freeLists.heads[sizeClass];
+        if (head != nullptr) {
+            auto frame = head;
+            head = frame->next;
+            freeLists.counts[sizeClass] -= 1;
+
+            return frame;
+        }
+
+        return ::operator new((sizeClass + 1) * Granularity);
+    }
+
+    auto FramePool::deallocate(void *pointer, std::size_t size) noexcept -> void {
+        if (pointer == nullptr)
+            return;
+
+        if (size == 0 || size > MaxPooledSize) {
+            ::operator delete(pointer);
+            return;
+        }
+
+        auto sizeClass = getSizeClass(size);
+        if (freeLists.counts[sizeClass] >= MaxCachedFrames) {
+            ::operator delete(pointer);
+            return;
+        }
+
+        auto frame = static_cast<FreeFrame *>(pointer);
+        frame->next = freeLists.heads[sizeClass];
+        freeLists.heads[sizeClass] = frame;
+        freeLists.counts[sizeClass] += 1;
+    }
+
+}
@@ -0,0 +1,102 @@
+#include <compiler/helpers/fs.hpp>
+
+#include <set>
+#include <stdexcept>
+
+#include <wolv/io/file.hpp>
+#include <fmt/format.h>
+
+namespace compiler::hlp {
+
+    namespace {
+
+        auto escapeDepfilePath(const std::filesystem::path &path) -> std::string {
+            std::string result;
+
+            // Make and Ninja both require spaces, hashes and dollar signs to be escaped
+            for (char c : path.generic_string()) {
+                switch (c) {
+                    case ' ':
+                    case '#':
+                        result += '\\';
+                        result += c;
+                        break;
+                    case '$':
+                        result += "$$";
+                        break;
+                    default:
+                        result += c;
+                        break;
+                }
+            }
+
+            return result;
+        }
+
+        auto writeFile(const std::filesystem::path &path, std::string_view content) -> void {
+            // Write to a temporary file first so an interrupted write never leaves a truncated output behind
+            auto temporaryPath = path;
+            temporaryPath += ".tmp";
+
+            {
+                wolv::io::File file(temporaryPath, wolv::io::File::Mode::Create);
+                if (!file.isValid()) {
+                    throw std::runtime_error(fmt::format("Failed to create output file \"{}\"", temporaryPath.string()));
+                }
+
+                file.writeString(std::string(content));
+            }
+
+            std::filesystem::rename(temporaryPath, path);
+        }
+
+    }
+
+    auto writeFileIfChanged(const std::filesystem::path &path, std::string_view content) -> bool {
+        std::error_code error;
+
+        // Only compare the content if the size matches, that's a lot cheaper than reading the file
+        if (std::filesystem::is_regular_file(path, error) && std::filesystem::file_size(path, error) == content.size()) {
+            wolv::io::File file(path, wolv::io::File::Mode::Read);
+
+            if (file.isValid() && file.readString() == content) {
+                return false;
+            }
+        }
+
+        if (path.has_parent_path()) {
+            std::filesystem::create_directories(path.parent_path());
+        }
+
+        writeFile(path, content);
+
+        return true;
+    }
+
+    auto writeDepfile(const std::filesystem::path &path, const std::vector<std::filesystem::path> &targets, const std::vector<std::filesystem::path> &dependencies) -> void {
+        std::string content;
+
+        for (const auto &target : targets) {
+            if (!content.empty())
+                content += ' ';
+
+            content += escapeDepfilePath(target);
+        }
+
+        content += ':';
+
+        // Several drivers may be loaded from the same file, only list each of them once
+        std::set<std::filesystem::path> listedDependencies;
+        for (const auto &dependency : dependencies) {
+            if (!listedDependencies.insert(dependency.lexically_normal()).second)
+                continue;
+
+            content += fmt::format(" \\\n  {}", escapeDepfilePath(dependency));
+        }
+
+        content += '\n';
+
+        writeFileIfChanged(path, content);
+    }
+
+}
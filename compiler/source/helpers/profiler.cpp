@@ -0,0 +1,283 @@
+#include <compiler/helpers/profiler.hpp>
+#include <compiler/helpers/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <utility>
+
+#include <fmt/format.h>
+
+namespace compiler::hlp {
+
+    namespace {
+
+        // Every allocation is prefixed with a header holding its size so frees can be accounted for as well
+        constexpr size_t AllocationHeaderSize = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+        std::atomic<bool> s_enabled = false;
+        std::atomic<bool> s_trackAllocations = false;
+        std::atomic<u64>  s_liveBytes = 0;
+        std::atomic<u64>  s_peakBytes = 0;
+        std::atomic<u32>  s_nextThreadId = 0;
+
+        thread_local u64 t_allocations = 0;
+        thread_local u64 t_allocatedBytes = 0;
+
+        // Heap growth caused by this thread and its high watermark. Phases running in parallel on other threads can't move either of them.
+        // Memory freed by a different thread than the one that allocated it makes them drift, so they're only compared within a phase
+        thread_local i64 t_liveBytes = 0;
+        thread_local i64 t_peakBytes = 0;
+        thread_local ScopedPhase *t_currentPhase = nullptr;
+        thread_local bool t_recordingEvent = false;
+
+        auto threadId() -> u32 {
+            thread_local u32 id = s_nextThreadId++;
+            return id;
+        }
+
+        auto epoch() -> std::chrono::steady_clock::time_point {
+            static auto start = std::chrono::steady_clock::now();
+            return start;
+        }
+
+        auto allocate(size_t size) -> void* {
+            auto memory = static_cast<u8*>(std::malloc(size + AllocationHeaderSize));
+            if (memory == nullptr)
+                throw std::bad_alloc();
+
+            *reinterpret_cast<size_t*>(memory) = size;
+
+            if (s_trackAllocations.load(std::memory_order_relaxed)) {
+                if (!t_recordingEvent) {
+                    t_allocations += 1;
+                    t_allocatedBytes += size;
+                }
+
+                t_liveBytes += i64(size);
+                t_peakBytes = std::max(t_peakBytes, t_liveBytes);
+
+                auto live = s_liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+                auto peak = s_peakBytes.load(std::memory_order_relaxed);
+                while (live > peak && !s_peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed));
+            }
+
+            return memory + AllocationHeaderSize;
+        }
+
+        auto deallocate(void *pointer) -> void {
+            if (pointer == nullptr)
+                return;
+
+            auto memory = static_cast<u8*>(pointer) - AllocationHeaderSize;
+            auto size = *reinterpret_cast<size_t*>(memory);
+
+            if (s_trackAllocations.load(std::memory_order_relaxed)) {
+                t_liveBytes -= i64(size);
+
+                // Memory allocated before the profiler was enabled may be freed afterwards, don't let the counter wrap around
+                auto live = s_liveBytes.load(std::memory_order_relaxed);
+                while (!s_liveBytes.compare_exchange_weak(live, live - std::min<u64>(live, size), std::memory_order_relaxed));
+            }
+
+            std::free(memory);
+        }
+
+        auto toMilliseconds(std::chrono::nanoseconds duration) -> double {
+            return std::chrono::duration<double, std::milli>(duration).count();
+        }
+
+        auto toMicroseconds(std::chrono::nanoseconds duration) -> double {
+            return std::chrono::duration<double, std::micro>(duration).count();
+        }
+
+    }
+
+    auto Profiler::get() -> Profiler& {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    auto Profiler::setEnabled(bool enabled) -> void {
+        epoch();
+        s_enabled = enabled;
+        s_trackAllocations = enabled;
+    }
+
+    auto Profiler::setAllocationTracking(bool enabled) -> void {
+        s_trackAllocations = enabled;
+    }
+
+    auto Profiler::getAllocationStatistics() const -> AllocationStatistics {
+        return {
+            .allocations    = t_allocations,
+            .allocatedBytes = t_allocatedBytes,
+            .liveBytes      = s_liveBytes.load(),
+            .peakBytes      = s_peakBytes.load()
+        };
+    }
+
+    auto Profiler::resetPeakHeapUsage() -> void {
+        s_peakBytes = s_liveBytes.load();
+    }
+
+    auto Profiler::isEnabled() const -> bool {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    auto Profiler::addEvent(Event &&event) -> void {
+        std::scoped_lock lock(this->m_mutex);
+        this->m_events.emplace_back(std::move(event));
+    }
+
+    auto Profiler::timeReport() const -> std::string {
+        struct Summary {
+            u64 calls = 0;
+            std::chrono::nanoseconds duration = { }, selfDuration = { };
+            u64 allocations = 0, allocatedBytes = 0, peakBytes = 0;
+
+            auto add(const Event &event) {
+                this->calls += 1;
+                this->duration += event.duration;
+                this->selfDuration += event.selfDuration;
+                this->allocations += event.allocations;
+                this->allocatedBytes += event.allocatedBytes;
+                this->peakBytes = std::max(this->peakBytes, event.peakBytes);
+            }
+        };
+
+        std::map<std::string, Summary> phases;
+        std::map<std::pair<std::string, std::string>, Summary> drivers;
+        {
+            std::scoped_lock lock(this->m_mutex);
+            for (const auto &event : this->m_events) {
+                phases[event.phase].add(event);
+
+                if (!event.driver.empty())
+                    drivers[{ event.driver, event.phase }].add(event);
+            }
+        }
+
+        auto formatRow = [](std::string_view name, const Summary &summary) {
+            return fmt::format("{:<40} {:>7} {:>12.3f} {:>12.3f} {:>10} {:>12} {:>12}\n",
+                               name, summary.calls, toMilliseconds(summary.duration), toMilliseconds(summary.selfDuration),
+                               summary.allocations, summary.allocatedBytes, summary.peakBytes);
+        };
+
+        auto header = fmt::format("{:<40} {:>7} {:>12} {:>12} {:>10} {:>12} {:>12}\n",
+                                  "", "Calls", "Total (ms)", "Self (ms)", "Allocs", "Alloc Bytes", "Peak Bytes");
+
+        std::string result = "===== Time report by phase =====\n";
+        result += header;
+        for (const auto &[phase, summary] : phases)
+            result += formatRow(phase, summary);
+
+        result += "\n===== Time report by driver =====\n";
+        result += header;
+        for (const auto &[key, summary] : drivers) {
+            const auto &[driver, phase] = key;
+            result += formatRow(fmt::format("{} [{}]", driver, phase), summary);
+        }
+
+        result += fmt::format("\nPeak heap usage: {} bytes\n", s_peakBytes.load());
+
+        return result;
+    }
+
+    auto Profiler::traceEvents() const -> std::string {
+        std::string result = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+        std::scoped_lock lock(this->m_mutex);
+
+        bool first = true;
+        for (const auto &event : this->m_events) {
+            if (!first)
+                result += ",\n";
+            first = false;
+
+            auto name = event.driver.empty() ? event.phase : fmt::format("{} {}", event.phase, event.driver);
+
+            result += fmt::format(R"({{"name":"{}","cat":"{}","ph":"X","pid":1,"tid":{},"ts":{:.3f},"dur":{:.3f},"args":{{"driver":"{}","allocations":{},"allocatedBytes":{},"peakBytes":{}}}}})",
+                                  escapeJson(name), escapeJson(event.phase), event.thread,
+                                  toMicroseconds(event.start), toMicroseconds(event.duration),
+                                  escapeJson(event.driver), event.allocations, event.allocatedBytes, event.peakBytes);
+        }
+
+        result += "\n]}\n";
+
+        return result;
+    }
+
+    ScopedPhase::ScopedPhase(std::string_view phase, std::string_view driver) {
+        if (!s_enabled.load(std::memory_order_relaxed))
+            return;
+
+        this->m_active = true;
+        this->m_phase  = phase;
+        this->m_driver = driver;
+
+        this->m_parent = t_currentPhase;
+        t_currentPhase = this;
+
+        this->m_startAllocations    = t_allocations;
+        this->m_startAllocatedBytes = t_allocatedBytes;
+
+        // Reset the thread's high watermark so the peak reached during this phase can be measured
+        this->m_startLiveBytes = t_liveBytes;
+        this->m_outerPeakBytes = std::exchange(t_peakBytes, t_liveBytes);
+
+        this->m_start = std::chrono::steady_clock::now();
+    }
+
+    ScopedPhase::~ScopedPhase() {
+        if (!this->m_active)
+            return;
+
+        auto end = std::chrono::steady_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - this->m_start);
+
+        t_currentPhase = this->m_parent;
+        if (this->m_parent != nullptr)
+            this->m_parent->m_childDuration += duration;
+
+        // Restore the high watermark of the enclosing phase
+        auto peak = t_peakBytes;
+        t_peakBytes = std::max(peak, this->m_outerPeakBytes);
+
+        // Don't attribute the allocations needed to store the event to the enclosing phase
+        t_recordingEvent = true;
+        Profiler::get().addEvent({
+            .phase          = std::string(this->m_phase),
+            .driver         = std::string(this->m_driver),
+            .thread         = threadId(),
+            .start          = std::chrono::duration_cast<std::chrono::nanoseconds>(this->m_start - epoch()),
+            .duration       = duration,
+            .selfDuration   = duration - this->m_childDuration,
+            .allocations    = t_allocations - this->m_startAllocations,
+            .allocatedBytes = t_allocatedBytes - this->m_startAllocatedBytes,
+            .peakBytes      = u64(peak - std::min(peak, this->m_startLiveBytes))
+        });
+        t_recordingEvent = false;
+    }
+
+}
+
+// Route all allocations through the profiler so allocations and memory usage can be attributed to phases
+auto operator new(size_t size) -> void* { return compiler::hlp::allocate(size); }
+auto operator new[](size_t size) -> void* { return compiler::hlp::allocate(size); }
+auto operator delete(void *pointer) noexcept -> void { compiler::hlp::deallocate(pointer); }
+auto operator delete[](void *pointer) noexcept -> void { compiler::hlp::deallocate(pointer); }
+auto operator delete(void *pointer, size_t) noexcept -> void { compiler::hlp::deallocate(pointer); }
+auto operator delete[](void *pointer, size_t) noexcept -> void { compiler::hlp::deallocate(pointer); }
+
+// The nothrow versions have to be replaced as well, the standard library may not implement them in terms of the ones above
+auto operator new(size_t size, const std::nothrow_t &) noexcept -> void* {
+    try { return compiler::hlp::allocate(size); } catch (const std::bad_alloc &) { return nullptr; }
+}
+auto operator new[](size_t size, const std::nothrow_t &) noexcept -> void* {
+    try { return compiler::hlp::allocate(size); } catch (const std::bad_alloc &) { return nullptr; }
+}
+auto operator delete(void *pointer, const std::nothrow_t &) noexcept -> void { compiler::hlp::deallocate(pointer); }
+auto operator delete[](void *pointer, const std::nothrow_t &) noexcept -> void { compiler::hlp::deallocate(pointer); }
@@ -0,0 +1,421 @@
+#include <compiler/ir/c_backend.hpp>
+
+#include <compiler/language/evaluator.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <unordered_map>
+
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+
+namespace compiler::ir {
+
+    namespace {
+
+        class Emitter {
+        public:
+            explicit Emitter(const Function &function, const AsyncTarget *async = nullptr) : m_function(function), m_async(async) {
+                this->countUses(function.body);
+            }
+
+            auto emit() -> std::string {
+                auto result = this->emitBlock(this->m_function.body, 1);
+
+                if (this->m_function.returnType.kind != Type::Kind::Void)
+                    this->line(1, "return {};", result);
+                else if (!result.empty())
+                    this->line(1, "{};", result);
+
+                return std::move(this->m_output);
+            }
+
+            // The state machine starts in state 1, every transfer adds a state for starting it and one for waiting for it to be done
+            auto emitAsync() -> std::optional<AsyncCode> {
+                for (const auto &[name, type] : this->m_function.parameters) {
+                    this->m_fields.emplace_back(type.name(), name);
+                    if (type.isSpan())
+                        this->m_fields.emplace_back("size_t", fmt::format("{}_size", name));
+                }
+
+                this->line(1, "case 1:");
+                auto result = this->emitBlock(this->m_function.body, 2);
+
+                bool isVoid = this->m_function.returnType.kind == Type::Kind::Void;
+                if (isVoid && !result.empty())
+                    this->line(2, "{};", result);
+
+                this->line(2, "s->_state = 0;");
+                this->line(2, "if (s->_callback)");
+                if (isVoid)
+                    this->line(3, "s->_callback(s->_user);");
+                else
+                    this->line(3, "s->_callback({}, s->_user);", result);
+                this->line(2, "return false;");
+
+                if (this->m_blocking)
+                    return std::nullopt;
+
+                return AsyncCode { std::move(this->m_output), std::move(this->m_fields) };
+            }
+
+        private:
+            struct Uses {
+                size_t count = 0;
+
+                // Used inside of a region nested into the block it's defined in
+                bool nested = false;
+            };
+
+            auto countUses(const Block &block) -> void {
+                auto use = [&](ValueId value) {
+                    auto &uses = this->m_uses[value];
+                    uses.count += 1;
+                    uses.nested |= this->m_definedIn[value] != &block;
+                };
+
+                for (const auto &instruction : block.instructions) {
+                    this->m_definedIn[instruction.id] = &block;
+                    this->m_types[instruction.id] = instruction.type;
+
+                    for (auto operand : instruction.operands)
+                        use(operand);
+                    for (const auto &region : instruction.regions)
+                        this->countUses(region);
+                }
+
+                if (block.result.has_value())
+                    use(*block.result);
+            }
+
+            // Emits the statements of a block and returns the expression of its result
+            auto emitBlock(const Block &block, size_t indent) -> std::string {
+                // With a single side effect there's nothing it could be reordered with, so it can be nested into its user
+                auto sideEffects = std::ranges::count_if(block.instructions, &Instruction::hasSideEffects);
+
+                for (const auto &instruction : block.instructions) {
+                    const auto &uses = this->m_uses[instruction.id];
+
+                    if (this->m_async != nullptr) {
+                        // Transfers suspend the state machine, everything else has already been done by the time the function returns.
+                        // Accesses of memory mapped registers don't go over a bus, they're done right away
+                        bool memoryMapped = instruction.registerDeclaration != nullptr && instruction.registerDeclaration->isMemoryMapped();
+                        if ((instruction.opcode == Opcode::BusRead || instruction.opcode == Opcode::BusWrite || instruction.opcode == Opcode::BusBurst) && !memoryMapped) {
+                            this->emitTransfer(instruction, indent);
+                            continue;
+                        }
+
+                        this->m_blocking |= instruction.opcode == Opcode::Call;
+                    }
+
+                    std::string expression;
+                    if (!instruction.regions.empty()) {
+                        std::vector<std::pair<std::string, std::string>> regions;
+                        for (const auto &region : instruction.regions) {
+                            auto statements = std::exchange(this->m_output, { });
+                            auto result = this->emitBlock(region, indent + 1);
+                            regions.emplace_back(std::exchange(this->m_output, std::move(statements)), std::move(result));
+                        }
+
+                        // Regions that need statements of their own turn into if statements
+                        if (std::ranges::any_of(regions, [](const auto &region) { return !region.first.empty(); })) {
+                            this->emitConditional(instruction, regions, indent);
+                            continue;
+                        }
+
+                        expression = this->conditionalExpression(instruction, regions);
+                    } else {
+                        expression = this->expression(instruction);
+                    }
+
+                    // Bursts are structs, their elements are read from a local holding all of them
+                    if (instruction.opcode == Opcode::BusBurst) {
+                        this->m_expressions[instruction.id] = this->define(indent, instruction, expression);
+                        continue;
+                    }
+
+                    bool nest;
+                    switch (instruction.opcode) {
+                        case Opcode::Constant:
+                        case Opcode::Parameter:
+                        case Opcode::TemplateParameter:
+                            nest = true;
+                            break;
+                        default:
+                            if (instruction.type.kind == Type::Kind::Opaque || instruction.type.isSpan())
+                                nest = true;
+                            else if (instruction.hasSideEffects())
+                                nest = sideEffects == 1 && uses.count == 1 && !uses.nested;
+                            else
+                                nest = uses.count <= 1;
+                            break;
+                    }
+
+                    if (nest) {
+                        this->m_expressions[instruction.id] = std::move(expression);
+                    } else if (instruction.type.kind == Type::Kind::Void || uses.count == 0) {
+                        this->line(indent, "{};", expression);
+                    } else {
+                        this->m_expressions[instruction.id] = this->define(indent, instruction, expression);
+                    }
+                }
+
+                return block.result.has_value() ? this->m_expressions[*block.result] : std::string();
+            }
+
+            // Computes a value into a local, or into the state of a state machine so it's still there when it continues
+            auto define(size_t indent, const Instruction &instruction, const std::string &expression) -> std::string {
+                auto name = this->valueName(instruction);
+                if (this->m_async != nullptr)
+                    this->line(indent, "{} = {};", name, expression);
+                else
+                    this->line(indent, "const {} {} = {};", typeName(instruction), name, expression);
+
+                return name;
+            }
+
+            auto valueName(const Instruction &instruction) -> std::string {
+                auto name = fmt::format("_v{}", instruction.id);
+                if (this->m_async == nullptr)
+                    return name;
+
+                this->m_fields.emplace_back(typeName(instruction), name);
+                return fmt::format("s->{}", name);
+            }
+
+            // Bursts are structs named after the burst
+            static auto typeName(const Instruction &instruction) -> std::string {
+                return std::string(instruction.opcode == Opcode::BusBurst ? std::string_view(instruction.symbol) : instruction.type.name());
+            }
+
+            // Waits for the bus to be free, starts the transfer and waits for it to be done. The state machine returns while it waits
+            auto emitTransfer(const Instruction &instruction, size_t indent) -> void {
+                bool read = instruction.opcode != Opcode::BusWrite;
+                auto transfer = this->m_async->transfer(instruction, read ? instruction.type : this->m_types[instruction.operands.back()]);
+                if (!transfer.has_value()) {
+                    this->m_blocking = true;
+                    return;
+                }
+
+                auto arguments = transfer->arguments;
+                for (auto operand : instruction.operands)
+                    arguments.push_back(this->value(operand));
+
+                // Transfers always go over the bus, even for cached registers. Their copy keeps the value in the host's byte order
+                auto value = read ? transfer->end : arguments.back();
+                if (instruction.endianness.has_value() && instruction.opcode != Opcode::BusBurst) {
+                    if (read)
+                        value = convertByteOrder(value, instruction.type, *instruction.endianness);
+                    else
+                        arguments.back() = convertByteOrder(value, this->m_types[instruction.operands.back()], *instruction.endianness);
+                }
+
+                // Cached registers are only read if there's no valid copy
+                bool cached = !transfer->cache.empty();
+                if (read && cached) {
+                    this->line(indent, "if (!{}_cacheValid) {{", transfer->cache);
+                    indent += 1;
+                }
+
+                auto state = this->m_nextState;
+                this->m_nextState += 2;
+
+                // Waiting for its turn on a shared bus is part of waiting for the bus to be free
+                auto wait = this->m_async->acquire.empty() ? this->m_async->busy : fmt::format("!{} || {}", this->m_async->acquire, this->m_async->busy);
+
+                this->line(indent, "s->_state = {};", state);
+                this->line(indent, "// fall through");
+                this->line(indent - 1, "case {}:", state);
+                this->line(indent, "if ({})", wait);
+                this->line(indent + 1, "return true;");
+                // The transfer's interrupt may step the state machine right away, so it has to see the next state already
+                this->line(indent, "__atomic_store_n(&s->_state, {}, __ATOMIC_RELEASE);", state + 1);
+                this->line(indent, "{}({});", transfer->begin, fmt::join(arguments, ", "));
+                this->line(indent, "return true;");
+                this->line(indent - 1, "case {}:", state + 1);
+                this->line(indent, "if ({})", this->m_async->busy);
+                this->line(indent + 1, "return true;");
+
+                if (cached) {
+                    this->line(indent, "{}_cache = {};", transfer->cache, value);
+                    this->line(indent, "{}_cacheValid = true;", transfer->cache);
+                }
+
+                // The value has to be taken out of the bus driver before the next transfer may start
+                if (read && !cached)
+                    this->m_expressions[instruction.id] = this->define(indent, instruction, value);
+                if (!this->m_async->release.empty())
+                    this->line(indent, "{};", this->m_async->release);
+
+                if (read && cached) {
+                    indent -= 1;
+                    this->line(indent, "}}");
+                    this->m_expressions[instruction.id] = this->define(indent, instruction, fmt::format("{}_cache", transfer->cache));
+                }
+            }
+
+            auto emitConditional(const Instruction &instruction, const std::vector<std::pair<std::string, std::string>> &regions, size_t indent) -> void {
+                auto condition = this->value(instruction.operands[0]);
+                bool isVoid = instruction.type.kind == Type::Kind::Void;
+                bool isSelect = instruction.opcode == Opcode::Select;
+
+                // State machines keep the value in their state, the branches may return in the middle
+                auto name = !isVoid || !isSelect ? this->valueName(instruction) : std::string();
+
+                auto branch = [&](const std::pair<std::string, std::string> &region) {
+                    this->m_output += region.first;
+                    if (isVoid) {
+                        if (!region.second.empty())
+                            this->line(indent + 1, "{};", region.second);
+                    } else {
+                        this->line(indent + 1, "{} = {};", name, region.second);
+                    }
+                };
+
+                if (isSelect) {
+                    if (!isVoid && this->m_async == nullptr)
+                        this->line(indent, "{} {};", instruction.type.name(), name);
+
+                    this->line(indent, "if ({}) {{", condition);
+                    branch(regions[0]);
+                    this->line(indent, "}} else {{");
+                    branch(regions[1]);
+                    this->line(indent, "}}");
+                } else {
+                    // The right hand side is only evaluated if the left hand side doesn't decide the result yet
+                    this->line(indent, "{}{} = {};", this->m_async == nullptr ? "bool " : "", name, condition);
+                    this->line(indent, "if ({}{}) {{", instruction.opcode == Opcode::LogicalAnd ? "" : "!", name);
+                    branch(regions[0]);
+                    this->line(indent, "}}");
+                }
+
+                this->m_expressions[instruction.id] = isVoid ? std::string() : name;
+            }
+
+            auto conditionalExpression(const Instruction &instruction, const std::vector<std::pair<std::string, std::string>> &regions) -> std::string {
+                auto condition = this->value(instruction.operands[0]);
+
+                switch (instruction.opcode) {
+                    case Opcode::Select:        return fmt::format("({} ? {} : {})", condition, regions[0].second, regions[1].second);
+                    case Opcode::LogicalAnd:    return fmt::format("({} && {})", condition, regions[0].second);
+                    case Opcode::LogicalOr:     return fmt::format("({} || {})", condition, regions[0].second);
+                    default:                    return { };
+                }
+            }
+
+            auto expression(const Instruction &instruction) -> std::string {
+                const auto &operands = instruction.operands;
+
+                switch (instruction.opcode) {
+                    case Opcode::Constant:
+                        return instruction.symbol.empty() ? constant(instruction) : instruction.symbol;
+                    case Opcode::Parameter: {
+                        auto name = this->m_async != nullptr ? fmt::format("s->{}", instruction.symbol) : instruction.symbol;
+
+                        // bytes and strings are passed on as their pointer followed by their length
+                        return instruction.type.isSpan() ? fmt::format("{0}, {0}_size", name) : name;
+                    }
+                    case Opcode::TemplateParameter:
+                        return instruction.symbol;
+                    case Opcode::Index:
+                        return fmt::format("{}[{}]", instruction.symbol, this->value(operands[0]));
+                    case Opcode::Cast:
+                        return fmt::format("(({}){})", instruction.type.name(), this->value(operands[0]));
+                    case Opcode::Unary:
+                        return fmt::format("({}{})", instruction.symbol, this->value(operands[0]));
+                    case Opcode::Binary:
+                        return fmt::format("({} {} {})", this->value(operands[0]), instruction.symbol, this->value(operands[1]));
+                    case Opcode::Call:
+                    case Opcode::BusRead:
+                    case Opcode::BusWrite: {
+                        std::vector<std::string> arguments;
+                        for (auto operand : operands)
+                            arguments.push_back(this->value(operand));
+
+                        // Accessors of cached registers convert the value themselves, their copy is kept in the host's byte order
+                        bool convert = instruction.endianness.has_value() && instruction.opcode != Opcode::Call && (instruction.registerDeclaration == nullptr || !instruction.registerDeclaration->isCached());
+                        if (convert && instruction.opcode == Opcode::BusWrite)
+                            arguments.back() = convertByteOrder(arguments.back(), this->m_types[operands.back()], *instruction.endianness);
+
+                        auto call = fmt::format("{}({})", instruction.symbol, fmt::join(arguments, ", "));
+                        if (convert && instruction.opcode == Opcode::BusRead)
+                            return convertByteOrder(call, instruction.type, *instruction.endianness);
+
+                        return call;
+                    }
+                    case Opcode::BusBurst:
+                        return fmt::format("{}_read()", instruction.symbol);
+                    case Opcode::BurstElement:
+                        return fmt::format("{}.{}", this->value(operands[0]), instruction.symbol);
+                    default:
+                        return { };
+                }
+            }
+
+            // Folded values are formatted as literals of their type. Literals of the types C doesn't compute in as int get a cast
+            static auto constant(const Instruction &instruction) -> std::string {
+                // The smallest int can't be written as a negated literal, that would be a long already
+                if (instruction.type == Type { Type::Kind::Signed, 4 } && instruction.constant == ast::ConstantValue(i128(std::numeric_limits<i32>::min())))
+                    return "(-2147483647 - 1)";
+
+                auto literal = language::evaluator::formatValue(instruction.constant, instruction.type.builtin());
+
+                if (instruction.type.isInteger() && instruction.type.size >= 4 && instruction.type != Type { Type::Kind::Signed, 4 })
+                    return fmt::format("(({}){})", instruction.type.name(), literal);
+
+                return literal;
+            }
+
+            auto value(ValueId id) -> const std::string & {
+                return this->m_expressions[id];
+            }
+
+            template<typename ... Args>
+            auto line(size_t indent, fmt::format_string<Args...> format, Args &&...args) -> void {
+                fmt::format_to(std::back_inserter(this->m_output), "{:{}}", "", indent * 4);
+                fmt::format_to(std::back_inserter(this->m_output), format, std::forward<Args>(args)...);
+                this->m_output += '\n';
+            }
+
+        private:
+            const Function &m_function;
+            std::string m_output;
+
+            // Set when generating a state machine
+            const AsyncTarget *m_async;
+            std::vector<std::pair<std::string, std::string>> m_fields;
+            u32 m_nextState = 2;
+            bool m_blocking = false;
+            std::unordered_map<ValueId, Type> m_types;
+
+            std::unordered_map<ValueId, Uses> m_uses;
+            std::unordered_map<ValueId, const Block *> m_definedIn;
+
+            // C expression of every value, the name of its local if it has one
+            std::unordered_map<ValueId, std::string> m_expressions;
+        };
+
+    }
+
+    auto convertByteOrder(const std::string &value, Type type, ast::Endianness endianness) -> std::string {
+        bool floatingPoint = type.kind == Type::Kind::FloatingPoint;
+        if ((!type.isInteger() && !floatingPoint) || type.size <= 1)
+            return value;
+
+        auto call = fmt::format("drv_{}Endian{}{}({})", endianness == ast::Endianness::Big ? "big" : "little", floatingPoint ? "F" : "", type.size * 8, value);
+        if (floatingPoint)
+            return call;
+
+        return type.kind == Type::Kind::Unsigned ? call : fmt::format("(({}){})", type.name(), call);
+    }
+
+    auto generateC(const Function &function) -> std::string {
+        return Emitter(function).emit();
+    }
+
+    auto generateAsyncC(const Function &function, const AsyncTarget &target) -> std::optional<AsyncCode> {
+        return Emitter(function, &target).emitAsync();
+    }
+
+}
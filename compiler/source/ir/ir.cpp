@@ -0,0 +1,185 @@
+#include <compiler/ir/ir.hpp>
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+
+namespace compiler::ir {
+
+    auto Type::builtin() const -> ast::NodeBuiltinType {
+        using enum ast::NodeBuiltinType::Type;
+
+        switch (this->kind) {
+            case Kind::Unsigned:        return ast::NodeBuiltinType(Unsigned, this->size);
+            case Kind::Signed:          return ast::NodeBuiltinType(Signed, this->size);
+            case Kind::FloatingPoint:   return ast::NodeBuiltinType(FloatingPoint, this->size);
+            default:                    return ast::NodeBuiltinType(Boolean, 1);
+        }
+    }
+
+    auto Type::name() const -> std::string_view {
+        switch (this->kind) {
+            case Kind::Boolean:         return "bool";
+            case Kind::FloatingPoint:   return this->size == 4 ? "f32" : "f64";
+            case Kind::Unsigned:
+                switch (this->size) {
+                    case 1:  return "u8";
+                    case 2:  return "u16";
+                    case 4:  return "u32";
+                    default: return "u64";
+                }
+            case Kind::Signed:
+                switch (this->size) {
+                    case 1:  return "i8";
+                    case 2:  return "i16";
+                    case 4:  return "i32";
+                    default: return "i64";
+                }
+            case Kind::Bytes:           return "u8 *";
+            case Kind::String:          return "const char *";
+            default:
+                return "void";
+        }
+    }
+
+    auto Type::fromName(std::string_view name) -> Type {
+        static constexpr std::array Names = { "u8", "u16", "u32", "u64", "i8", "i16", "i32", "i64", "f32", "f64", "bool" };
+
+        if (std::ranges::find(Names, name) == Names.end())
+            return { name == "void" ? Kind::Void : Kind::Opaque, 0 };
+
+        Kind kind = name == "bool" ? Kind::Boolean : name[0] == 'u' ? Kind::Unsigned : name[0] == 'i' ? Kind::Signed : Kind::FloatingPoint;
+        u8 size = name == "bool" || name.ends_with('8') ? 1 : name.ends_with("16") ? 2 : name.ends_with("32") ? 4 : 8;
+
+        return { kind, size };
+    }
+
+    auto Type::fromBuiltin(const ast::NodeBuiltinType &type) -> Type {
+        using enum ast::NodeBuiltinType::Type;
+
+        switch (type.type()) {
+            case Unsigned:      return { Kind::Unsigned, u8(type.size()) };
+            case Signed:        return { Kind::Signed, u8(type.size()) };
+            case FloatingPoint: return { Kind::FloatingPoint, u8(type.size()) };
+            case Boolean:       return { Kind::Boolean, 1 };
+            case Bytes:         return { Kind::Bytes, 0 };
+            case String:        return { Kind::String, 0 };
+        }
+
+        return { };
+    }
+
+    auto promote(Type type) -> Type {
+        if (type.isInteger() && (type.kind == Type::Kind::Boolean || type.size < 4))
+            return { Type::Kind::Signed, 4 };
+
+        return type;
+    }
+
+    auto commonType(Type left, Type right) -> Type {
+        using enum Type::Kind;
+
+        if (!left.isArithmetic() || !right.isArithmetic())
+            return { Opaque, 0 };
+
+        if (left.kind == FloatingPoint || right.kind == FloatingPoint)
+            return { FloatingPoint, std::max(left.kind == FloatingPoint ? left.size : u8(0), right.kind == FloatingPoint ? right.size : u8(0)) };
+
+        left = promote(left);
+        right = promote(right);
+        if (left.size != right.size)
+            return left.size > right.size ? left : right;
+        if (left.kind == Unsigned || right.kind == Unsigned)
+            return { Unsigned, left.size };
+
+        return left;
+    }
+
+    auto Instruction::hasSideEffects() const -> bool {
+        switch (this->opcode) {
+            case Opcode::Call:
+            case Opcode::BusRead:
+            case Opcode::BusWrite:
+            case Opcode::BusBurst:
+                return true;
+            default:
+                return std::ranges::any_of(this->regions, [](const Block &region) {
+                    return std::ranges::any_of(region.instructions, &Instruction::hasSideEffects);
+                });
+        }
+    }
+
+    namespace {
+
+        auto opcodeName(Opcode opcode) -> std::string_view {
+            switch (opcode) {
+                case Opcode::Constant:          return "const";
+                case Opcode::Parameter:         return "param";
+                case Opcode::TemplateParameter: return "template";
+                case Opcode::Index:             return "index";
+                case Opcode::Cast:              return "cast";
+                case Opcode::Unary:             return "unary";
+                case Opcode::Binary:            return "binary";
+                case Opcode::Select:            return "select";
+                case Opcode::LogicalAnd:        return "and";
+                case Opcode::LogicalOr:         return "or";
+                case Opcode::Call:              return "call";
+                case Opcode::BusRead:           return "read";
+                case Opcode::BusWrite:          return "write";
+                case Opcode::BusBurst:          return "burst";
+                case Opcode::BurstElement:      return "element";
+            }
+
+            return "unknown";
+        }
+
+        auto printBlock(std::string &output, const Block &block, size_t indent) -> void {
+            for (const auto &instruction : block.instructions) {
+                auto out = std::back_inserter(output);
+                fmt::format_to(out, "{:{}}%{}: {} = {}", "", indent * 4, instruction.id, instruction.type.name(), opcodeName(instruction.opcode));
+
+                if (instruction.opcode == Opcode::Constant) {
+                    std::visit([&](auto value) { fmt::format_to(out, " {}", value); }, instruction.constant);
+                } else if (!instruction.symbol.empty()) {
+                    fmt::format_to(out, " {}", instruction.symbol);
+                }
+
+                for (size_t i = 0; i < instruction.operands.size(); i++)
+                    fmt::format_to(out, "{}%{}", i == 0 ? " " : ", ", instruction.operands[i]);
+
+                if (instruction.endianness.has_value())
+                    fmt::format_to(out, " {}", *instruction.endianness == ast::Endianness::Big ? "big" : "little");
+
+                for (const auto &region : instruction.regions) {
+                    output += " {\n";
+                    printBlock(output, region, indent + 1);
+                    fmt::format_to(std::back_inserter(output), "{:{}}}}", "", indent * 4);
+                    if (region.result.has_value())
+                        fmt::format_to(std::back_inserter(output), " -> %{}", *region.result);
+                }
+
+                output += '\n';
+            }
+        }
+
+    }
+
+    auto print(const Function &function) -> std::string {
+        std::vector<std::string> parameters;
+        for (const auto &[name, type] : function.parameters)
+            parameters.push_back(fmt::format("{} {}", type.name(), name));
+
+        auto output = fmt::format("fn {}({}) -> {} {{\n", function.symbol, fmt::join(parameters, ", "), function.returnType.name());
+        printBlock(output, function.body, 1);
+
+        if (function.body.result.has_value())
+            fmt::format_to(std::back_inserter(output), "    return %{}\n", *function.body.result);
+        output += "}\n\n";
+
+        return output;
+    }
+
+}
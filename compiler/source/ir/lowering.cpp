@@ -0,0 +1,582 @@
+#include <compiler/ir/lowering.hpp>
+#include <compiler/ir/passes.hpp>
+
+#include <compiler/helpers/names.hpp>
+#include <compiler/language/evaluator.hpp>
+
+#include <algorithm>
+#include <limits>
+
+#include <fmt/format.h>
+
+namespace compiler::ir {
+
+    using Operation = ast::NodeExpression::Operation;
+
+    namespace {
+
+        // Template values are passed on as they were written, or formatted as C literals if they were computed
+        auto parseTemplateValue(const ast::TemplateValue &value, Type type) -> std::optional<ast::ConstantValue> {
+            if (value.type != lexer::Token::Type::NumericLiteral || !type.isArithmetic())
+                return std::nullopt;
+
+            std::string_view literal = value.value;
+            bool negative = literal.starts_with('-');
+            if (negative)
+                literal.remove_prefix(1);
+            if (literal.contains('.') && literal.ends_with('f'))
+                literal.remove_suffix(1);
+
+            auto parsed = language::evaluator::parseNumericLiteral(literal);
+            if (!parsed.has_value())
+                return std::nullopt;
+
+            if (negative) {
+                parsed = language::evaluator::applyUnaryOperator("-", *parsed);
+                if (!parsed.has_value())
+                    return std::nullopt;
+            }
+
+            return language::evaluator::convert(*parsed, type.builtin());
+        }
+
+    }
+
+    auto Lowering::lower(const ast::NodeFunction &function, const ast::NodeDriver &driver, const TypeArguments &typeArguments, const std::string &symbol) -> const Function * {
+        if (auto lowered = this->m_module.find(symbol); lowered != nullptr)
+            return lowered;
+        if (function.expression() == nullptr || std::ranges::find(this->m_failed, symbol) != this->m_failed.end())
+            return nullptr;
+
+        Function lowered;
+        std::vector<Type> types;
+
+        auto previousScope = std::exchange(this->m_scope, Scope { &function, &driver, &typeArguments, &lowered, &types });
+
+        lowered.symbol = symbol;
+        lowered.alwaysInline = function.attributes().withDefaults(driver.functionAttributes()).inlining == ast::FunctionAttributes::Inlining::Always;
+        lowered.returnType = function.returnType() != nullptr ? this->typeOf(*function.returnType()) : Type { };
+        for (const auto &parameter : function.parameters())
+            lowered.parameters.emplace_back(parameter->name(), this->typeOf(*parameter->type()));
+
+        auto result = this->lowerExpression(*function.expression(), lowered.body);
+
+        this->m_scope = previousScope;
+
+        if (!result.has_value()) {
+            this->m_failed.push_back(symbol);
+            return nullptr;
+        }
+
+        lowered.body.result = *result;
+        passes::optimize(lowered, this->m_module, this->m_burstResolver);
+
+        return &this->m_module.functions.emplace(symbol, std::move(lowered)).first->second;
+    }
+
+    auto Lowering::lowerExpression(const ast::NodeExpression &expression, Block &block) -> std::optional<ValueId> {
+        using enum Type::Kind;
+
+        const auto &operands = expression.operands();
+        switch (expression.operation()) {
+            case Operation::NumericLiteral: {
+                auto value = language::evaluator::parseNumericLiteral(expression.value());
+                if (!value.has_value())
+                    return std::nullopt;
+
+                // Same types as the parser infers, the smallest of int, unsigned int for hexadecimal literals, long long and unsigned long long
+                Type type = { FloatingPoint, 8 };
+                if (std::holds_alternative<i128>(*value)) {
+                    auto integer = std::get<i128>(*value);
+                    auto literal = expression.value();
+                    bool hexadecimal = literal.starts_with("0x") || literal.starts_with("0b") || literal.starts_with("0o");
+
+                    // C reads a leading zero as octal, the evaluator doesn't. Those are generated straight from the AST
+                    if (!hexadecimal && literal.size() > 1 && literal.starts_with('0'))
+                        return std::nullopt;
+
+                    if (integer <= std::numeric_limits<i32>::max())
+                        type = { Signed, 4 };
+                    else if (integer <= std::numeric_limits<u32>::max() && hexadecimal)
+                        type = { Unsigned, 4 };
+                    else if (integer <= std::numeric_limits<i64>::max())
+                        type = { Signed, 8 };
+                    else
+                        type = { Unsigned, 8 };
+                }
+
+                // C has no binary or octal literals with these prefixes, those are formatted from their value instead
+                std::string spelling;
+                if (!expression.value().starts_with("0b") && !expression.value().starts_with("0o"))
+                    spelling = expression.value();
+
+                return this->emit(block, { .opcode = Opcode::Constant, .type = type, .symbol = std::move(spelling), .constant = *value });
+            }
+            case Operation::CharacterLiteral:
+                // Escape sequences aren't decoded, functions using them are generated straight from the AST
+                if (expression.value().size() != 1)
+                    return std::nullopt;
+
+                return this->emit(block, { .opcode = Opcode::Constant, .type = { Signed, 4 }, .symbol = fmt::format("'{}'", expression.value()), .constant = i128(u8(expression.value().front())) });
+            case Operation::StringLiteral:
+                return this->emit(block, { .opcode = Opcode::Constant, .type = { Opaque, 0 }, .symbol = fmt::format("\"{}\"", expression.value()) });
+            case Operation::Identifier:
+                return this->lowerIdentifier(expression.value(), block);
+            case Operation::UnaryOperator: {
+                auto operand = this->lowerExpression(*operands[0], block);
+                if (!operand.has_value() || !this->valueType(*operand).isArithmetic())
+                    return std::nullopt;
+
+                auto type = expression.value() == "!" ? Type { Boolean, 1 } : promote(this->valueType(*operand));
+                return this->emit(block, { .opcode = Opcode::Unary, .type = type, .symbol = std::string(expression.value()), .operands = { *operand } });
+            }
+            case Operation::BinaryOperator: {
+                auto op = expression.value();
+
+                auto left = this->lowerExpression(*operands[0], block);
+                if (!left.has_value() || !this->valueType(*left).isArithmetic())
+                    return std::nullopt;
+
+                // The right hand side of logical operators is only evaluated if it's needed
+                if (op == "&&" || op == "||") {
+                    auto right = this->lowerRegion(*operands[1]);
+                    if (!right.has_value() || !this->valueType(*right->result).isArithmetic())
+                        return std::nullopt;
+
+                    std::vector<Block> regions;
+                    regions.push_back(std::move(*right));
+
+                    return this->emit(block, { .opcode = op == "&&" ? Opcode::LogicalAnd : Opcode::LogicalOr, .type = { Boolean, 1 }, .operands = { *left }, .regions = std::move(regions) });
+                }
+
+                auto right = this->lowerExpression(*operands[1], block);
+                if (!right.has_value() || !this->valueType(*right).isArithmetic())
+                    return std::nullopt;
+
+                Type type;
+                if (op == "==" || op == "!=" || op == "<" || op == ">" || op == "<=" || op == ">=")
+                    type = { Boolean, 1 };
+                else if (op == "<<" || op == ">>")
+                    type = promote(this->valueType(*left));
+                else
+                    type = commonType(this->valueType(*left), this->valueType(*right));
+
+                return this->emit(block, { .opcode = Opcode::Binary, .type = type, .symbol = std::string(op), .operands = { *left, *right } });
+            }
+            case Operation::TernaryOperator: {
+                auto condition = this->lowerExpression(*operands[0], block);
+                if (!condition.has_value() || !this->valueType(*condition).isArithmetic())
+                    return std::nullopt;
+
+                std::vector<Block> regions;
+                for (size_t i = 1; i <= 2; i++) {
+                    auto region = this->lowerRegion(*operands[i]);
+                    if (!region.has_value())
+                        return std::nullopt;
+
+                    regions.push_back(std::move(*region));
+                }
+
+                // Both sides are void or both are values
+                auto trueType = this->valueType(*regions[0].result), falseType = this->valueType(*regions[1].result);
+                Type type = trueType.kind == Void && falseType.kind == Void ? Type { } : commonType(trueType, falseType);
+                if (type.kind == Opaque)
+                    return std::nullopt;
+
+                return this->emit(block, { .opcode = Opcode::Select, .type = type, .operands = { *condition }, .regions = std::move(regions) });
+            }
+            case Operation::Index: {
+                auto name = operands[0]->value();
+
+                const ast::NodeConstant *table = nullptr;
+                const ast::NodeDriver *owner = nullptr;
+                for (auto driver = this->m_scope.driver; driver != nullptr && table == nullptr; driver = driver->inheritance()) {
+                    for (const auto &constant : driver->constants()) {
+                        if (constant->name() == name && constant->isTable()) {
+                            table = constant.get();
+                            owner = driver;
+                        }
+                    }
+                }
+
+                if (table == nullptr)
+                    return std::nullopt;
+
+                auto index = this->lowerExpression(*operands[1], block);
+                if (!index.has_value() || !this->valueType(*index).isInteger())
+                    return std::nullopt;
+
+                return this->emit(block, {
+                    .opcode = Opcode::Index,
+                    .type = Type::fromBuiltin(table->builtinType()),
+                    .symbol = fmt::format("{}_{}", hlp::driverPrefix(owner->name()), name),
+                    .operands = { *index },
+                    .table = table
+                });
+            }
+            case Operation::Call:
+                return this->lowerCall(expression, block);
+            case Operation::Field:
+                return this->lowerField(expression, block);
+            case Operation::Assignment:
+                return this->lowerAssignment(expression, block);
+            case Operation::Sequence: {
+                std::optional<ValueId> result;
+                for (const auto &operand : operands) {
+                    result = this->lowerExpression(*operand, block);
+                    if (!result.has_value())
+                        return std::nullopt;
+                }
+
+                return result;
+            }
+            case Operation::Lambda:
+            case Operation::Array:
+                break;
+        }
+
+        return std::nullopt;
+    }
+
+    auto Lowering::lowerIdentifier(std::string_view name, Block &block) -> std::optional<ValueId> {
+        using enum Type::Kind;
+
+        for (const auto &parameter : this->m_scope.function->parameters()) {
+            if (parameter->name() == name)
+                return this->emit(block, { .opcode = Opcode::Parameter, .type = this->typeOf(*parameter->type()), .symbol = std::string(name) });
+        }
+
+        // Template values of inherited drivers are known, those of the driver itself are only known by the drivers inheriting from it
+        for (auto driver = this->m_scope.driver; driver != nullptr; driver = driver->inheritance()) {
+            const auto &parameters = driver->templateParameters();
+            for (size_t i = 0; i < parameters.size(); i++) {
+                if (parameters[i]->name() != name)
+                    continue;
+
+                auto type = this->typeOf(*parameters[i]->type());
+                if (i < driver->templateValues().size()) {
+                    if (auto value = parseTemplateValue(driver->templateValues()[i], type); value.has_value())
+                        return this->emit(block, { .opcode = Opcode::Constant, .type = type, .constant = *value });
+                }
+
+                return this->emit(block, { .opcode = Opcode::TemplateParameter, .type = type, .symbol = fmt::format("{}_{}()", hlp::driverPrefix(driver->name()), name) });
+            }
+        }
+
+        for (auto driver = this->m_scope.driver; driver != nullptr; driver = driver->inheritance()) {
+            for (const auto &constant : driver->constants()) {
+                if (constant->name() != name)
+                    continue;
+
+                if (constant->isTable())
+                    return std::nullopt;
+
+                return this->emit(block, { .opcode = Opcode::Constant, .type = Type::fromBuiltin(constant->builtinType()), .constant = constant->values().front() });
+            }
+        }
+
+        // Registers are read as a whole
+        if (auto declaration = this->findRegister(name); declaration != nullptr)
+            return this->lowerRegisterAccess(*declaration, std::nullopt, block);
+
+        // Buffers are passed as their address and their size, neither ever changes
+        for (auto driver = this->m_scope.driver; driver != nullptr; driver = driver->inheritance()) {
+            for (const auto &buffer : driver->buffers()) {
+                if (buffer->name() == name)
+                    return this->emit(block, { .opcode = Opcode::Constant, .type = { Bytes, 0 }, .symbol = fmt::format("{0}_{1}, sizeof({0}_{1})", hlp::driverPrefix(driver->name()), name) });
+            }
+        }
+
+        if (name == "true" || name == "false")
+            return this->emit(block, { .opcode = Opcode::Constant, .type = { Boolean, 1 }, .symbol = std::string(name), .constant = i128(name == "true") });
+
+        // Constants of other drivers aren't part of the scope
+        return std::nullopt;
+    }
+
+    auto Lowering::lowerCall(const ast::NodeExpression &expression, Block &block) -> std::optional<ValueId> {
+        const ast::NodeFunction *function = nullptr;
+        const ast::NodeDriver *owner = nullptr;
+        for (auto driver = this->m_scope.driver; driver != nullptr && function == nullptr; driver = driver->inheritance()) {
+            for (const auto &candidate : driver->functions()) {
+                if (candidate->name() == expression.value()) {
+                    function = candidate.get();
+                    owner = driver;
+                    break;
+                }
+            }
+        }
+
+        if (function == nullptr || function->parameters().size() != expression.operands().size())
+            return std::nullopt;
+
+        // Type parameters of the function that's currently being lowered are replaced with their types
+        std::vector<std::string> typeArguments;
+        TypeArguments calleeTypeArguments;
+        for (size_t i = 0; i < expression.typeArguments().size() && i < function->typeParameters().size(); i++) {
+            const auto &argument = expression.typeArguments()[i];
+
+            auto it = std::ranges::find(*this->m_scope.typeArguments, std::string_view(argument), &TypeArguments::value_type::first);
+            typeArguments.push_back(it != this->m_scope.typeArguments->end() ? it->second : argument);
+            calleeTypeArguments.emplace_back(function->typeParameters()[i], typeArguments.back());
+        }
+
+        std::vector<ValueId> arguments;
+        for (size_t i = 0; i < expression.operands().size(); i++) {
+            const auto &operand = *expression.operands()[i];
+            const auto &parameterType = *function->parameters()[i]->type();
+
+            // String literals passed as a string get their length, it's known at compile time
+            if (operand.operation() == Operation::StringLiteral && !parameterType.isTypeParameter() && this->typeOf(parameterType).kind == Type::Kind::String) {
+                arguments.push_back(this->emit(block, { .opcode = Opcode::Constant, .type = { Type::Kind::String, 0 }, .symbol = fmt::format("\"{0}\", sizeof(\"{0}\") - 1", operand.value()) }));
+                continue;
+            }
+
+            auto argument = this->lowerExpression(operand, block);
+            if (!argument.has_value() || this->valueType(*argument).kind == Type::Kind::Void)
+                return std::nullopt;
+
+            arguments.push_back(*argument);
+        }
+
+        auto symbol = this->m_resolver(*function, *owner, typeArguments);
+
+        Type type;
+        if (function->returnType() != nullptr) {
+            auto previousTypeArguments = std::exchange(this->m_scope.typeArguments, &calleeTypeArguments);
+            type = this->typeOf(*function->returnType());
+            this->m_scope.typeArguments = previousTypeArguments;
+        }
+
+        Instruction call = { .opcode = Opcode::Call, .type = type, .symbol = symbol, .operands = std::move(arguments) };
+        if (function->expression() != nullptr) {
+            // Lowered in the context of the driver declaring it so its body can be inlined, unless its attributes keep it out of line
+            call.inlinable = this->lower(*function, *owner, calleeTypeArguments, symbol) != nullptr && function->attributes().withDefaults(owner->functionAttributes()).isInlinable();
+        } else if (function->name() == "readRegister" && call.operands.size() == 1 && type.isArithmetic()) {
+            call.opcode = Opcode::BusRead;
+            call.endianness = this->deviceEndianness();
+        } else if (function->name() == "writeRegister" && call.operands.size() == 2 && type.kind == Type::Kind::Void) {
+            call.opcode = Opcode::BusWrite;
+            call.endianness = this->deviceEndianness();
+        }
+
+        return this->emit(block, std::move(call));
+    }
+
+    auto Lowering::lowerRegion(const ast::NodeExpression &expression) -> std::optional<Block> {
+        Block region;
+
+        auto result = this->lowerExpression(expression, region);
+        if (!result.has_value())
+            return std::nullopt;
+
+        region.result = *result;
+        return region;
+    }
+
+    auto Lowering::lowerField(const ast::NodeExpression &expression, Block &block) -> std::optional<ValueId> {
+        using enum Type::Kind;
+
+        const auto &target = *expression.operands()[0];
+        auto declaration = target.operation() == Operation::Identifier ? this->findRegister(target.value()) : nullptr;
+        auto field = declaration != nullptr ? declaration->findField(expression.value()) : nullptr;
+        if (field == nullptr)
+            return std::nullopt;
+
+        auto raw = this->lowerRegisterAccess(*declaration, std::nullopt, block);
+        if (!raw.has_value())
+            return std::nullopt;
+
+        // Signed registers are masked as unsigned values so shifting them right doesn't shift in their sign
+        auto registerType = this->valueType(*raw);
+        Type unsignedType = { Unsigned, registerType.size };
+        auto value = registerType.size >= 4 ? this->emitCast(block, *raw, unsignedType) : *raw;
+
+        if (field->offset != 0)
+            value = this->emit(block, { .opcode = Opcode::Binary, .type = promote(this->valueType(value)), .symbol = ">>", .operands = { value, this->emitInteger(block, { Signed, 4 }, field->offset) } });
+
+        // Bits above the field only have to be masked out if there are any
+        if (field->offset + field->width < registerType.size * 8 || registerType.kind == Signed) {
+            auto mask = this->emitInteger(block, unsignedType, field->width == 64 ? ~u64(0) : (u64(1) << field->width) - 1);
+            value = this->emit(block, { .opcode = Opcode::Binary, .type = commonType(this->valueType(value), unsignedType), .symbol = "&", .operands = { value, mask } });
+        }
+
+        return this->emitCast(block, value, this->typeOf(*field->type));
+    }
+
+    auto Lowering::lowerAssignment(const ast::NodeExpression &expression, Block &block) -> std::optional<ValueId> {
+        using enum Type::Kind;
+
+        const auto &target = *expression.operands()[0];
+
+        auto value = this->lowerExpression(*expression.operands()[1], block);
+        if (!value.has_value() || !this->valueType(*value).isInteger())
+            return std::nullopt;
+
+        if (target.operation() == Operation::Identifier) {
+            auto declaration = this->findRegister(target.value());
+            if (declaration == nullptr)
+                return std::nullopt;
+
+            return this->lowerRegisterAccess(*declaration, *value, block);
+        }
+
+        auto declaration = target.operation() == Operation::Field ? this->findRegister(target.operands()[0]->value()) : nullptr;
+        auto field = declaration != nullptr ? declaration->findField(target.value()) : nullptr;
+        if (field == nullptr)
+            return std::nullopt;
+
+        // The other fields keep their value, so the register is read, modified and written back.
+        // Several fields updated one after another are merged into a single read and write by the passes
+        auto raw = this->lowerRegisterAccess(*declaration, std::nullopt, block);
+        if (!raw.has_value())
+            return std::nullopt;
+
+        auto registerType = this->valueType(*raw);
+        auto bits = registerType.size * 8;
+        Type unsignedType = { Unsigned, registerType.size };
+        auto mask = (field->width == 64 ? ~u64(0) : (u64(1) << field->width) - 1) << field->offset;
+
+        auto kept = registerType.size >= 4 ? this->emitCast(block, *raw, unsignedType) : *raw;
+        auto keptMask = this->emitInteger(block, unsignedType, ~mask & (bits == 64 ? ~u64(0) : (u64(1) << bits) - 1));
+        kept = this->emit(block, { .opcode = Opcode::Binary, .type = commonType(this->valueType(kept), unsignedType), .symbol = "&", .operands = { kept, keptMask } });
+
+        // The value is converted to the type of the field first, just like assigning it to a variable of that type
+        auto fieldType = this->typeOf(*field->type);
+        auto inserted = this->emitCast(block, *value, fieldType);
+        if (registerType.size >= 4 || fieldType.kind == Boolean)
+            inserted = this->emitCast(block, inserted, promote(unsignedType));
+        if (field->offset != 0)
+            inserted = this->emit(block, { .opcode = Opcode::Binary, .type = promote(this->valueType(inserted)), .symbol = "<<", .operands = { inserted, this->emitInteger(block, { Signed, 4 }, field->offset) } });
+        if (field->width < (fieldType.kind == Boolean ? 1 : fieldType.size * 8))
+            inserted = this->emit(block, { .opcode = Opcode::Binary, .type = commonType(this->valueType(inserted), unsignedType), .symbol = "&", .operands = { inserted, this->emitInteger(block, unsignedType, mask) } });
+
+        auto combined = this->emit(block, { .opcode = Opcode::Binary, .type = commonType(this->valueType(kept), this->valueType(inserted)), .symbol = "|", .operands = { kept, inserted } });
+
+        return this->lowerRegisterAccess(*declaration, combined, block);
+    }
+
+    // Reads the register if there's no value, writes the value to it otherwise
+    auto Lowering::lowerRegisterAccess(const ast::NodeRegister &declaration, std::optional<ValueId> value, Block &block) -> std::optional<ValueId> {
+        // Cached registers go through their accessors, those keep the copy in RAM up to date and only use the bus when they have to.
+        // So do memory mapped ones, their accessors are a single load or store
+        if (declaration.isCached() || declaration.isMemoryMapped()) {
+            for (auto driver = this->m_scope.driver; driver != nullptr; driver = driver->inheritance()) {
+                if (std::ranges::none_of(driver->registers(), [&](const auto &candidate) { return candidate.get() == &declaration; }))
+                    continue;
+
+                auto registerType = Type::fromBuiltin(declaration.builtinType());
+                Instruction access = {
+                    .opcode                 = value.has_value() ? Opcode::BusWrite : Opcode::BusRead,
+                    .type                   = value.has_value() ? Type { } : registerType,
+                    .symbol                 = fmt::format("{}_{}_{}", hlp::driverPrefix(driver->name()), declaration.name(), value.has_value() ? "write" : "read"),
+                    .registerDeclaration    = &declaration,
+                    .endianness             = declaration.endianness()
+                };
+
+                if (value.has_value())
+                    access.operands.push_back(this->emitCast(block, *value, registerType));
+
+                return this->emit(block, std::move(access));
+            }
+
+            return std::nullopt;
+        }
+
+        std::string_view name = value.has_value() ? "writeRegister" : "readRegister";
+        size_t parameterCount = value.has_value() ? 2 : 1;
+
+        const ast::NodeFunction *function = nullptr;
+        const ast::NodeDriver *owner = nullptr;
+        for (auto driver = this->m_scope.driver; driver != nullptr && function == nullptr; driver = driver->inheritance()) {
+            for (const auto &candidate : driver->functions()) {
+                if (candidate->name() == name && candidate->typeParameters().size() == 1 && candidate->parameters().size() == parameterCount) {
+                    function = candidate.get();
+                    owner = driver;
+                    break;
+                }
+            }
+        }
+
+        if (function == nullptr || function->expression() != nullptr)
+            return std::nullopt;
+
+        // The bus driver's function is instantiated with the type of the register
+        auto registerType = Type::fromBuiltin(declaration.builtinType());
+        std::vector<std::string> typeArguments = { std::string(registerType.name()) };
+        TypeArguments calleeTypeArguments = { { function->typeParameters().front(), typeArguments.front() } };
+
+        auto previousTypeArguments = std::exchange(this->m_scope.typeArguments, &calleeTypeArguments);
+        auto addressType = this->typeOf(*function->parameters()[0]->type());
+        auto valueType = value.has_value() ? this->typeOf(*function->parameters()[1]->type()) : Type { };
+        this->m_scope.typeArguments = previousTypeArguments;
+
+        if (!addressType.isInteger() || (value.has_value() && !valueType.isArithmetic()))
+            return std::nullopt;
+
+        Instruction access = {
+            .opcode                 = value.has_value() ? Opcode::BusWrite : Opcode::BusRead,
+            .type                   = value.has_value() ? Type { } : registerType,
+            .symbol                 = this->m_resolver(*function, *owner, typeArguments),
+            .registerDeclaration    = &declaration,
+            .endianness             = declaration.endianness()
+        };
+
+        access.operands.push_back(this->emitInteger(block, addressType, declaration.address()));
+        if (value.has_value())
+            access.operands.push_back(this->emitCast(block, *value, valueType));
+
+        return this->emit(block, std::move(access));
+    }
+
+    auto Lowering::findRegister(std::string_view name) const -> const ast::NodeRegister * {
+        for (auto driver = this->m_scope.driver; driver != nullptr; driver = driver->inheritance()) {
+            for (const auto &declaration : driver->registers()) {
+                if (declaration->name() == name)
+                    return declaration.get();
+            }
+        }
+
+        return nullptr;
+    }
+
+    auto Lowering::deviceEndianness() const -> std::optional<ast::Endianness> {
+        return this->m_scope.driver != nullptr ? this->m_scope.driver->deviceEndianness() : std::nullopt;
+    }
+
+    auto Lowering::emit(Block &block, Instruction instruction) -> ValueId {
+        instruction.id = this->m_scope.target->newValue();
+        this->m_scope.types->push_back(instruction.type);
+
+        block.instructions.push_back(std::move(instruction));
+        return block.instructions.back().id;
+    }
+
+    auto Lowering::emitInteger(Block &block, Type type, u64 value) -> ValueId {
+        return this->emit(block, { .opcode = Opcode::Constant, .type = type, .constant = language::evaluator::convert(i128(value), type.builtin()) });
+    }
+
+    auto Lowering::emitCast(Block &block, ValueId value, Type type) -> ValueId {
+        if (this->valueType(value) == type)
+            return value;
+
+        return this->emit(block, { .opcode = Opcode::Cast, .type = type, .operands = { value } });
+    }
+
+    auto Lowering::typeOf(const ast::NodeType &type) const -> Type {
+        if (type.isTypeParameter()) {
+            auto it = std::ranges::find(*this->m_scope.typeArguments, type.name(), &TypeArguments::value_type::first);
+            return it != this->m_scope.typeArguments->end() ? Type::fromName(it->second) : Type { Type::Kind::Opaque, 0 };
+        }
+
+        if (type.type() != nullptr && type.type()->kind() == ast::NodeKind::BuiltinType)
+            return Type::fromBuiltin(static_cast<const ast::NodeBuiltinType &>(*type.type()));
+
+        return Type::fromName(type.name());
+    }
+
+    auto Lowering::valueType(ValueId value) const -> Type {
+        return (*this->m_scope.types)[value];
+    }
+
+}
@@ -0,0 +1,715 @@
+#include <compiler/ir/passes.hpp>
+
+#include <compiler/language/evaluator.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+
+namespace compiler::ir::passes {
+
+    namespace {
+
+        // Callees bigger than this are called instead, expression bodies are almost always far below it
+        constexpr size_t MaxInlinedInstructions = 64;
+
+        using Replacements = std::unordered_map<ValueId, ValueId>;
+        using Types = std::unordered_map<ValueId, Type>;
+
+        auto resolve(const Replacements &replacements, ValueId value) -> ValueId {
+            for (auto it = replacements.find(value); it != replacements.end(); it = replacements.find(value))
+                value = it->second;
+
+            return value;
+        }
+
+        auto resolveOperands(Instruction &instruction, const Replacements &replacements) -> void {
+            for (auto &operand : instruction.operands)
+                operand = resolve(replacements, operand);
+        }
+
+        auto collectTypes(const Block &block, Types &types) -> void {
+            for (const auto &instruction : block.instructions) {
+                types[instruction.id] = instruction.type;
+                for (const auto &region : instruction.regions)
+                    collectTypes(region, types);
+            }
+        }
+
+        auto instructionCount(const Block &block) -> size_t {
+            size_t count = block.instructions.size();
+            for (const auto &instruction : block.instructions) {
+                for (const auto &region : instruction.regions)
+                    count += instructionCount(region);
+            }
+
+            return count;
+        }
+
+        auto isTrue(const ast::ConstantValue &value) -> bool {
+            return std::visit([](auto value) { return value != 0; }, value);
+        }
+
+        auto makeConstant(Instruction &instruction, const ast::ConstantValue &value) -> void {
+            instruction.opcode = Opcode::Constant;
+            instruction.constant = language::evaluator::convert(value, instruction.type.builtin());
+            instruction.symbol.clear();
+            instruction.operands.clear();
+            instruction.regions.clear();
+            instruction.table = nullptr;
+        }
+
+        class Inliner {
+        public:
+            Inliner(Function &function, const Module &module) : m_function(function), m_module(module) {
+                collectTypes(function.body, this->m_types);
+            }
+
+            auto run() -> void {
+                this->inlineBlock(this->m_function.body);
+            }
+
+        private:
+            auto inlineBlock(Block &block) -> void {
+                std::vector<Instruction> instructions;
+                instructions.reserve(block.instructions.size());
+
+                for (auto &instruction : block.instructions) {
+                    resolveOperands(instruction, this->m_replacements);
+                    for (auto &region : instruction.regions)
+                        this->inlineBlock(region);
+
+                    const Function *callee = nullptr;
+                    if (instruction.opcode == Opcode::Call && instruction.inlinable)
+                        callee = this->m_module.find(instruction.symbol);
+
+                    if (callee == nullptr || callee->parameters.size() != instruction.operands.size() || (!callee->alwaysInline && instructionCount(callee->body) > MaxInlinedInstructions)) {
+                        instructions.push_back(std::move(instruction));
+                        continue;
+                    }
+
+                    // Arguments are converted to the type of their parameter, just like when calling the function
+                    std::unordered_map<std::string_view, ValueId> arguments;
+                    for (size_t i = 0; i < callee->parameters.size(); i++) {
+                        const auto &[name, type] = callee->parameters[i];
+                        arguments[name] = this->convert(instructions, instruction.operands[i], type);
+                    }
+
+                    Replacements mapping;
+                    auto result = this->clone(callee->body, instructions, mapping, arguments);
+                    if (result.has_value())
+                        this->m_replacements[instruction.id] = this->convert(instructions, *result, callee->returnType);
+                }
+
+                block.instructions = std::move(instructions);
+                if (block.result.has_value())
+                    block.result = resolve(this->m_replacements, *block.result);
+            }
+
+            // Copies the callee's instructions with new ids, its parameters are replaced by the arguments
+            auto clone(const Block &source, std::vector<Instruction> &destination, Replacements &mapping, const std::unordered_map<std::string_view, ValueId> &arguments) -> std::optional<ValueId> {
+                for (const auto &instruction : source.instructions) {
+                    if (instruction.opcode == Opcode::Parameter) {
+                        mapping[instruction.id] = arguments.at(instruction.symbol);
+                        continue;
+                    }
+
+                    Instruction copy = {
+                        .id                     = this->m_function.newValue(),
+                        .opcode                 = instruction.opcode,
+                        .type                   = instruction.type,
+                        .symbol                 = instruction.symbol,
+                        .constant               = instruction.constant,
+                        .table                  = instruction.table,
+                        .registerDeclaration    = instruction.registerDeclaration,
+                        .inlinable              = instruction.inlinable
+                    };
+
+                    for (auto operand : instruction.operands)
+                        copy.operands.push_back(mapping.at(operand));
+
+                    for (const auto &region : instruction.regions) {
+                        Block copiedRegion;
+                        copiedRegion.result = this->clone(region, copiedRegion.instructions, mapping, arguments);
+                        copy.regions.push_back(std::move(copiedRegion));
+                    }
+
+                    mapping[instruction.id] = copy.id;
+                    this->m_types[copy.id] = copy.type;
+                    destination.push_back(std::move(copy));
+                }
+
+                if (!source.result.has_value())
+                    return std::nullopt;
+
+                return mapping.at(*source.result);
+            }
+
+            auto convert(std::vector<Instruction> &instructions, ValueId value, Type type) -> ValueId {
+                if (!type.isArithmetic() || this->m_types[value] == type)
+                    return value;
+
+                auto &cast = instructions.emplace_back(Instruction { .id = this->m_function.newValue(), .opcode = Opcode::Cast, .type = type, .operands = { value } });
+                this->m_types[cast.id] = type;
+
+                return cast.id;
+            }
+
+        private:
+            Function &m_function;
+            const Module &m_module;
+
+            Types m_types;
+            Replacements m_replacements;
+        };
+
+        class ConstantFolder {
+        public:
+            explicit ConstantFolder(Function &function) : m_function(function) {
+                collectTypes(function.body, this->m_types);
+            }
+
+            auto run() -> void {
+                this->foldBlock(this->m_function.body);
+            }
+
+        private:
+            auto foldBlock(Block &block) -> void {
+                std::vector<Instruction> instructions;
+                instructions.reserve(block.instructions.size());
+
+                for (auto &instruction : block.instructions) {
+                    resolveOperands(instruction, this->m_replacements);
+                    for (auto &region : instruction.regions)
+                        this->foldBlock(region);
+
+                    if (!this->fold(instruction, instructions))
+                        continue;
+
+                    if (instruction.opcode == Opcode::Constant)
+                        this->m_constants[instruction.id] = instruction.constant;
+
+                    instructions.push_back(std::move(instruction));
+                }
+
+                block.instructions = std::move(instructions);
+                if (block.result.has_value())
+                    block.result = resolve(this->m_replacements, *block.result);
+            }
+
+            // Folds the instruction in place. Returns false if it has been replaced by another value and should be dropped
+            auto fold(Instruction &instruction, std::vector<Instruction> &instructions) -> bool {
+                using namespace language::evaluator;
+
+                const auto &operands = instruction.operands;
+                switch (instruction.opcode) {
+                    case Opcode::Cast:
+                        if (this->m_types[operands[0]] == instruction.type) {
+                            this->m_replacements[instruction.id] = operands[0];
+                            return false;
+                        }
+
+                        if (auto value = this->constant(operands[0]); value != nullptr && instruction.type.isArithmetic())
+                            makeConstant(instruction, *value);
+                        break;
+                    case Opcode::Unary: {
+                        auto operand = this->constant(operands[0]);
+                        if (operand == nullptr || !instruction.type.isArithmetic())
+                            break;
+
+                        auto result = applyUnaryOperator(instruction.symbol, convert(*operand, promote(this->m_types[operands[0]]).builtin()));
+                        if (result.has_value())
+                            makeConstant(instruction, *result);
+                        break;
+                    }
+                    case Opcode::Binary: {
+                        auto left = this->constant(operands[0]), right = this->constant(operands[1]);
+                        if (left == nullptr || right == nullptr || !instruction.type.isArithmetic())
+                            break;
+
+                        auto leftType = this->m_types[operands[0]], rightType = this->m_types[operands[1]];
+                        const auto &op = instruction.symbol;
+
+                        // Operands are converted the way C converts them before applying the operator
+                        Type operandType = instruction.type;
+                        if (op == "==" || op == "!=" || op == "<" || op == ">" || op == "<=" || op == ">=") {
+                            operandType = commonType(leftType, rightType);
+                        } else if (op == "<<" || op == ">>") {
+                            // Shifting by the width of the type or more is undefined, it's reported once all constants are known
+                            auto amount = convert(*right, promote(rightType).builtin());
+                            if (!std::holds_alternative<i128>(amount) || std::get<i128>(amount) < 0 || std::get<i128>(amount) >= instruction.type.size * 8)
+                                break;
+                        }
+
+                        auto result = applyBinaryOperator(op, convert(*left, operandType.builtin()), op == "<<" || op == ">>" ? *right : convert(*right, operandType.builtin()));
+                        if (result.has_value())
+                            makeConstant(instruction, *result);
+                        break;
+                    }
+                    case Opcode::Index: {
+                        auto index = this->constant(operands[0]);
+                        if (index == nullptr || instruction.table == nullptr || !std::holds_alternative<i128>(*index))
+                            break;
+
+                        auto position = std::get<i128>(*index);
+                        if (position >= 0 && position < i128(instruction.table->values().size()))
+                            makeConstant(instruction, instruction.table->values()[size_t(position)]);
+                        break;
+                    }
+                    case Opcode::Select: {
+                        auto condition = this->constant(operands[0]);
+                        if (condition == nullptr)
+                            break;
+
+                        this->splice(instruction, instruction.regions[isTrue(*condition) ? 0 : 1], instructions);
+                        return false;
+                    }
+                    case Opcode::LogicalAnd:
+                    case Opcode::LogicalOr: {
+                        auto left = this->constant(operands[0]);
+                        if (left == nullptr)
+                            break;
+
+                        // The left hand side alone decides the result, the right hand side is never evaluated
+                        if (isTrue(*left) == (instruction.opcode == Opcode::LogicalOr)) {
+                            makeConstant(instruction, i128(isTrue(*left)));
+                            break;
+                        }
+
+                        this->splice(instruction, instruction.regions[0], instructions);
+                        return false;
+                    }
+                    default:
+                        break;
+                }
+
+                return true;
+            }
+
+            // Replaces an instruction by the instructions of one of its regions
+            auto splice(const Instruction &instruction, Block &region, std::vector<Instruction> &instructions) -> void {
+                std::ranges::move(region.instructions, std::back_inserter(instructions));
+
+                auto result = *region.result;
+                if (instruction.type.isArithmetic() && this->m_types[result] != instruction.type) {
+                    Instruction cast = { .id = instruction.id, .opcode = Opcode::Cast, .type = instruction.type, .operands = { result } };
+                    if (auto value = this->constant(result); value != nullptr) {
+                        makeConstant(cast, *value);
+                        this->m_constants[cast.id] = cast.constant;
+                    }
+
+                    instructions.push_back(std::move(cast));
+                    return;
+                }
+
+                this->m_replacements[instruction.id] = result;
+            }
+
+            auto constant(ValueId value) const -> const ast::ConstantValue * {
+                auto it = this->m_constants.find(value);
+                return it != this->m_constants.end() ? &it->second : nullptr;
+            }
+
+        private:
+            Function &m_function;
+
+            Types m_types;
+            Replacements m_replacements;
+            std::unordered_map<ValueId, ast::ConstantValue> m_constants;
+        };
+
+        class CommonSubexpressionEliminator {
+        public:
+            explicit CommonSubexpressionEliminator(Function &function) : m_function(function) { }
+
+            auto run() -> void {
+                this->eliminateInBlock(this->m_function.body, { });
+            }
+
+        private:
+            // Values available at some point, values of a block are available in all regions nested into it
+            struct Available {
+                std::unordered_map<std::string, ValueId> values;
+
+                // Register reads, forgotten as soon as anything could have changed the register
+                std::unordered_map<std::string, ValueId> reads;
+            };
+
+            // Returns true if the block contains a write or an opaque call
+            auto eliminateInBlock(Block &block, Available available) -> bool {
+                std::vector<Instruction> instructions;
+                instructions.reserve(block.instructions.size());
+
+                bool barrier = false;
+                for (auto &instruction : block.instructions) {
+                    resolveOperands(instruction, this->m_replacements);
+
+                    bool regionBarrier = false;
+                    for (auto &region : instruction.regions)
+                        regionBarrier = this->eliminateInBlock(region, available) || regionBarrier;
+
+                    switch (instruction.opcode) {
+                        case Opcode::Call:
+                        case Opcode::BusWrite:
+                            regionBarrier = true;
+                            break;
+                        case Opcode::BusRead:
+                            // Memory mapped registers are volatile, every read of them has to load them again
+                            if (instruction.registerDeclaration != nullptr && instruction.registerDeclaration->isMemoryMapped())
+                                break;
+                            [[fallthrough]];
+                        case Opcode::Constant:
+                        case Opcode::Parameter:
+                        case Opcode::TemplateParameter:
+                        case Opcode::Index:
+                        case Opcode::Cast:
+                        case Opcode::Unary:
+                        case Opcode::Binary: {
+                            auto &values = instruction.opcode == Opcode::BusRead ? available.reads : available.values;
+
+                            auto [it, inserted] = values.emplace(key(instruction), instruction.id);
+                            if (!inserted) {
+                                this->m_replacements[instruction.id] = it->second;
+                                continue;
+                            }
+                            break;
+                        }
+                        default:
+                            break;
+                    }
+
+                    if (regionBarrier) {
+                        available.reads.clear();
+                        barrier = true;
+                    }
+
+                    instructions.push_back(std::move(instruction));
+                }
+
+                block.instructions = std::move(instructions);
+                if (block.result.has_value())
+                    block.result = resolve(this->m_replacements, *block.result);
+
+                return barrier;
+            }
+
+            // Instructions with the same key compute the same value. Constant operands are compared by their value, not by how they were written
+            auto key(const Instruction &instruction) -> std::string {
+                std::string operands;
+                for (auto operand : instruction.operands) {
+                    auto it = this->m_constants.find(operand);
+                    operands += it != this->m_constants.end() ? it->second : fmt::format("%{}", operand);
+                    operands += ',';
+                }
+
+                auto constant = std::visit([](auto value) { return fmt::format("{}", value); }, instruction.constant);
+                auto result = fmt::format("{}:{}:{}:{}:{}:{}", u8(instruction.opcode), u8(instruction.type.kind), instruction.type.size, instruction.symbol, constant, operands);
+
+                // The same bytes read in a different byte order are a different value
+                if (instruction.endianness.has_value())
+                    result += fmt::format(":{}", u8(*instruction.endianness));
+
+                if (instruction.opcode == Opcode::Constant && instruction.type.isArithmetic())
+                    this->m_constants[instruction.id] = fmt::format("#{}:{}:{}", u8(instruction.type.kind), instruction.type.size, constant);
+
+                return result;
+            }
+
+        private:
+            Function &m_function;
+            Replacements m_replacements;
+
+            // Key of every constant's value
+            std::unordered_map<ValueId, std::string> m_constants;
+        };
+
+        class RegisterAccessCoalescer {
+        public:
+            explicit RegisterAccessCoalescer(Function &function) : m_function(function) {
+                collectTypes(function.body, this->m_types);
+            }
+
+            auto run() -> void {
+                this->coalesceInBlock(this->m_function.body);
+            }
+
+        private:
+            auto coalesceInBlock(Block &block) -> void {
+                // Last value written to every register and the writes nothing has been transferred over the bus since
+                std::unordered_map<const ast::NodeRegister *, ValueId> written;
+                std::unordered_map<const ast::NodeRegister *, size_t> pendingWrites;
+                std::unordered_set<ValueId> dropped;
+
+                std::vector<Instruction> instructions;
+                instructions.reserve(block.instructions.size());
+
+                for (auto &instruction : block.instructions) {
+                    resolveOperands(instruction, this->m_replacements);
+
+                    // Regions are only executed conditionally, nothing is merged across their boundaries
+                    for (auto &region : instruction.regions)
+                        this->coalesceInBlock(region);
+
+                    // Accesses of memory mapped registers are volatile loads and stores, each of them has to happen as it's written
+                    const auto *declaration = instruction.registerDeclaration;
+                    bool coalescable = declaration != nullptr && declaration->access() == ast::NodeRegister::Access::ReadWrite && !declaration->isMemoryMapped();
+
+                    switch (instruction.opcode) {
+                        case Opcode::BusRead:
+                            // Reading a register back returns what has been written to it before
+                            if (auto it = written.find(declaration); coalescable && it != written.end() && this->m_types[it->second] == instruction.type) {
+                                this->m_replacements[instruction.id] = it->second;
+                                continue;
+                            }
+
+                            pendingWrites.clear();
+                            break;
+                        case Opcode::BusWrite:
+                            if (!coalescable) {
+                                written.clear();
+                                pendingWrites.clear();
+                                break;
+                            }
+
+                            // A write that's overwritten before the register has been accessed again never has to happen
+                            if (auto it = pendingWrites.find(declaration); it != pendingWrites.end())
+                                dropped.insert(instructions[it->second].id);
+
+                            // Writes to other registers may change this one, they're kept in order
+                            written.clear();
+                            pendingWrites.clear();
+                            written[declaration] = instruction.operands.back();
+                            pendingWrites[declaration] = instructions.size();
+                            break;
+                        default:
+                            if (instruction.hasSideEffects()) {
+                                written.clear();
+                                pendingWrites.clear();
+                            }
+                            break;
+                    }
+
+                    instructions.push_back(std::move(instruction));
+                }
+
+                std::erase_if(instructions, [&](const Instruction &instruction) {
+                    return dropped.contains(instruction.id);
+                });
+
+                block.instructions = std::move(instructions);
+                if (block.result.has_value())
+                    block.result = resolve(this->m_replacements, *block.result);
+            }
+
+        private:
+            Function &m_function;
+
+            Types m_types;
+            Replacements m_replacements;
+        };
+
+        class RegisterReadMerger {
+        public:
+            RegisterReadMerger(Function &function, const BurstResolver &resolver) : m_function(function), m_resolver(resolver) { }
+
+            auto run() -> void {
+                this->mergeInBlock(this->m_function.body);
+            }
+
+        private:
+            auto mergeInBlock(Block &block) -> void {
+                // Bursts and the index of the instruction they're inserted in front of
+                std::vector<std::pair<size_t, Instruction>> bursts;
+
+                // Reads since the last instruction that may have changed what the registers hold. Other reads don't change them
+                std::vector<size_t> reads;
+                for (size_t i = 0; i < block.instructions.size(); i++) {
+                    auto &instruction = block.instructions[i];
+                    for (auto &region : instruction.regions)
+                        this->mergeInBlock(region);
+
+                    const auto *declaration = instruction.registerDeclaration;
+                    if (instruction.opcode == Opcode::BusRead && declaration != nullptr && !declaration->isCached() && !declaration->isMemoryMapped()) {
+                        reads.push_back(i);
+                    } else if (instruction.opcode != Opcode::BusRead && instruction.hasSideEffects()) {
+                        this->mergeReads(block, reads, bursts);
+                        reads.clear();
+                    }
+                }
+                this->mergeReads(block, reads, bursts);
+
+                if (bursts.empty())
+                    return;
+
+                std::ranges::sort(bursts, { }, &std::pair<size_t, Instruction>::first);
+
+                std::vector<Instruction> instructions;
+                instructions.reserve(block.instructions.size() + bursts.size());
+
+                auto burst = bursts.begin();
+                for (size_t i = 0; i < block.instructions.size(); i++) {
+                    for (; burst != bursts.end() && burst->first == i; ++burst)
+                        instructions.push_back(std::move(burst->second));
+
+                    instructions.push_back(std::move(block.instructions[i]));
+                }
+
+                block.instructions = std::move(instructions);
+            }
+
+            // Every run of reads of registers at consecutive addresses becomes a burst in front of the first of them.
+            // The reads turn into elements of the burst, they keep their ids so nothing has to be replaced
+            auto mergeReads(Block &block, const std::vector<size_t> &reads, std::vector<std::pair<size_t, Instruction>> &bursts) -> void {
+                auto address = [&](size_t index) {
+                    return block.instructions[index].registerDeclaration->address();
+                };
+
+                auto sorted = reads;
+                std::ranges::stable_sort(sorted, { }, address);
+
+                for (size_t begin = 0, end = 0; begin < sorted.size(); begin = end) {
+                    for (end = begin + 1; end < sorted.size() && address(sorted[end]) == address(sorted[end - 1]) + 1; end++) { }
+
+                    if (end - begin < 2)
+                        continue;
+
+                    std::vector<const ast::NodeRegister *> registers;
+                    for (size_t i = begin; i < end; i++)
+                        registers.push_back(block.instructions[sorted[i]].registerDeclaration);
+
+                    auto symbol = this->m_resolver(registers);
+                    if (!symbol.has_value())
+                        continue;
+
+                    Instruction burst = { .id = this->m_function.newValue(), .opcode = Opcode::BusBurst, .type = { Type::Kind::Opaque, 0 }, .symbol = std::move(*symbol), .registerDeclaration = registers.front() };
+                    for (size_t i = begin; i < end; i++) {
+                        auto &read = block.instructions[sorted[i]];
+                        read.opcode = Opcode::BurstElement;
+                        read.symbol = read.registerDeclaration->name();
+                        read.operands = { burst.id };
+                    }
+
+                    bursts.emplace_back(*std::ranges::min_element(sorted.begin() + begin, sorted.begin() + end), std::move(burst));
+                }
+            }
+
+        private:
+            Function &m_function;
+            const BurstResolver &m_resolver;
+        };
+
+        auto countUses(const Block &block, std::unordered_map<ValueId, size_t> &uses) -> void {
+            for (const auto &instruction : block.instructions) {
+                for (auto operand : instruction.operands)
+                    uses[operand] += 1;
+                for (const auto &region : instruction.regions)
+                    countUses(region, uses);
+            }
+
+            if (block.result.has_value())
+                uses[*block.result] += 1;
+        }
+
+        auto removeUnused(Block &block, const std::unordered_map<ValueId, size_t> &uses) -> bool {
+            bool removed = false;
+            for (auto &instruction : block.instructions) {
+                for (auto &region : instruction.regions)
+                    removed = removeUnused(region, uses) || removed;
+            }
+
+            auto erased = std::erase_if(block.instructions, [&](const Instruction &instruction) {
+                return !instruction.hasSideEffects() && !uses.contains(instruction.id);
+            });
+
+            return erased != 0 || removed;
+        }
+
+        auto collectConstants(const Block &block, std::unordered_map<ValueId, const Instruction *> &constants) -> void {
+            for (const auto &instruction : block.instructions) {
+                if (instruction.opcode == Opcode::Constant)
+                    constants[instruction.id] = &instruction;
+                for (const auto &region : instruction.regions)
+                    collectConstants(region, constants);
+            }
+        }
+
+        auto rejectUndefinedOperations(const Function &function, const Block &block, const std::unordered_map<ValueId, const Instruction *> &constants) -> void {
+            for (const auto &instruction : block.instructions) {
+                for (const auto &region : instruction.regions)
+                    rejectUndefinedOperations(function, region, constants);
+
+                if (instruction.opcode != Opcode::Binary || !instruction.type.isInteger())
+                    continue;
+
+                auto it = constants.find(instruction.operands[1]);
+                if (it == constants.end())
+                    continue;
+
+                const auto &op = instruction.symbol;
+                const auto &right = *it->second;
+                if ((op == "/" || op == "%") && !isTrue(right.constant))
+                    throw std::runtime_error(fmt::format("Division by zero in function \"{}\"", function.symbol));
+
+                if (op == "<<" || op == ">>") {
+                    auto amount = language::evaluator::convert(right.constant, promote(right.type).builtin());
+                    if (!std::holds_alternative<i128>(amount) || std::get<i128>(amount) < 0 || std::get<i128>(amount) >= instruction.type.size * 8)
+                        throw std::runtime_error(fmt::format("Shift amount out of range of {} in function \"{}\"", instruction.type.name(), function.symbol));
+                }
+            }
+        }
+
+    }
+
+    auto inlineCalls(Function &function, const Module &module) -> void {
+        Inliner(function, module).run();
+    }
+
+    auto propagateConstants(Function &function) -> void {
+        ConstantFolder(function).run();
+    }
+
+    auto eliminateCommonSubexpressions(Function &function) -> void {
+        CommonSubexpressionEliminator(function).run();
+    }
+
+    auto coalesceRegisterAccesses(Function &function) -> void {
+        RegisterAccessCoalescer(function).run();
+    }
+
+    auto mergeRegisterReads(Function &function, const BurstResolver &resolver) -> void {
+        RegisterReadMerger(function, resolver).run();
+    }
+
+    auto eliminateDeadCode(Function &function) -> void {
+        // Removing a value can make the values it used unused as well
+        for (bool removed = true; removed;) {
+            std::unordered_map<ValueId, size_t> uses;
+            countUses(function.body, uses);
+
+            removed = removeUnused(function.body, uses);
+        }
+    }
+
+    auto rejectUndefinedOperations(const Function &function) -> void {
+        std::unordered_map<ValueId, const Instruction *> constants;
+        collectConstants(function.body, constants);
+
+        rejectUndefinedOperations(function, function.body, constants);
+    }
+
+    auto optimize(Function &function, const Module &module, const BurstResolver &resolver) -> void {
+        inlineCalls(function, module);
+        propagateConstants(function);
+        eliminateCommonSubexpressions(function);
+        coalesceRegisterAccesses(function);
+        mergeRegisterReads(function, resolver);
+        eliminateDeadCode(function);
+        rejectUndefinedOperations(function);
+    }
+
+}
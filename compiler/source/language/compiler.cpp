@@ -2,101 +2,205 @@
 
 #include <compiler/language/lexer.hpp>
 #include <compiler/language/parser.hpp>
+#include <compiler/helpers/profiler.hpp>
 
 #include <wolv/io/file.hpp>
 
 namespace compiler::language {
 
-    auto Compiler::compileCode(std::string_view code, const std::map<std::string, std::string> &placeholders) -> std::vector<std::unique_ptr<ast::Node>> {
+    auto Compiler::compileDriver(std::string_view name, const compiler::specs::Driver &driver, std::string key, std::vector<DriverCache::Entry> &&dependencies) -> DriverCache::Entry {
+        auto result = std::make_shared<CompiledDriver>();
+        result->key          = std::move(key);
+        result->code         = driver.code;
+        result->config       = driver.config;
+        result->dependencies = std::move(dependencies);
 
         // Lex the source code into tokens
         std::vector<lexer::Token> tokens;
-        for (auto lexer = lexer::lex(code, placeholders); lexer;) {
-            auto result = lexer();
+        {
+            hlp::ScopedPhase phase("lex", name);
 
-            // Handle lexer errors
-            if (!result.has_value()) {
-                throw std::runtime_error(fmt::format("Lexer Error: {}", result.error()));
-            }
+            std::string_view code = result->code;
+            for (auto lexer = lexer::lex(code, result->config); lexer;) {
+                auto lexResult = lexer();
 
-            // Insert new tokens into list
-            tokens.emplace_back(result.value());
-        }
+                // Handle lexer errors
+                if (!lexResult.has_value()) {
+                    throw std::runtime_error(fmt::format("Lexer Error: {}", lexResult.error()));
+                }
 
-        std::vector<std::unique_ptr<ast::Node>> nodes;
+                // Insert new tokens into list
+                tokens.emplace_back(lexResult.value());
+            }
+        }
 
         // Prepare the parser, make drivers from dependencies available to the new parser
+        std::map<std::string, ast::NodeDriver*> dependencyDrivers;
+        for (const auto &dependency : result->dependencies) {
+            dependencyDrivers.insert(dependency->exports.begin(), dependency->exports.end());
+        }
+
         auto parser = parser::Parser();
-        parser.setDrivers(std::move(this->m_drivers));
+        parser.setDrivers(std::map(dependencyDrivers));
 
         // Parse the tokens into an AST
-        for (auto parse = parser.parse(tokens); parse;) {
-            auto result = parse();
+        {
+            hlp::ScopedPhase phase("parse", name);
 
-            // Handle parser errors
-            if (!result.has_value()) {
-                throw std::runtime_error(fmt::format("Parser Error: {}", result.error()));
-            }
+            for (auto parse = parser.parse(tokens); parse;) {
+                auto parseResult = parse();
+
+                // Handle parser errors
+                if (!parseResult.has_value()) {
+                    throw std::runtime_error(fmt::format("Parser Error: {}", parseResult.error()));
+                }
 
-            // Insert new AST nodes into list
-            nodes.emplace_back(std::move(result.value()));
+                // Insert new AST nodes into list
+                result->nodes.emplace_back(std::move(parseResult.value()));
+            }
         }
 
-        // Save new drivers for later use
-        this->m_drivers = parser.getDrivers();
+        // Only export the drivers declared by this driver itself
+        result->exports = parser.takeDrivers();
+        std::erase_if(result->exports, [&](const auto &entry) {
+            auto it = dependencyDrivers.find(entry.first);
+            return it != dependencyDrivers.end() && it->second == entry.second;
+        });
 
-        return nodes;
+        return result;
     }
 
-    auto Compiler::processDriver(const compiler::specs::Driver &driver) -> std::vector<std::unique_ptr<ast::Node>> {
-        std::vector<std::unique_ptr<ast::Node>> nodes;
-
+    auto Compiler::processDriver(const std::string &name, const compiler::specs::Driver &driver, std::vector<DriverCache::Entry> &result) -> DriverCache::Entry {
         auto &drivers = this->m_specsFile.drivers();
 
+        // Drivers that are depended on by multiple other drivers are only processed once
+        if (auto it = this->m_processedDrivers.find(name); it != this->m_processedDrivers.end())
+            return it->second;
+
+        if (!this->m_driversInProgress.insert(name).second)
+            throw std::runtime_error(fmt::format("Circular dependency on driver \"{}\"", name));
+
         // Recursively process all dependencies of the current driver
+        std::vector<DriverCache::Entry> dependencies;
         for (auto &dependency : driver.dependencies) {
 
-            // Make sure the dependency hasn't been compiled already
-            if (this->m_compiledDrivers.contains(dependency)) {
-                continue;
-            }
-
             // Make sure the dependency exists
             if (!drivers.contains(dependency))
                 throw std::runtime_error(fmt::format("Dependency \"{}\" does not exist", dependency));
 
             // Process the dependency
-            auto newNodes = processDriver(drivers.at(dependency));
-            std::move(newNodes.begin(), newNodes.end(), std::back_inserter(nodes));
+            dependencies.push_back(processDriver(dependency, drivers.at(dependency), result));
+        }
+
+        // The specs file never changes so an instantiation built from the same config and dependencies can be reused without asking the driver cache
+        std::vector<std::string> dependencyKeys;
+        for (const auto &dependency : dependencies)
+            dependencyKeys.push_back(dependency->key);
+
+        auto &instantiation = this->m_instantiations[{ name, DriverCache::hashConfig(driver.config), std::move(dependencyKeys) }];
+        if (instantiation == nullptr || instantiation->config != driver.config) {
+            // Drivers with the same code, config and dependencies are only compiled once, even across different specs files
+            auto key = DriverCache::makeKey(driver.code, driver.config, dependencies);
+            auto compiledDriver = this->m_driverCache->getOrCompile(key, [&] {
+                return this->compileDriver(name, driver, key, std::vector(dependencies));
+            });
+
+            // Don't trust the hash alone, compile the driver again if the cached one doesn't actually match
+            if (compiledDriver->code != driver.code || compiledDriver->config != driver.config || compiledDriver->dependencies != dependencies)
+                compiledDriver = this->compileDriver(name, driver, key, std::move(dependencies));
 
-            // Mark the dependency as compiled
-            this->m_compiledDrivers.insert(dependency);
+            instantiation = std::move(compiledDriver);
         }
 
-        auto newNodes = this->compileCode(driver.code, driver.config);
-        std::move(newNodes.begin(), newNodes.end(), std::back_inserter(nodes));
+        // Mark the driver as processed
+        this->m_processedDrivers.emplace(name, instantiation);
+        this->m_driversInProgress.erase(name);
 
-        return nodes;
+        // Entries of the specs file that resolve to the same instantiation only generate its code once
+        if (this->m_resultInstantiations.insert(instantiation).second)
+            result.push_back(instantiation);
+
+        return instantiation;
     }
 
-    auto Compiler::processSpecsFile(const compiler::specs::SpecsFile &specsFile) -> std::vector<std::unique_ptr<ast::Node>> {
-        // Clear what drivers have been compiled already
-        this->m_compiledDrivers.clear();
+    auto Compiler::processSpecsFile(const compiler::specs::SpecsFile &specsFile) -> std::vector<DriverCache::Entry> {
+        // Clear what drivers have been processed already, memoized instantiations are kept
+        this->m_processedDrivers.clear();
+        this->m_resultInstantiations.clear();
+        this->m_driversInProgress.clear();
 
         // Process all drivers mentioned in the specs file
-        std::vector<std::unique_ptr<ast::Node>> nodes;
+        std::vector<DriverCache::Entry> result;
         for (const auto &[name, driver] : specsFile.drivers()) {
-            if (this->m_compiledDrivers.contains(name)) {
-                continue;
-            }
+            // Drivers are appended to the result after all of their dependencies
+            processDriver(name, driver, result);
+        }
 
-            auto newNodes = processDriver(driver);
+        return result;
+    }
+
+    auto Compiler::streamDriver(const std::string &name, const compiler::specs::Driver &driver, ast::Visitor &visitor, StreamingState &state) -> DriverCache::Entry {
+        auto &drivers = this->m_specsFile.drivers();
 
-            // Insert new nodes into result
-            std::move(newNodes.begin(), newNodes.end(), std::back_inserter(nodes));
+        // Drivers are kept alive for as long as any of their dependents still has to be compiled
+        if (auto it = state.alive.find(name); it != state.alive.end())
+            return it->second;
+
+        if (!this->m_driversInProgress.insert(name).second)
+            throw std::runtime_error(fmt::format("Circular dependency on driver \"{}\"", name));
+
+        // Recursively compile and emit all dependencies of the current driver
+        std::vector<DriverCache::Entry> dependencies;
+        for (auto &dependency : driver.dependencies) {
+
+            // Make sure the dependency exists
+            if (!drivers.contains(dependency))
+                throw std::runtime_error(fmt::format("Dependency \"{}\" does not exist", dependency));
+
+            dependencies.push_back(streamDriver(dependency, drivers.at(dependency), visitor, state));
+        }
+
+        auto key = DriverCache::makeKey(driver.code, driver.config, dependencies);
+        auto compiledDriver = this->compileDriver(name, driver, std::move(key), std::move(dependencies));
+
+        // Generate code for the driver right away, its AST doesn't have to be kept around for later
+        for (auto &node : compiledDriver->nodes) {
+            hlp::ScopedPhase phase("codegen", name);
+
+            node->accept(visitor);
         }
 
-        return nodes;
+        state.emitted.insert(name);
+        this->m_driversInProgress.erase(name);
+
+        // Release dependencies that no other driver needs anymore. Inherited drivers share parts of their AST with
+        // them, the compiled driver itself still holds on to them until it's released as well
+        for (auto &dependency : driver.dependencies) {
+            if (--state.remainingDependents[dependency] == 0)
+                state.alive.erase(dependency);
+        }
+
+        if (state.remainingDependents[name] > 0)
+            state.alive.emplace(name, compiledDriver);
+
+        return compiledDriver;
+    }
+
+    auto Compiler::compileStreaming(ast::Visitor &visitor) -> void {
+        this->m_processedDrivers.clear();
+        this->m_driversInProgress.clear();
+
+        StreamingState state;
+        for (const auto &[name, driver] : this->m_specsFile.drivers()) {
+            for (const auto &dependency : driver.dependencies)
+                state.remainingDependents[dependency] += 1;
+        }
+
+        // Same order as compile(), every driver is emitted after all of its dependencies
+        for (const auto &[name, driver] : this->m_specsFile.drivers()) {
+            if (!state.emitted.contains(name))
+                streamDriver(name, driver, visitor, state);
+        }
     }
 
-}
\ No newline at end of file
+}
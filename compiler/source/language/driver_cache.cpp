@@ -0,0 +1,79 @@
+#include <compiler/language/driver_cache.hpp>
+
+#include <fmt/format.h>
+
+namespace compiler::language {
+
+    auto DriverCache::makeKey(std::string_view code, const std::map<std::string, std::string> &config, const std::vector<Entry> &dependencies) -> std::string {
+        // Lengths are included everywhere so different inputs can never produce the same key by concatenation
+        auto key = fmt::format("{:016X}:{}", std::hash<std::string_view>{}(code), code.size());
+
+        for (const auto &[name, value] : config)
+            key += fmt::format("|{}:{}={}:{}", name.size(), name, value.size(), value);
+
+        // Only hash the keys of dependencies, otherwise key sizes would grow with the length of the dependency chain
+        for (const auto &dependency : dependencies)
+            key += fmt::format("|[{:016X}]", std::hash<std::string>{}(dependency->key));
+
+        return key;
+    }
+
+    auto DriverCache::hashConfig(const std::map<std::string, std::string> &config) -> u64 {
+        // FNV-1a over the length prefixed keys and values. The map is sorted so the order placeholders were declared in doesn't matter
+        u64 hash = 0xCBF29CE484222325;
+        auto feed = [&hash](std::string_view data) {
+            for (char c : fmt::format("{}:", data.size()))
+                hash = (hash ^ u8(c)) * 0x100000001B3;
+            for (char c : data)
+                hash = (hash ^ u8(c)) * 0x100000001B3;
+        };
+
+        for (const auto &[name, value] : config) {
+            feed(name);
+            feed(value);
+        }
+
+        return hash;
+    }
+
+    auto DriverCache::getOrCompile(const std::string &key, const std::function<Entry()> &compile) -> Entry {
+        std::promise<Entry> promise;
+        {
+            std::unique_lock lock(this->m_mutex);
+
+            if (auto it = this->m_entries.find(key); it != this->m_entries.end()) {
+                this->m_hits += 1;
+
+                auto future = it->second;
+                lock.unlock();
+
+                return future.get();
+            }
+
+            this->m_misses += 1;
+            this->m_entries.emplace(key, promise.get_future().share());
+        }
+
+        try {
+            auto entry = compile();
+            promise.set_value(entry);
+
+            return entry;
+        } catch (...) {
+            // Everyone waiting for this driver gets the same error
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+    }
+
+    auto DriverCache::hits() const -> size_t {
+        std::scoped_lock lock(this->m_mutex);
+        return this->m_hits;
+    }
+
+    auto DriverCache::misses() const -> size_t {
+        std::scoped_lock lock(this->m_mutex);
+        return this->m_misses;
+    }
+
+}
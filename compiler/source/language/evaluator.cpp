@@ -0,0 +1,421 @@
+#include <compiler/language/evaluator.hpp>
+
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <limits>
+
+namespace compiler::language::evaluator {
+
+    using Operation = ast::NodeExpression::Operation;
+
+    namespace {
+
+        // Generated tables and folds are evaluated step by step, this keeps a typo in a table size from hanging the compiler
+        constexpr u64 MaxSteps = 16 * 1024 * 1024;
+
+        auto isFloat(const ast::ConstantValue &value) -> bool {
+            return std::holds_alternative<f64>(value);
+        }
+
+        auto toFloat(const ast::ConstantValue &value) -> f64 {
+            return std::visit([](auto value) { return f64(value); }, value);
+        }
+
+        auto isTrue(const ast::ConstantValue &value) -> bool {
+            return std::visit([](auto value) { return value != 0; }, value);
+        }
+
+        // Wrapping integer arithmetic, signed overflow would be undefined behaviour otherwise
+        auto wrap(u128 value) -> ast::ConstantValue {
+            return i128(value);
+        }
+
+        auto evaluateIntegerOperator(std::string_view op, i128 left, i128 right) -> EvaluationResult {
+            auto uleft = u128(left), uright = u128(right);
+
+            if (op == "+")  return wrap(uleft + uright);
+            if (op == "-")  return wrap(uleft - uright);
+            if (op == "*")  return wrap(uleft * uright);
+            if (op == "&")  return wrap(uleft & uright);
+            if (op == "|")  return wrap(uleft | uright);
+            if (op == "^")  return wrap(uleft ^ uright);
+
+            if (op == "/" || op == "%") {
+                if (right == 0)
+                    return std::unexpected(EvaluationError::DivisionByZero);
+
+                // The only division that overflows, it wraps around just like the other operators
+                if (left == std::numeric_limits<i128>::min() && right == -1)
+                    return op == "/" ? ast::ConstantValue(left) : ast::ConstantValue(i128(0));
+
+                return op == "/" ? left / right : left % right;
+            }
+
+            if (op == "<<" || op == ">>") {
+                if (right < 0 || right >= 128)
+                    return std::unexpected(EvaluationError::InvalidOperation);
+
+                return op == "<<" ? wrap(uleft << int(right)) : ast::ConstantValue(left >> int(right));
+            }
+
+            if (op == "==") return i128(left == right);
+            if (op == "!=") return i128(left != right);
+            if (op == "<")  return i128(left < right);
+            if (op == ">")  return i128(left > right);
+            if (op == "<=") return i128(left <= right);
+            if (op == ">=") return i128(left >= right);
+
+            return std::unexpected(EvaluationError::InvalidOperation);
+        }
+
+        auto evaluateFloatOperator(std::string_view op, f64 left, f64 right) -> EvaluationResult {
+            if (op == "+")  return left + right;
+            if (op == "-")  return left - right;
+            if (op == "*")  return left * right;
+            if (op == "/") {
+                if (right == 0)
+                    return std::unexpected(EvaluationError::DivisionByZero);
+
+                return left / right;
+            }
+
+            if (op == "==") return i128(left == right);
+            if (op == "!=") return i128(left != right);
+            if (op == "<")  return i128(left < right);
+            if (op == ">")  return i128(left > right);
+            if (op == "<=") return i128(left <= right);
+            if (op == ">=") return i128(left >= right);
+
+            // Modulo, bitwise operators and shifts don't exist for floats
+            return std::unexpected(EvaluationError::InvalidOperation);
+        }
+
+    }
+
+    auto Evaluator::evaluate(const ast::NodeExpression &expression) -> EvaluationResult {
+        if (++this->m_steps > MaxSteps)
+            return std::unexpected(EvaluationError::LimitExceeded);
+
+        switch (expression.operation()) {
+            case Operation::NumericLiteral:
+                return parseNumericLiteral(expression.value());
+            case Operation::CharacterLiteral:
+                if (expression.value().size() != 1)
+                    return std::unexpected(EvaluationError::InvalidOperation);
+
+                return i128(u8(expression.value().front()));
+            case Operation::Identifier:
+                return this->evaluateIdentifier(expression);
+            case Operation::UnaryOperator:
+                return this->evaluateUnary(expression);
+            case Operation::BinaryOperator:
+                return this->evaluateBinary(expression);
+            case Operation::TernaryOperator: {
+                auto condition = this->evaluate(*expression.operands()[0]);
+                if (!condition.has_value())
+                    return condition;
+
+                return this->evaluate(*expression.operands()[isTrue(*condition) ? 1 : 2]);
+            }
+            case Operation::Call:
+                return this->evaluateCall(expression);
+            case Operation::Index:
+                return this->evaluateIndex(expression);
+            case Operation::StringLiteral:
+            case Operation::Lambda:
+            case Operation::Array:
+                // Only valid in specific places, never as a value on their own
+                return std::unexpected(EvaluationError::InvalidOperation);
+            case Operation::Field:
+            case Operation::Assignment:
+            case Operation::Sequence:
+                // Registers are only known at run time
+                return std::unexpected(EvaluationError::InvalidOperation);
+        }
+
+        return std::unexpected(EvaluationError::InvalidOperation);
+    }
+
+    auto Evaluator::evaluateLambda(const ast::NodeExpression &lambda, ast::ConstantValue argument) -> EvaluationResult {
+        if (lambda.operation() != Operation::Lambda)
+            return std::unexpected(EvaluationError::InvalidOperation);
+
+        this->m_bindings.emplace_back(lambda.value(), argument);
+        auto result = this->evaluate(*lambda.operands()[0]);
+        this->m_bindings.pop_back();
+
+        return result;
+    }
+
+    auto Evaluator::evaluateIdentifier(const ast::NodeExpression &expression) -> EvaluationResult {
+        // Lambda parameters shadow constants, inner ones shadow outer ones
+        for (auto it = this->m_bindings.rbegin(); it != this->m_bindings.rend(); ++it) {
+            if (it->first == expression.value())
+                return it->second;
+        }
+
+        if (expression.value() == "true")  return i128(1);
+        if (expression.value() == "false") return i128(0);
+
+        auto constant = this->m_lookup ? this->m_lookup(expression.value()) : nullptr;
+        if (constant == nullptr)
+            return std::unexpected(EvaluationError::UnknownIdentifier);
+
+        // Tables can only be indexed
+        if (constant->isTable())
+            return std::unexpected(EvaluationError::InvalidOperation);
+
+        return constant->values().front();
+    }
+
+    auto Evaluator::evaluateUnary(const ast::NodeExpression &expression) -> EvaluationResult {
+        auto operand = this->evaluate(*expression.operands()[0]);
+        if (!operand.has_value())
+            return operand;
+
+        return applyUnaryOperator(expression.value(), *operand);
+    }
+
+    auto Evaluator::evaluateBinary(const ast::NodeExpression &expression) -> EvaluationResult {
+        auto op = expression.value();
+
+        auto left = this->evaluate(*expression.operands()[0]);
+        if (!left.has_value())
+            return left;
+
+        // Logical operators short circuit so the right hand side may be invalid if it isn't needed
+        if (op == "&&" || op == "||") {
+            if (isTrue(*left) == (op == "||"))
+                return i128(op == "||");
+
+            auto right = this->evaluate(*expression.operands()[1]);
+            if (!right.has_value())
+                return right;
+
+            return i128(isTrue(*right));
+        }
+
+        auto right = this->evaluate(*expression.operands()[1]);
+        if (!right.has_value())
+            return right;
+
+        return applyBinaryOperator(op, *left, *right);
+    }
+
+    auto Evaluator::evaluateCall(const ast::NodeExpression &expression) -> EvaluationResult {
+        auto name = expression.value();
+        const auto &arguments = expression.operands();
+
+        // fold(count, initial, accumulator => next) applies the lambda count times, starting with the initial value
+        if (name == "fold") {
+            if (arguments.size() != 3 || arguments[2]->operation() != Operation::Lambda)
+                return std::unexpected(EvaluationError::InvalidOperation);
+
+            auto count = this->evaluate(*arguments[0]);
+            if (!count.has_value())
+                return count;
+            if (isFloat(*count) || std::get<i128>(*count) < 0)
+                return std::unexpected(EvaluationError::InvalidOperation);
+            if (std::get<i128>(*count) > i128(MaxSteps))
+                return std::unexpected(EvaluationError::LimitExceeded);
+
+            auto accumulator = this->evaluate(*arguments[1]);
+            for (i128 i = 0; i < std::get<i128>(*count) && accumulator.has_value(); i++)
+                accumulator = this->evaluateLambda(*arguments[2], *accumulator);
+
+            return accumulator;
+        }
+
+        std::vector<ast::ConstantValue> values;
+        for (const auto &argument : arguments) {
+            auto value = this->evaluate(*argument);
+            if (!value.has_value())
+                return value;
+
+            values.push_back(*value);
+        }
+
+        if ((name == "min" || name == "max") && values.size() == 2) {
+            bool less = isFloat(values[0]) || isFloat(values[1])
+                      ? toFloat(values[0]) < toFloat(values[1])
+                      : std::get<i128>(values[0]) < std::get<i128>(values[1]);
+
+            return (name == "min") == less ? values[0] : values[1];
+        }
+
+        if (name == "abs" && values.size() == 1) {
+            if (isFloat(values[0]))
+                return std::abs(std::get<f64>(values[0]));
+
+            auto value = std::get<i128>(values[0]);
+            return value < 0 ? wrap(-u128(value)) : ast::ConstantValue(value);
+        }
+
+        // round, floor and ceil turn floats into integers, mainly for scaled conversion curves
+        if ((name == "round" || name == "floor" || name == "ceil") && values.size() == 1) {
+            auto value = toFloat(values[0]);
+            value = name == "round" ? std::round(value) : name == "floor" ? std::floor(value) : std::ceil(value);
+
+            if (!std::isfinite(value) || std::abs(value) >= 0x1p126)
+                return std::unexpected(EvaluationError::InvalidOperation);
+
+            return i128(value);
+        }
+
+        return std::unexpected(EvaluationError::UnknownIdentifier);
+    }
+
+    auto Evaluator::evaluateIndex(const ast::NodeExpression &expression) -> EvaluationResult {
+        const auto &table = *expression.operands()[0];
+        if (table.operation() != Operation::Identifier)
+            return std::unexpected(EvaluationError::InvalidOperation);
+
+        auto constant = this->m_lookup ? this->m_lookup(table.value()) : nullptr;
+        if (constant == nullptr)
+            return std::unexpected(EvaluationError::UnknownIdentifier);
+        if (!constant->isTable())
+            return std::unexpected(EvaluationError::InvalidOperation);
+
+        auto index = this->evaluate(*expression.operands()[1]);
+        if (!index.has_value())
+            return index;
+        if (isFloat(*index))
+            return std::unexpected(EvaluationError::InvalidOperation);
+
+        auto position = std::get<i128>(*index);
+        if (position < 0 || position >= i128(constant->values().size()))
+            return std::unexpected(EvaluationError::IndexOutOfRange);
+
+        return constant->values()[size_t(position)];
+    }
+
+    auto applyUnaryOperator(std::string_view op, const ast::ConstantValue &operand) -> EvaluationResult {
+        if (op == "!")
+            return i128(!isTrue(operand));
+
+        if (isFloat(operand)) {
+            if (op == "-")
+                return -std::get<f64>(operand);
+
+            return std::unexpected(EvaluationError::InvalidOperation);
+        }
+
+        auto value = u128(std::get<i128>(operand));
+        if (op == "-") return wrap(-value);
+        if (op == "~") return wrap(~value);
+
+        return std::unexpected(EvaluationError::InvalidOperation);
+    }
+
+    auto applyBinaryOperator(std::string_view op, const ast::ConstantValue &left, const ast::ConstantValue &right) -> EvaluationResult {
+        // Both sides are known here already, there's nothing left to short circuit
+        if (op == "&&") return i128(isTrue(left) && isTrue(right));
+        if (op == "||") return i128(isTrue(left) || isTrue(right));
+
+        if (isFloat(left) || isFloat(right))
+            return evaluateFloatOperator(op, toFloat(left), toFloat(right));
+        else
+            return evaluateIntegerOperator(op, std::get<i128>(left), std::get<i128>(right));
+    }
+
+    auto parseNumericLiteral(std::string_view literal) -> EvaluationResult {
+        if (literal.contains('.')) {
+            f64 value = 0;
+            auto [end, error] = std::from_chars(literal.data(), literal.data() + literal.size(), value);
+            if (error != std::errc() || end != literal.data() + literal.size())
+                return std::unexpected(EvaluationError::InvalidNumericLiteral);
+
+            return value;
+        }
+
+        int base = 10;
+        if (literal.starts_with("0x"))      base = 16;
+        else if (literal.starts_with("0b")) base = 2;
+        else if (literal.starts_with("0o")) base = 8;
+
+        if (base != 10)
+            literal.remove_prefix(2);
+
+        // Literals are limited to 64 bits like in C
+        u64 value = 0;
+        auto [end, error] = std::from_chars(literal.data(), literal.data() + literal.size(), value, base);
+        if (literal.empty() || error != std::errc() || end != literal.data() + literal.size())
+            return std::unexpected(EvaluationError::InvalidNumericLiteral);
+
+        return i128(value);
+    }
+
+    auto convert(const ast::ConstantValue &value, const ast::NodeBuiltinType &type) -> ast::ConstantValue {
+        using enum ast::NodeBuiltinType::Type;
+
+        switch (type.type()) {
+            case FloatingPoint:
+                return type.size() == 4 ? f64(f32(toFloat(value))) : toFloat(value);
+            case Boolean:
+                return i128(isTrue(value));
+            case Unsigned:
+            case Signed: {
+                // Floats are truncated towards zero first. Values that don't fit are undefined in C, they become 0 here
+                i128 integer = 0;
+                if (!isFloat(value))
+                    integer = std::get<i128>(value);
+                else if (auto number = std::trunc(std::get<f64>(value)); std::isfinite(number) && std::abs(number) < 0x1p126)
+                    integer = i128(number);
+
+                auto bits = type.size() * 8;
+                auto mask = (u128(1) << bits) - 1;
+                auto truncated = u128(integer) & mask;
+
+                // Sign extend negative values of signed types
+                if (type.type() == Signed && (truncated >> (bits - 1)) & 1)
+                    truncated |= ~mask;
+
+                return i128(truncated);
+            }
+            case Bytes:
+            case String:
+                // Rejected by the parser, there are no constants of them
+                break;
+        }
+
+        return value;
+    }
+
+    auto formatValue(const ast::ConstantValue &value, const ast::NodeBuiltinType &type) -> std::string {
+        using enum ast::NodeBuiltinType::Type;
+
+        switch (type.type()) {
+            case FloatingPoint: {
+                auto result = type.size() == 4 ? fmt::format("{}", f32(toFloat(value))) : fmt::format("{}", toFloat(value));
+
+                // Make sure the literal is a floating point literal
+                if (result.find_first_of(".e") == std::string::npos)
+                    result += ".0";
+                if (type.size() == 4)
+                    result += 'f';
+
+                return result;
+            }
+            case Boolean:
+                return isTrue(value) ? "true" : "false";
+            case Unsigned:
+                return fmt::format("0x{:0{}X}", u64(std::get<i128>(value)), type.size() * 2);
+            case Signed: {
+                auto integer = i64(std::get<i128>(value));
+
+                // The smallest value can't be written as a negated literal
+                if (integer == std::numeric_limits<i64>::min())
+                    return "(-9223372036854775807 - 1)";
+
+                return fmt::format("{}", integer);
+            }
+            case Bytes:
+            case String:
+                break;
+        }
+
+        return { };
+    }
+
+}
@@ -0,0 +1,412 @@
+#include <compiler/language/incremental.hpp>
+
+#include <compiler/language/parser.hpp>
+#include <compiler/helpers/profiler.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+namespace compiler::language {
+    using namespace lexer;
+
+    struct IncrementalDocument::Declaration {
+        // Text of the declaration, wrapped in the namespaces it was declared in
+        std::string source;
+        size_t prefixLength = 0;
+
+        std::vector<std::unique_ptr<ast::Node>> nodes;
+        std::optional<Diagnostic> error;
+
+        struct Driver {
+            std::string name;
+            ast::NodeDriver *driver;
+            size_t offset, length;
+        };
+        std::vector<Driver> drivers;
+
+        // Every type name the declaration could have referred to and the driver it resolved to when it was parsed
+        std::map<std::string, const ast::NodeDriver*> references;
+
+        // Instantiated drivers share their AST with the declarations they were instantiated from
+        std::vector<std::shared_ptr<const void>> dependencies;
+    };
+
+    auto IncrementalDocument::getFullName(const std::vector<std::string> &namespaces, std::string_view name) -> std::string {
+        if (!namespaces.empty()) {
+            return fmt::format("{}::{}", fmt::join(namespaces, "::"), name);
+        } else {
+            return std::string(name);
+        }
+    }
+
+    auto IncrementalDocument::findSymbol(const SymbolTable &declared, const SymbolTable &external, const std::string &name) -> const Symbol * {
+        // Drivers declared in the document itself hide the ones from dependencies
+        if (auto it = declared.find(name); it != declared.end())
+            return &it->second;
+        if (auto it = external.find(name); it != external.end())
+            return &it->second;
+
+        return nullptr;
+    }
+
+    auto IncrementalDocument::toDocumentOffset(const Entry &entry, size_t offset) const -> size_t {
+        // Locations inside of the namespace wrapper are moved to the start of the declaration
+        auto prefixLength = entry.declaration->prefixLength;
+        if (offset < prefixLength)
+            return entry.begin;
+
+        return std::min(entry.begin + (offset - prefixLength), entry.end);
+    }
+
+    auto IncrementalDocument::relex(std::string_view previousText, std::vector<Diagnostic> &diagnostics) -> void {
+        hlp::ScopedPhase phase("lex", this->m_name);
+
+        const std::string_view text = this->m_text;
+
+        // Find the range of the text that changed. Tokens outside of it are kept, only the changed part is lexed again
+        const auto maxCommon = std::min(text.size(), previousText.size());
+
+        size_t prefix = 0;
+        while (prefix < maxCommon && text[prefix] == previousText[prefix])
+            prefix += 1;
+
+        size_t suffix = 0;
+        while (suffix < maxCommon - prefix && text[text.size() - suffix - 1] == previousText[previousText.size() - suffix - 1])
+            suffix += 1;
+
+        const auto delta = i64(text.size()) - i64(previousText.size());
+
+        // Token values that point into the previous text have to point into the new text instead. They're rebuilt from the token's location,
+        // short texts are stored inside of m_text itself so the previous one's characters have been overwritten by the new text already.
+        // Values of string like tokens are the part between their delimiters, tokens expanded from a placeholder point into the configuration
+        auto rebase = [&](Token &token) {
+            auto location = text.substr(token.offset(), token.length());
+            if (location.starts_with("{%"))
+                return;
+
+            auto &value = token.value();
+            value = location.substr((location.size() - value.size()) / 2, value.size());
+        };
+
+        // Tokens touching the changed range could lex differently, for example an identifier that got longer
+        auto previousTokens = std::move(this->m_tokens);
+        this->m_tokens.clear();
+
+        size_t kept = 0;
+        while (kept < previousTokens.size() && previousTokens[kept].offset() + previousTokens[kept].length() < prefix)
+            kept += 1;
+
+        // Tokens expanded from a placeholder all share its location, never keep only some of them
+        while (kept > 0 && kept < previousTokens.size() && previousTokens[kept].offset() == previousTokens[kept - 1].offset())
+            kept -= 1;
+
+        for (size_t i = 0; i < kept; i++) {
+            rebase(previousTokens[i]);
+            this->m_tokens.push_back(previousTokens[i]);
+        }
+
+        const size_t restart = kept > 0 ? previousTokens[kept - 1].offset() + previousTokens[kept - 1].length() : 0;
+
+        std::string_view source = text.substr(restart);
+        for (auto lexer = lexer::lex(source, this->m_config); lexer;) {
+            auto result = lexer();
+
+            if (!result.has_value()) {
+                diagnostics.push_back({ size_t(source.data() - text.data()), 1, fmt::format("Lexer Error: {}", result.error()) });
+                this->m_lexError = true;
+                return;
+            }
+
+            auto token = result.value();
+            token.setLocation(token.offset() + restart, token.length());
+
+            // Once a token starts in the unchanged suffix where a token started before, all following tokens are the same as before.
+            // The lexer only ever looks ahead of a token so this holds, unless lexing stopped at an error last time
+            if (!this->m_lexError && token.offset() >= text.size() - suffix) {
+                auto previousOffset = size_t(i64(token.offset()) - delta);
+                auto it = std::ranges::lower_bound(previousTokens, previousOffset, {}, &Token::offset);
+
+                if (it != previousTokens.end() && it->offset() == previousOffset) {
+                    for (; it != previousTokens.end(); ++it) {
+                        it->setLocation(it->offset() + delta, it->length());
+                        rebase(*it);
+                        this->m_tokens.push_back(*it);
+                    }
+
+                    return;
+                }
+            }
+
+            this->m_tokens.push_back(token);
+        }
+
+        this->m_lexError = false;
+    }
+
+    auto IncrementalDocument::split() -> std::vector<Entry> {
+        // Split the tokens into top level declarations. Namespaces aren't declarations themselves,
+        // their content is split up as well and each declaration remembers the namespaces it's in
+        const auto &tokens = this->m_tokens;
+
+        std::vector<Entry> entries;
+        std::vector<std::string> namespaces;
+        bool complete = true;
+
+        size_t index = 0;
+        while (index < tokens.size()) {
+            if (tokens[index] == KeywordNamespace && index + 2 < tokens.size() && tokens[index + 1].type() == Token::Type::Identifier && tokens[index + 2] == SeparatorOpenBrace) {
+                namespaces.emplace_back(tokens[index + 1].value());
+                index += 3;
+                continue;
+            }
+
+            if (tokens[index] == SeparatorCloseBrace && !namespaces.empty()) {
+                namespaces.pop_back();
+                index += 1;
+                continue;
+            }
+
+            // Everything up to the matching closing brace belongs to the declaration.
+            // Declarations with a syntax error end at the next keyword that starts a new one so the following declarations still parse
+            const auto first = index;
+            i32 depth = 0;
+            complete = false;
+            while (index < tokens.size()) {
+                const auto &token = tokens[index];
+
+                if (index != first && depth == 0 && (token == KeywordDriver || token == KeywordNamespace || (token == SeparatorCloseBrace && !namespaces.empty()))) {
+                    complete = true;
+                    break;
+                }
+
+                index += 1;
+
+                if (token == SeparatorOpenBrace) {
+                    depth += 1;
+                } else if (token == SeparatorCloseBrace) {
+                    depth -= 1;
+
+                    if (depth <= 0) {
+                        complete = true;
+                        break;
+                    }
+                }
+            }
+
+            const auto &last = tokens[index - 1];
+            entries.push_back({ nullptr, namespaces, tokens[first].offset(), last.offset() + last.length() });
+        }
+
+        // The declaration the lexer stopped in would only report a misleading parser error
+        if (this->m_lexError && !complete && !entries.empty())
+            entries.pop_back();
+
+        return entries;
+    }
+
+    auto IncrementalDocument::parse(const Entry &entry, std::string source, size_t prefixLength, const SymbolTable &declared) const -> std::shared_ptr<const Declaration> {
+        hlp::ScopedPhase phase("parse", this->m_name);
+
+        auto declaration = std::make_shared<Declaration>();
+        declaration->source       = std::move(source);
+        declaration->prefixLength = prefixLength;
+
+        try {
+            // Lex the declaration on its own, the AST will point into the declaration's source
+            std::vector<Token> tokens;
+            {
+                std::string_view code = declaration->source;
+                for (auto lexer = lexer::lex(code, this->m_config); lexer;) {
+                    auto result = lexer();
+
+                    if (!result.has_value()) {
+                        declaration->error = Diagnostic { size_t(code.data() - declaration->source.data()), 1, fmt::format("Lexer Error: {}", result.error()) };
+                        return declaration;
+                    }
+
+                    tokens.emplace_back(result.value());
+                }
+            }
+
+            // Only hand the parser the drivers this declaration can possibly refer to.
+            // The parser looks up type names as written first and then relative to the current namespace
+            std::map<std::string, ast::NodeDriver*> drivers;
+            for (size_t i = 0; i < tokens.size(); i++) {
+                if (tokens[i].type() != Token::Type::Identifier)
+                    continue;
+                if (i >= 2 && tokens[i - 1] == OperatorColon && tokens[i - 2] == OperatorColon)
+                    continue;
+
+                auto typeName = std::string(tokens[i].value());
+                for (size_t j = i + 3; j < tokens.size() && tokens[j - 2] == OperatorColon && tokens[j - 1] == OperatorColon && tokens[j].type() == Token::Type::Identifier; j += 3) {
+                    typeName += fmt::format("::{}", tokens[j].value());
+                }
+
+                for (const auto &name : { typeName, getFullName(entry.namespaces, typeName) }) {
+                    if (declaration->references.contains(name))
+                        continue;
+
+                    if (auto symbol = findSymbol(declared, this->m_external, name); symbol != nullptr) {
+                        declaration->references.emplace(name, symbol->driver);
+                        declaration->dependencies.push_back(symbol->owner);
+                        drivers.emplace(name, symbol->driver);
+                    } else {
+                        declaration->references.emplace(name, nullptr);
+                    }
+                }
+            }
+
+            auto parser = parser::Parser();
+            parser.setDrivers(std::map(drivers));
+
+            for (auto parse = parser.parse(tokens); parse;) {
+                auto result = parse();
+
+                if (!result.has_value()) {
+                    auto [offset, length] = parser.location();
+                    declaration->error = Diagnostic { offset, std::max<size_t>(length, 1), fmt::format("Parser Error: {}", result.error()) };
+                    break;
+                }
+
+                declaration->nodes.emplace_back(std::move(result.value()));
+            }
+
+            // Remember where the drivers declared here are named
+            auto declared = parser.takeDrivers();
+            for (size_t i = 0; i + 1 < tokens.size(); i++) {
+                if (tokens[i] != KeywordDriver || tokens[i + 1].type() != Token::Type::Identifier)
+                    continue;
+
+                auto name = getFullName(entry.namespaces, tokens[i + 1].value());
+                auto given = drivers.find(name);
+                if (auto it = declared.find(name); it != declared.end() && (given == drivers.end() || given->second != it->second)) {
+                    declaration->drivers.push_back({ std::move(name), it->second, tokens[i + 1].offset(), tokens[i + 1].length() });
+                }
+            }
+        } catch (const std::exception &e) {
+            declaration->nodes.clear();
+            declaration->drivers.clear();
+            declaration->error = Diagnostic { prefixLength, 1, e.what() };
+        }
+
+        return declaration;
+    }
+
+    auto IncrementalDocument::isReusable(const Declaration &declaration, const SymbolTable &declared) const -> bool {
+        // A declaration with unchanged text parses the same way again as long as all names it could have referred to still resolve to the same drivers
+        return std::ranges::all_of(declaration.references, [&](const auto &reference) {
+            auto &[name, driver] = reference;
+
+            auto symbol = findSymbol(declared, this->m_external, name);
+            return (symbol == nullptr ? nullptr : symbol->driver) == driver;
+        });
+    }
+
+    auto IncrementalDocument::update(std::string text, const SymbolTable &external) -> void {
+        const auto previousText = std::exchange(this->m_text, std::move(text));
+        this->m_external = external;
+
+        std::vector<Diagnostic> diagnostics;
+        this->relex(previousText, diagnostics);
+        auto entries = this->split();
+
+        // Declarations of the previous version of the document by their source
+        std::multimap<std::string_view, std::shared_ptr<const Declaration>> previous;
+        for (const auto &entry : this->m_entries) {
+            previous.emplace(entry.declaration->source, entry.declaration);
+        }
+
+        // Declarations can refer to the drivers of dependencies and to the ones declared above them
+        SymbolTable exports;
+
+        this->m_reused   = 0;
+        this->m_reparsed = 0;
+
+        for (auto &entry : entries) {
+            std::string source;
+            for (const auto &name : entry.namespaces)
+                source += fmt::format("namespace {} {{ ", name);
+
+            const auto prefixLength = source.size();
+            source += std::string_view(this->m_text).substr(entry.begin, entry.end - entry.begin);
+
+            for (size_t i = 0; i < entry.namespaces.size(); i++)
+                source += " }";
+
+            if (auto it = previous.find(source); it != previous.end() && this->isReusable(*it->second, exports)) {
+                entry.declaration = it->second;
+                previous.erase(it);
+
+                this->m_reused += 1;
+            } else {
+                entry.declaration = this->parse(entry, std::move(source), prefixLength, exports);
+
+                this->m_reparsed += 1;
+            }
+
+            const auto &declaration = *entry.declaration;
+            if (declaration.error.has_value()) {
+                const auto &error = *declaration.error;
+                auto offset = this->toDocumentOffset(entry, error.offset);
+                diagnostics.push_back({ offset, std::min(error.length, entry.end - offset), error.message });
+            }
+
+            for (const auto &driver : declaration.drivers) {
+                exports.insert_or_assign(driver.name, Symbol { driver.driver, entry.declaration, this->m_name, this->toDocumentOffset(entry, driver.offset), driver.length });
+            }
+        }
+
+        std::ranges::stable_sort(diagnostics, {}, &Diagnostic::offset);
+
+        this->m_entries     = std::move(entries);
+        this->m_diagnostics = std::move(diagnostics);
+        this->m_exports     = std::move(exports);
+    }
+
+    auto IncrementalDocument::findDefinition(size_t offset) const -> std::optional<Symbol> {
+        const auto &tokens = this->m_tokens;
+
+        // Find the identifier under the cursor. A cursor right behind an identifier still counts as being on it
+        auto it = std::ranges::upper_bound(tokens, offset, {}, &Token::offset);
+        if (it == tokens.begin())
+            return std::nullopt;
+
+        auto index = size_t(std::distance(tokens.begin(), it) - 1);
+        if (tokens[index].type() != Token::Type::Identifier || offset > tokens[index].offset() + tokens[index].length())
+            return std::nullopt;
+
+        // Extend the identifier to the entire qualified type name it's part of
+        auto isQualified = [&](size_t i) {
+            return tokens[i] == OperatorColon && tokens[i + 1] == OperatorColon && tokens[i + 2].type() == Token::Type::Identifier;
+        };
+
+        auto first = index, last = index;
+        while (first >= 3 && tokens[first - 3].type() == Token::Type::Identifier && isQualified(first - 2))
+            first -= 3;
+        while (last + 3 < tokens.size() && isQualified(last + 1))
+            last += 3;
+
+        std::string typeName;
+        for (auto i = first; i <= last; i += 3) {
+            if (!typeName.empty())
+                typeName += "::";
+            typeName += tokens[i].value();
+        }
+
+        // Resolve the name the same way the parser does
+        if (auto symbol = findSymbol(this->m_exports, this->m_external, typeName); symbol != nullptr)
+            return *symbol;
+
+        auto entry = std::ranges::upper_bound(this->m_entries, offset, {}, &Entry::begin);
+        if (entry != this->m_entries.begin() && offset <= std::prev(entry)->end) {
+            if (auto symbol = findSymbol(this->m_exports, this->m_external, getFullName(std::prev(entry)->namespaces, typeName)); symbol != nullptr)
+                return *symbol;
+        }
+
+        return std::nullopt;
+    }
+
+}
@@ -4,6 +4,7 @@
 #include <optional>
 #include <stdexcept>
 
+#include <compiler/helpers/profiler.hpp>
 #include <compiler/helpers/static_string.hpp>
 #include <wolv/utils/string.hpp>
 
@@ -123,6 +124,14 @@ namespace compiler::language::lexer {
                     length++;
                 }
 
+                // Floating point literal, the fractional part is required so "1." isn't mistaken for one
+                if (length + 1 < source.size() && source[length] == '.' && std::isdigit(source[length + 1])) {
+                    length++;
+                    while (length < source.size() && std::isdigit(source[length])) {
+                        length++;
+                    }
+                }
+
                 return LexedData { Token(Token::Type::NumericLiteral, source.substr(0, length)), length };
             }
 
@@ -137,17 +146,14 @@ namespace compiler::language::lexer {
             if (source.starts_with(Begin)) {
                 // Get the length of the string literal.
                 // A string literal is a sequence of characters starting with the start sequence and ending with the end sequence
-                size_t length = 1;
-                while (length < source.size() && !source.substr(length).starts_with(End)) {
-                    length++;
-                }
+                auto end = source.find(End, Begin.size());
 
                 // Check if the string literal is terminated
-                if (length == source.size()) {
+                if (end == std::string_view::npos) {
                     return std::unexpected(LexError::UnterminatedStringLiteral);
                 }
 
-                return LexedData { Token(Type, source.substr(Begin.size(), length - End.size())), length + End.size() };
+                return LexedData { Token(Type, source.substr(Begin.size(), end - Begin.size())), end + End.size() };
             }
 
             return std::nullopt;
@@ -187,26 +193,20 @@ namespace compiler::language::lexer {
             if (source.starts_with("//")) {
                 // Get the length of the comment.
                 // A comment is a sequence of characters starting with the comment sequence and ending with a newline character
-                size_t length = 2;
-                while (length < source.size() && source[length] != '\n') {
-                    length++;
-                }
+                auto length = std::min(source.find('\n', 2), source.size());
 
                 return LexedData { Token(Token::Type::Comment, source.substr(0, length)), length };
             } else if (source.starts_with("/*")) {
                 // Get the length of the comment.
                 // A comment is a sequence of characters starting with the comment sequence and ending with a newline character
-                size_t length = 2;
-                while (length < source.size() && !source.substr(length).starts_with("*/")) {
-                    length++;
-                }
+                auto end = source.find("*/", 2);
 
                 // Check if the comment is terminated
-                if (length == source.size()) {
+                if (end == std::string_view::npos) {
                     return std::unexpected(LexError::UnterminatedComment);
                 }
 
-                return LexedData { Token(Token::Type::Comment, source.substr(0, length + 2)), length + 2 };
+                return LexedData { Token(Token::Type::Comment, source.substr(0, end + 2)), end + 2 };
             }
 
             return std::nullopt;
@@ -228,6 +228,11 @@ namespace compiler::language::lexer {
             LexKeyword<"fn">,
             LexKeyword<"namespace">,
             LexKeyword<"struct">,
+            LexKeyword<"const">,
+            LexKeyword<"register">,
+            LexKeyword<"burst">,
+            LexKeyword<"async">,
+            LexKeyword<"isr">,
 
             // Types
             LexBuiltinType<"u8">,
@@ -263,11 +268,34 @@ namespace compiler::language::lexer {
             LexSeparator<";">,
             LexSeparator<",">,
 
-            // Operators
+            // Operators, longer ones need to come first so they aren't split up into shorter ones
+            LexOperator<"<<">,
+            LexOperator<">>">,
+            LexOperator<"<=">,
+            LexOperator<">=">,
+            LexOperator<"==">,
+            LexOperator<"!=">,
+            LexOperator<"&&">,
+            LexOperator<"||">,
+            LexOperator<"->">,
+            LexOperator<"=>">,
             LexOperator<"<">,
             LexOperator<">">,
             LexOperator<":">,
-            LexOperator<"->">,
+            LexOperator<"=">,
+            LexOperator<"+">,
+            LexOperator<"-">,
+            LexOperator<"*">,
+            LexOperator<"/">,
+            LexOperator<"%">,
+            LexOperator<"&">,
+            LexOperator<"|">,
+            LexOperator<"^">,
+            LexOperator<"~">,
+            LexOperator<"!">,
+            LexOperator<"?">,
+            LexOperator<"@">,
+            LexOperator<".">,
 
             // Identifiers
             LexIdentifier
@@ -299,6 +327,8 @@ namespace compiler::language::lexer {
         // It will try to lex the source code with each lexer in the Tokens tuple and yield the token if one was found.
         // If no lexer was able to lex the input, it will yield an error.
         // The generator will yield an EndOfInput token when the source code has been fully lexed.
+        const auto begin = source.data();
+
         while (true) {
 
             // Try to lex the input with each lexer in the Tokens tuple
@@ -312,7 +342,10 @@ namespace compiler::language::lexer {
 
             {
                 // Unpack the lexed result
-                auto [token, length] = *result;
+                auto &[token, length] = *result;
+
+                // Remember where the token came from. Leading whitespace has already been removed from the source at this point
+                token.setLocation(source.data() - begin, length);
 
                 // Remove the lexed token from the source code
                 source = source.substr(length);
@@ -322,18 +355,34 @@ namespace compiler::language::lexer {
                     using enum Token::Type;
                     case EndOfInput:
                         co_return;
+                    case Comment:
+                        // Comments carry no meaning for the parser
+                        continue;
                     case Placeholder:
                         if (auto it = placeholders.find(std::string(wolv::util::trim(token.value()))); it != placeholders.end()) {
                             auto &[key, value] = *it;
+                            hlp::ScopedPhase phase("expand placeholders");
 
                             std::string_view valueView = value;
                             for (auto lexer = lexer::lex(valueView, placeholders); lexer;) {
                                 auto newResult = lexer();
+
+                                // Errors inside the placeholder's value are reported at the placeholder itself
+                                if (!newResult.has_value()) {
+                                    source = std::string_view(begin + token.offset(), source.data() + source.size());
+                                    co_yield newResult;
+                                    co_return;
+                                }
+
+                                // Expanded tokens don't exist in the source, point them at the placeholder instead
+                                newResult->setLocation(token.offset(), token.length());
+
                                 co_yield newResult;
                             }
 
                             continue;
                         } else {
+                            source = std::string_view(begin + token.offset(), source.data() + source.size());
                             co_yield std::unexpected(LexError::UnknownPlaceholder);
                             co_return;
                         }
@@ -1,5 +1,12 @@
 #include <compiler/language/parser.hpp>
+#include <compiler/language/evaluator.hpp>
+#include <compiler/helpers/profiler.hpp>
 
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <limits>
+#include <optional>
 #include <utility>
 
 #include <wolv/utils/string.hpp>
@@ -8,7 +15,142 @@
 namespace compiler::language::parser {
     using namespace lexer;
 
-    auto Parser::getFullTypeName(std::string_view typeName) -> std::string {
+    // Keeps malicious input from overflowing the stack
+    constexpr static u32 MaxExpressionDepth = 256;
+
+    namespace {
+
+        // Creates the builtin type with the given name. Only numeric types and bool can be used for now
+        auto makeBuiltinType(std::string_view typeName) -> std::unique_ptr<ast::NodeBuiltinType> {
+            using enum ast::NodeBuiltinType::Type;
+
+            std::optional<ast::NodeBuiltinType::Type> type;
+            if (typeName.starts_with('u'))
+                type = Unsigned;
+            else if (typeName.starts_with('i'))
+                type = Signed;
+            else if (typeName.starts_with('f'))
+                type = FloatingPoint;
+            else if (typeName == "bool")
+                type = Boolean;
+
+            std::optional<size_t> size;
+            if (typeName.ends_with('8') || typeName == "bool")
+                size = 1;
+            else if (typeName.ends_with("16"))
+                size = 2;
+            else if (typeName.ends_with("32"))
+                size = 4;
+            else if (typeName.ends_with("64"))
+                size = 8;
+
+            if (!type.has_value() || !size.has_value())
+                return nullptr;
+
+            return std::make_unique<ast::NodeBuiltinType>(*type, *size);
+        }
+
+        // bytes and string can only be passed on as they are, so they're no builtin type values can be computed with
+        auto makeSpanType(std::string_view typeName) -> std::unique_ptr<ast::NodeBuiltinType> {
+            using enum ast::NodeBuiltinType::Type;
+
+            if (typeName == "bytes")
+                return std::make_unique<ast::NodeBuiltinType>(Bytes, 0);
+            if (typeName == "string")
+                return std::make_unique<ast::NodeBuiltinType>(String, 0);
+
+            return nullptr;
+        }
+
+        auto isSpan(const ExpressionType &type) -> bool {
+            return type.builtin == ast::NodeBuiltinType::Type::Bytes || type.builtin == ast::NodeBuiltinType::Type::String;
+        }
+
+        auto isSpan(const ast::NodeType &type) -> bool {
+            return !type.isTypeParameter() && type.type()->kind() == ast::NodeKind::BuiltinType && static_cast<const ast::NodeBuiltinType &>(*type.type()).isSpan();
+        }
+
+        // Name of a builtin type, the returned view stays valid forever so it can be used as the name of inferred types
+        auto builtinTypeName(ast::NodeBuiltinType::Type type, size_t size) -> std::string_view {
+            using enum ast::NodeBuiltinType::Type;
+
+            switch (type) {
+                case Boolean:       return "bool";
+                case FloatingPoint: return size == 4 ? "f32" : "f64";
+                case Unsigned:
+                    switch (size) {
+                        case 1:  return "u8";
+                        case 2:  return "u16";
+                        case 4:  return "u32";
+                        default: return "u64";
+                    }
+                case Signed:
+                    switch (size) {
+                        case 1:  return "i8";
+                        case 2:  return "i16";
+                        case 4:  return "i32";
+                        default: return "i64";
+                    }
+                case Bytes:         return "bytes";
+                case String:        return "string";
+            }
+
+            std::unreachable();
+        }
+
+        auto builtinExpressionType(ast::NodeBuiltinType::Type type, size_t size) -> ExpressionType {
+            return { builtinTypeName(type, size), type, size };
+        }
+
+        auto expressionTypeOf(const ast::NodeType &type) -> ExpressionType {
+            if (type.isTypeParameter())
+                return { type.name() };
+            if (type.type()->kind() != ast::NodeKind::BuiltinType)
+                return { };
+
+            const auto &builtin = static_cast<const ast::NodeBuiltinType &>(*type.type());
+            return builtinExpressionType(builtin.type(), builtin.size());
+        }
+
+        // Integer promotion, everything smaller than an int is computed as int like in C
+        auto promote(const ExpressionType &type) -> ExpressionType {
+            using enum ast::NodeBuiltinType::Type;
+
+            if (type.builtin.has_value() && *type.builtin != FloatingPoint && (*type.builtin == Boolean || type.size < 4))
+                return builtinExpressionType(Signed, 4);
+
+            return type;
+        }
+
+        // Usual arithmetic conversions, the type two operands are converted to before an operation
+        auto commonType(const ExpressionType &left, const ExpressionType &right) -> ExpressionType {
+            using enum ast::NodeBuiltinType::Type;
+
+            if (!left.builtin.has_value() || !right.builtin.has_value()) {
+                // Values of the same type parameter stay of that type, everything else depends on the instantiation
+                if (!left.name.empty() && left.name == right.name)
+                    return left;
+
+                return { };
+            }
+
+            if (*left.builtin == FloatingPoint || *right.builtin == FloatingPoint) {
+                auto size = std::max(*left.builtin == FloatingPoint ? left.size : 0, *right.builtin == FloatingPoint ? right.size : 0);
+                return builtinExpressionType(FloatingPoint, size);
+            }
+
+            auto promotedLeft = promote(left), promotedRight = promote(right);
+            if (promotedLeft.size != promotedRight.size)
+                return promotedLeft.size > promotedRight.size ? promotedLeft : promotedRight;
+            if (*promotedLeft.builtin == Unsigned || *promotedRight.builtin == Unsigned)
+                return builtinExpressionType(Unsigned, promotedLeft.size);
+
+            return promotedLeft;
+        }
+
+    }
+
+    auto Parser::getFullTypeName(std::string_view typeName) const -> std::string {
         if (!this->m_namespaces.empty()) {
             return fmt::format("{}::{}", fmt::join(this->m_namespaces, "::"), typeName);
         } else {
@@ -20,6 +162,19 @@ namespace compiler::language::parser {
         // Read the driver's name
         auto driverName = this->getFullTypeName(this->getValue(-1));
 
+        // Constants, registers and functions of the previous driver aren't visible anymore
+        this->m_constants           = nullptr;
+        this->m_registers           = nullptr;
+        this->m_bursts              = nullptr;
+        this->m_buffers             = nullptr;
+        this->m_structs             = nullptr;
+        this->m_inheritance         = nullptr;
+        this->m_endianness          = std::nullopt;
+        this->m_memoryMapped        = false;
+        this->m_templateParameters  = nullptr;
+        this->m_functions           = nullptr;
+        this->m_typeParameters.clear();
+
         // Parse template list
         std::vector<std::unique_ptr<ast::NodeVariable>> templateParameters;
         if (matchesSequence(OperatorLessThan)) {
@@ -29,6 +184,10 @@ namespace compiler::language::parser {
                 if (!parameter.has_value())
                     return std::unexpected(parameter.error());
 
+                // Template values are literals, they can't refer to memory
+                if (isSpan(*parameter.value()->type()))
+                    return std::unexpected(ParseError::UnknownType);
+
                 templateParameters.push_back(std::move(parameter.value()));
             }
 
@@ -44,17 +203,54 @@ namespace compiler::language::parser {
             if (!result.has_value())
                 return std::unexpected(result.error());
 
-            inheritance = hlp::unique_ptr_cast<ast::NodeDriver>(result.value()->type()->clone());
+            inheritance = hlp::unique_ptr_cast<ast::NodeDriver>(result.value()->releaseType());
+        }
+
+        // Byte order of the device's registers and frames, and the priority of its transfers on a shared bus
+        auto endianness = this->parseEndianness();
+        auto priority = this->parsePriority();
+        if (!priority.has_value())
+            return std::unexpected(priority.error());
+
+        // Memory mapped peripherals are accessed in place. There's no bus in between that could order or convert anything
+        auto attributesEnd = this->m_current;
+        auto baseAddress = this->parseBaseAddress();
+        if (!baseAddress.has_value())
+            return std::unexpected(baseAddress.error());
+        if (baseAddress->has_value() && (inheritance != nullptr || endianness.has_value() || priority->has_value())) {
+            this->m_current = attributesEnd;
+            return std::unexpected(ParseError::InvalidMemoryMap);
         }
 
+        // Placement and inlining of all of the driver's functions, like `ramfunc` for a bus driver serving interrupts
+        auto functionAttributes = this->parseFunctionAttributes();
+        if (!functionAttributes.has_value())
+            return std::unexpected(functionAttributes.error());
+
         if (!matchesSequence(SeparatorOpenBrace))
             return std::unexpected(ParseError::UnexpectedToken);
 
         // Parse the content of the driver
         std::vector<std::unique_ptr<ast::NodeFunction>> functions;
+        std::vector<std::unique_ptr<ast::NodeConstant>> constants;
+        std::vector<std::unique_ptr<ast::NodeRegister>> registers;
+        std::vector<std::unique_ptr<ast::NodeBurst>> bursts;
+        std::vector<std::unique_ptr<ast::NodeBuffer>> buffers;
+        std::vector<std::unique_ptr<ast::NodeStruct>> structs;
+        this->m_constants           = &constants;
+        this->m_registers           = &registers;
+        this->m_bursts              = &bursts;
+        this->m_buffers             = &buffers;
+        this->m_structs             = &structs;
+        this->m_inheritance         = inheritance.get();
+        this->m_endianness          = endianness;
+        this->m_memoryMapped        = baseAddress->has_value();
+        this->m_templateParameters  = &templateParameters;
+        this->m_functions           = &functions;
+
         while (!matchesSequence(SeparatorCloseBrace)) {
 
-            if (matchesSequence(KeywordFunction, Identifier, SeparatorOpenParenthesis)) {
+            if (matchesSequence(KeywordFunction, Identifier)) {
                 // Parse the function
                 auto function = parseFunction();
                 if (!function.has_value()) {
@@ -62,12 +258,107 @@ namespace compiler::language::parser {
                 }
 
                 functions.emplace_back(std::move(function.value()));
+            } else if (matchesSequence(KeywordAsync, KeywordFunction, Identifier)) {
+                auto nameToken = this->m_current - 1;
+                auto function = parseFunction();
+                if (!function.has_value()) {
+                    return std::unexpected(function.error());
+                }
+
+                // Async functions become a state machine that starts transfers and comes back once they're done.
+                // The bus driver has to provide non-blocking versions of the transfers it needs and tell when the bus is busy
+                auto hasBusFunction = [this](std::string_view name, size_t typeParameterCount, size_t parameterCount) {
+                    auto busFunction = this->findFunction(name);
+                    return busFunction != nullptr && busFunction->typeParameters().size() == typeParameterCount && busFunction->parameters().size() == parameterCount;
+                };
+
+                const auto *expression = function.value()->expression();
+                bool reads = false, writes = false;
+                if (expression == nullptr || !function.value()->typeParameters().empty() || !this->checkAsync(*expression, reads, writes) || !hasBusFunction("busy", 0, 0) ||
+                    (reads && (!hasBusFunction("beginReadRegister", 1, 1) || !hasBusFunction("endReadRegister", 1, 0))) || (writes && !hasBusFunction("beginWriteRegister", 1, 2))) {
+                    this->m_current = nameToken;
+                    return std::unexpected(ParseError::InvalidAsyncFunction);
+                }
+
+                function.value()->setAsync(true);
+                functions.emplace_back(std::move(function.value()));
+            } else if (matchesSequence(KeywordIsr, SeparatorOpenParenthesis, StringLiteral, SeparatorCloseParenthesis, KeywordFunction, Identifier)) {
+                // Vectors are named like the C function the vector table points to, like "EXTI0_IRQHandler"
+                auto vector = this->getValue(-4);
+                auto nameToken = this->m_current - 1;
+                auto isSymbol = !vector.empty() && !std::isdigit(vector.front()) && std::ranges::all_of(vector, [](char c) { return std::isalnum(c) || c == '_'; });
+                if (!isSymbol) {
+                    this->m_current -= 4;
+                    return std::unexpected(ParseError::InvalidInterruptHandler);
+                }
+
+                auto function = parseFunction();
+                if (!function.has_value()) {
+                    return std::unexpected(function.error());
+                }
+
+                // Handlers are called from the generated vector of their interrupt, there's nothing to pass to them.
+                // Handlers of shared interrupts may return whether they handled it, the ones after them are skipped then
+                const auto *returnType = function.value()->returnType();
+                if (!function.value()->parameters().empty() || !function.value()->typeParameters().empty() || (returnType != nullptr && returnType->name() != "bool")) {
+                    this->m_current = nameToken;
+                    return std::unexpected(ParseError::InvalidInterruptHandler);
+                }
+
+                function.value()->setInterrupt(vector);
+                functions.emplace_back(std::move(function.value()));
+            } else if (matchesSequence(KeywordConst)) {
+                auto constant = parseConstant();
+                if (!constant.has_value()) {
+                    return std::unexpected(constant.error());
+                }
+
+                constants.emplace_back(std::move(constant.value()));
+            } else if (matchesSequence(KeywordRegister)) {
+                auto declaration = parseRegister();
+                if (!declaration.has_value()) {
+                    return std::unexpected(declaration.error());
+                }
+
+                registers.emplace_back(std::move(declaration.value()));
+            } else if (matchesSequence(KeywordBurst)) {
+                auto burst = parseBurst();
+                if (!burst.has_value()) {
+                    return std::unexpected(burst.error());
+                }
+
+                bursts.emplace_back(std::move(burst.value()));
+            } else if (matchesSequence(BuiltinTypeBytes, Identifier)) {
+                auto buffer = parseBuffer();
+                if (!buffer.has_value()) {
+                    return std::unexpected(buffer.error());
+                }
+
+                buffers.emplace_back(std::move(buffer.value()));
+            } else if (matchesSequence(KeywordStruct)) {
+                auto declaration = parseStruct();
+                if (!declaration.has_value()) {
+                    return std::unexpected(declaration.error());
+                }
+
+                structs.emplace_back(std::move(declaration.value()));
             } else {
                 return std::unexpected(ParseError::UnexpectedToken);
             }
         }
 
-        auto result = std::make_unique<ast::NodeDriver>(driverName, std::move(inheritance), std::move(templateParameters), std::move(functions));
+        this->m_constants           = nullptr;
+        this->m_registers           = nullptr;
+        this->m_bursts              = nullptr;
+        this->m_buffers             = nullptr;
+        this->m_structs             = nullptr;
+        this->m_inheritance         = nullptr;
+        this->m_endianness          = std::nullopt;
+        this->m_memoryMapped        = false;
+        this->m_templateParameters  = nullptr;
+        this->m_functions           = nullptr;
+
+        auto result = std::make_unique<ast::NodeDriver>(driverName, std::move(inheritance), std::move(templateParameters), std::move(functions), std::move(constants), std::move(registers), std::move(bursts), std::move(buffers), std::move(structs), endianness, *priority, *baseAddress, *functionAttributes);
 
         this->m_drivers[driverName] = result.get();
 
@@ -104,9 +395,27 @@ namespace compiler::language::parser {
     }
 
     [[nodiscard]] auto Parser::parseFunction() -> ParseResult<ast::NodeFunction> {
-        auto functionName = this->getValue(-2);
+        auto functionName = this->getValue(-1);
+
+        // Parse the type parameters of generic functions, they can be used like builtin types in the rest of the function
+        std::vector<std::string_view> typeParameters;
+        if (matchesSequence(OperatorLessThan)) {
+            do {
+                if (!matchesSequence(Identifier))
+                    return std::unexpected(ParseError::UnexpectedToken);
+
+                typeParameters.push_back(this->getValue(-1));
+            } while (matchesSequence(SeparatorComma));
+
+            if (!matchesSequence(OperatorGreaterThan))
+                return std::unexpected(ParseError::UnexpectedToken);
+        }
+        this->m_typeParameters = typeParameters;
 
         // Parse the function header
+        if (!matchesSequence(SeparatorOpenParenthesis))
+            return std::unexpected(ParseError::UnexpectedToken);
+
         std::vector<std::unique_ptr<ast::NodeVariable>> parameters;
         while (!matchesSequence(SeparatorCloseParenthesis)) {
             for (auto listParser = this->parseParameterList(); listParser;) {
@@ -119,6 +428,76 @@ namespace compiler::language::parser {
             }
         }
 
+        // Parse the return type, functions without one don't return anything
+        std::unique_ptr<ast::NodeType> returnType;
+        if (matchesSequence(OperatorArrow)) {
+            if (!matchesSequence(Token(Token::Type::BuiltinType, "void"))) {
+                auto typeBegin = this->m_current;
+
+                auto type = this->parseType();
+                if (!type.has_value())
+                    return std::unexpected(type.error());
+
+                // Drivers can't be returned, neither can bytes and strings since the memory they refer to belongs to the caller
+                if (!type.value()->isTypeParameter() && (type.value()->type()->kind() != ast::NodeKind::BuiltinType || isSpan(*type.value()))) {
+                    this->m_current = typeBegin;
+                    return std::unexpected(ParseError::UnknownType);
+                }
+
+                returnType = std::move(type.value());
+            }
+        }
+
+        auto attributes = this->parseFunctionAttributes();
+        if (!attributes.has_value())
+            return std::unexpected(attributes.error());
+
+        // Expression bodied functions return the value of their expression
+        if (matchesSequence(OperatorLambda)) {
+            auto bodyBegin = this->m_current;
+
+            this->m_parameters = &parameters;
+            auto expression = this->parseSequence();
+            std::expected<ExpressionType, ParseError> type = std::unexpected(ParseError::UnexpectedToken);
+            if (expression.has_value())
+                type = this->inferType(**expression);
+            this->m_parameters = nullptr;
+
+            if (!expression.has_value())
+                return std::unexpected(expression.error());
+            if (!type.has_value()) {
+                this->m_current = bodyBegin;
+                return std::unexpected(type.error());
+            }
+
+            if (!matchesSequence(SeparatorSemicolon))
+                return std::unexpected(ParseError::UnexpectedToken);
+
+            if (isSpan(*type)) {
+                this->m_current = bodyBegin;
+                return std::unexpected(ParseError::InvalidExpressionType);
+            }
+
+            if (returnType == nullptr && type->name != "void") {
+                // Infer the return type from the expression
+                if (type->name.empty()) {
+                    this->m_current = bodyBegin;
+                    return std::unexpected(ParseError::UnknownReturnType);
+                }
+
+                returnType = std::make_unique<ast::NodeType>(type->name, type->builtin.has_value() ? makeBuiltinType(type->name) : nullptr);
+            } else if (returnType != nullptr && type->name == "void") {
+                this->m_current = bodyBegin;
+                return std::unexpected(ParseError::InvalidExpressionType);
+            }
+
+            this->m_typeParameters.clear();
+            auto function = std::make_unique<ast::NodeFunction>(functionName, std::move(parameters), std::vector<std::unique_ptr<ast::Node>>{ }, std::move(typeParameters), std::move(returnType), std::move(expression.value()));
+            function->setAttributes(*attributes);
+
+            return function;
+        }
+
         // Parse the function body
         if (!matchesSequence(SeparatorOpenBrace)) {
             return std::unexpected(ParseError::UnexpectedToken);
@@ -136,48 +515,32 @@ namespace compiler::language::parser {
             }
         }
 
-        return std::make_unique<ast::NodeFunction>(functionName, std::move(parameters), std::move(body));
+        this->m_typeParameters.clear();
+        auto function = std::make_unique<ast::NodeFunction>(functionName, std::move(parameters), std::move(body), std::move(typeParameters), std::move(returnType));
+        function->setAttributes(*attributes);
+
+        return function;
     }
 
     auto Parser::parseType(bool allowBuiltinTypes) -> ParseResult<ast::NodeType> {
         if (allowBuiltinTypes && matchesSequence(BuiltinType)) {
             // Parse a builtin type
-
-            // Read the type name
             auto typeName = this->getValue(-1);
 
-            // Determine the type
-            ast::NodeBuiltinType::Type builtinType = [&typeName] {
-                if (typeName.starts_with('u'))
-                    return ast::NodeBuiltinType::Type::Unsigned;
-                else if (typeName.starts_with('i'))
-                    return ast::NodeBuiltinType::Type::Signed;
-                else if (typeName.starts_with('f'))
-                    return ast::NodeBuiltinType::Type::FloatingPoint;
-                else if (typeName == "bool")
-                    return ast::NodeBuiltinType::Type::Boolean;
-                else
-                    std::unreachable();
-            }();
-
-            // Determine the size
-            size_t size = [&typeName] {
-                if (typeName.ends_with('8') || typeName == "bool")
-                    return 1;
-                else if (typeName.ends_with("16"))
-                    return 2;
-                else if (typeName.ends_with("32"))
-                    return 4;
-                else if (typeName.ends_with("64"))
-                    return 8;
-                else
-                    std::unreachable();
-            }();
-
-            auto type = std::make_unique<ast::NodeBuiltinType>(builtinType, size);
+            auto type = makeBuiltinType(typeName);
+            if (type == nullptr)
+                type = makeSpanType(typeName);
+            if (type == nullptr) {
+                this->m_current--;
+                return std::unexpected(ParseError::UnknownType);
+            }
 
             return std::make_unique<ast::NodeType>(typeName, std::move(type));
-        } else if (matchesSequence(Identifier)) {
+        } else if (allowBuiltinTypes && this->m_current != this->m_end && this->peek().type() == Token::Type::Identifier && this->isTypeParameter(this->peek().value())) {
+            // Type parameters of generic functions only become an actual type once the function is instantiated
+            this->m_current++;
+            return std::make_unique<ast::NodeType>(this->getValue(-1), nullptr);
+        } else if (auto typeBegin = this->m_current; matchesSequence(Identifier)) {
             auto typeName = std::string(this->getValue(-1));
             while (matchesSequence(OperatorColon, OperatorColon, Identifier)) {
                 typeName += fmt::format("::{}", this->getValue(-1));
@@ -187,20 +550,25 @@ namespace compiler::language::parser {
                 typeName = this->getFullTypeName(typeName);
 
             if (this->m_drivers.contains(typeName)) {
+                hlp::ScopedPhase phase("instantiate", typeName);
+
                 auto driver = hlp::unique_ptr_cast<ast::NodeDriver>(this->m_drivers[typeName]->clone());
 
                 if (matchesSequence(OperatorLessThan)) {
                     // Parse the template parameters
-                    std::vector<lexer::Token> templateValues;
+                    const auto &templateParameters = driver->templateParameters();
+                    std::vector<ast::TemplateValue> templateValues;
                     while (!matchesSequence(OperatorGreaterThan)) {
-                        if (matchesSequence(NumericLiteral) || matchesSequence(StringLiteral) || matchesSequence(CharacterLiteral)) {
-                            templateValues.emplace_back(this->m_current[-1]);
-                        } else {
-                            return std::unexpected(ParseError::UnexpectedToken);
+                        auto index = templateValues.size();
+                        auto value = this->parseTemplateValue(index < templateParameters.size() ? templateParameters[index].get() : nullptr);
+                        if (!value.has_value()) {
+                            return std::unexpected(value.error());
                         }
 
-                        if (matchesSequence(SeparatorComma)) {
-                            continue;
+                        templateValues.emplace_back(std::move(value.value()));
+
+                        if (!matchesSequence(SeparatorComma) && !(this->m_current != this->m_end && this->peek() == OperatorGreaterThan)) {
+                            return std::unexpected(ParseError::UnexpectedToken);
                         }
                     }
 
@@ -212,6 +580,8 @@ namespace compiler::language::parser {
 
                 return std::make_unique<ast::NodeType>(typeName, std::move(driver));
             } else {
+                // Report the error at the type name instead of behind it
+                this->m_current = typeBegin;
                 return std::unexpected(ParseError::UnknownType);
             }
         } else {
@@ -219,79 +589,1424 @@ namespace compiler::language::parser {
         }
     }
 
-    [[nodiscard]] auto Parser::parseNamespace() -> ASTGenerator {
-        bool usedNamespace = false;
-        if (matchesSequence(KeywordNamespace)) {
-            usedNamespace = true;
+    auto Parser::findConstant(std::string_view name) const -> const ast::NodeConstant * {
+        auto findIn = [](const ast::NodeDriver *driver, std::string_view name) -> const ast::NodeConstant * {
+            // Constants are inherited just like functions
+            for (; driver != nullptr; driver = driver->inheritance()) {
+                for (const auto &constant : driver->constants()) {
+                    if (constant->name() == name)
+                        return constant.get();
+                }
+            }
 
-            if (matchesSequence(Identifier, SeparatorOpenBrace)) {
-                auto namespaceName = this->getValue(-2);
+            return nullptr;
+        };
 
-                this->m_namespaces.push_back(namespaceName);
-            } else {
-                co_yield std::unexpected(ParseError::UnexpectedToken);
-                co_return;
+        auto separator = name.rfind("::");
+        if (separator == std::string_view::npos) {
+            if (this->m_constants != nullptr) {
+                for (const auto &constant : *this->m_constants) {
+                    if (constant->name() == name)
+                        return constant.get();
+                }
             }
+
+            return findIn(this->m_inheritance, name);
         }
 
-        while (true) {
-            // Check if we have reached the end of the input
-            if (this->m_current == this->m_end || this->peek().type() == Token::Type::EndOfInput) {
-                co_return;
+        // Qualified names refer to a constant of another driver, looked up the same way as driver types
+        auto driverName = std::string(name.substr(0, separator));
+        auto it = this->m_drivers.find(driverName);
+        if (it == this->m_drivers.end())
+            it = this->m_drivers.find(this->getFullTypeName(driverName));
+        if (it == this->m_drivers.end())
+            return nullptr;
+
+        return findIn(it->second, name.substr(separator + 2));
+    }
+
+    auto Parser::findRegister(std::string_view name) const -> const ast::NodeRegister * {
+        if (this->m_registers != nullptr) {
+            for (const auto &declaration : *this->m_registers) {
+                if (declaration->name() == name)
+                    return declaration.get();
             }
+        }
 
-            if (matchesSequence(KeywordDriver, Identifier)) {
-                co_yield parseDriver();
-            } else if (this->peek() == KeywordNamespace) {
-                for (auto namespaceParser = parseNamespace(); namespaceParser;) {
-                    co_yield namespaceParser();
-                }
-            } else if (this->peek() == SeparatorCloseBrace || this->peek().type() == Token::Type::EndOfInput) {
-                break;
-            } else {
-                co_yield std::unexpected(ParseError::UnexpectedToken);
-                co_return;
+        // Registers are inherited, a driver for a specific board can use the registers of the generic device driver
+        for (auto driver = this->m_inheritance; driver != nullptr; driver = driver->inheritance()) {
+            for (const auto &declaration : driver->registers()) {
+                if (declaration->name() == name)
+                    return declaration.get();
             }
         }
 
-        if (usedNamespace) {
-            if (!matchesSequence(SeparatorCloseBrace)) {
-                co_yield std::unexpected(ParseError::UnexpectedToken);
-                co_return;
+        return nullptr;
+    }
+
+    auto Parser::findBuffer(std::string_view name) const -> const ast::NodeBuffer * {
+        if (this->m_buffers != nullptr) {
+            for (const auto &buffer : *this->m_buffers) {
+                if (buffer->name() == name)
+                    return buffer.get();
+            }
+        }
+
+        for (auto driver = this->m_inheritance; driver != nullptr; driver = driver->inheritance()) {
+            for (const auto &buffer : driver->buffers()) {
+                if (buffer->name() == name)
+                    return buffer.get();
             }
-            this->m_namespaces.pop_back();
         }
+
+        return nullptr;
     }
 
-    auto Parser::parse(const std::vector<lexer::Token> &tokens) -> ASTGenerator {
-        this->m_current = tokens.begin();
-        this->m_end     = tokens.end();
+    auto Parser::findStruct(std::string_view name) const -> const ast::NodeStruct * {
+        if (this->m_structs != nullptr) {
+            for (const auto &declaration : *this->m_structs) {
+                if (declaration->name() == name)
+                    return declaration.get();
+            }
+        }
 
-        while (true) {
-            for (auto namespaceParser = parseNamespace(); namespaceParser;) {
-                auto node = namespaceParser();
+        for (auto driver = this->m_inheritance; driver != nullptr; driver = driver->inheritance()) {
+            for (const auto &declaration : driver->structs()) {
+                if (declaration->name() == name)
+                    return declaration.get();
+            }
+        }
 
-                if (!node.has_value()) {
-                    co_yield std::unexpected(node.error());
-                    co_return;
+        return nullptr;
+    }
+
+    auto Parser::evaluate(const ast::NodeExpression &expression) const -> std::expected<ast::ConstantValue, ParseError> {
+        evaluator::Evaluator evaluator([this](std::string_view name) { return this->findConstant(name); });
+
+        auto result = evaluator.evaluate(expression);
+        if (!result.has_value())
+            return std::unexpected(result.error() == evaluator::EvaluationError::UnknownIdentifier ? ParseError::UnknownIdentifier : ParseError::InvalidConstantExpression);
+
+        return *result;
+    }
+
+    auto Parser::isTypeParameter(std::string_view name) const -> bool {
+        return std::ranges::find(this->m_typeParameters, name) != this->m_typeParameters.end();
+    }
+
+    auto Parser::findFunction(std::string_view name) const -> const ast::NodeFunction * {
+        if (this->m_functions != nullptr) {
+            for (const auto &function : *this->m_functions) {
+                if (function->name() == name)
+                    return function.get();
+            }
+        }
+
+        for (auto driver = this->m_inheritance; driver != nullptr; driver = driver->inheritance()) {
+            for (const auto &function : driver->functions()) {
+                if (function->name() == name)
+                    return function.get();
+            }
+        }
+
+        return nullptr;
+    }
+
+    auto Parser::checkAsync(const ast::NodeExpression &expression, bool &reads, bool &writes) const -> bool {
+        using Operation = ast::NodeExpression::Operation;
+
+        const auto &operands = expression.operands();
+        switch (expression.operation()) {
+            case Operation::Identifier:
+                reads |= this->findRegister(expression.value()) != nullptr;
+                break;
+            case Operation::Field:
+                reads = true;
+                break;
+            case Operation::Assignment:
+                // Fields are read, modified and written back
+                writes = true;
+                reads |= operands[0]->operation() == Operation::Field;
+                return this->checkAsync(*operands[1], reads, writes);
+            case Operation::Call: {
+                auto function = this->findFunction(expression.value());
+                if (function == nullptr)
+                    return false;
+
+                // Expression bodied functions are inlined, the bus driver's transfers are replaced with their non-blocking versions
+                if (function->expression() != nullptr) {
+                    if (!this->checkAsync(*function->expression(), reads, writes))
+                        return false;
+                } else if (function->name() == "readRegister" && function->typeParameters().size() == 1 && function->parameters().size() == 1) {
+                    reads = true;
+                } else if (function->name() == "writeRegister" && function->typeParameters().size() == 1 && function->parameters().size() == 2) {
+                    writes = true;
+                } else {
+                    return false;
                 }
+                break;
+            }
+            default:
+                break;
+        }
 
-                // Check if we have encountered an error
-                bool error = !node.has_value();
+        return std::ranges::all_of(operands, [&](const auto &operand) { return this->checkAsync(*operand, reads, writes); });
+    }
 
-                // Yield the node
-                co_yield std::move(node);
+    auto Parser::inferType(const ast::NodeExpression &expression) const -> std::expected<ExpressionType, ParseError> {
+        using enum ast::NodeBuiltinType::Type;
+        using Operation = ast::NodeExpression::Operation;
 
-                // If we have encountered an error, stop parsing
-                if (error) {
-                    co_return;
+        const auto &operands = expression.operands();
+
+        // Infers the type of an operand that's used as a value. bytes and strings can't be computed with, only passed on
+        auto valueType = [this](const ast::NodeExpression &operand) -> std::expected<ExpressionType, ParseError> {
+            auto type = this->inferType(operand);
+            if (type.has_value() && (type->name == "void" || isSpan(*type)))
+                return std::unexpected(ParseError::InvalidExpressionType);
+
+            return type;
+        };
+
+        switch (expression.operation()) {
+            case Operation::NumericLiteral: {
+                auto value = evaluator::parseNumericLiteral(expression.value());
+                if (!value.has_value())
+                    return std::unexpected(ParseError::InvalidConstantExpression);
+
+                // Literals have the smallest type of int, long long and unsigned long long they fit in.
+                // Hexadecimal ones can be unsigned int as well, binary and octal ones are generated as hexadecimal
+                if (std::holds_alternative<f64>(*value))
+                    return builtinExpressionType(FloatingPoint, 8);
+                if (std::get<i128>(*value) <= std::numeric_limits<i32>::max())
+                    return builtinExpressionType(Signed, 4);
+                if (std::get<i128>(*value) <= std::numeric_limits<u32>::max() && (expression.value().starts_with("0x") || expression.value().starts_with("0b") || expression.value().starts_with("0o")))
+                    return builtinExpressionType(Unsigned, 4);
+                if (std::get<i128>(*value) <= std::numeric_limits<i64>::max())
+                    return builtinExpressionType(Signed, 8);
+
+                return builtinExpressionType(Unsigned, 8);
+            }
+            case Operation::CharacterLiteral:
+                return builtinExpressionType(Signed, 4);
+            case Operation::StringLiteral:
+                return ExpressionType { };
+            case Operation::Identifier: {
+                auto name = expression.value();
+
+                if (this->m_parameters != nullptr) {
+                    for (const auto &parameter : *this->m_parameters) {
+                        if (parameter->name() == name)
+                            return expressionTypeOf(*parameter->type());
+                    }
+                }
+
+                // Template parameters of the driver and the drivers it inherits from
+                if (this->m_templateParameters != nullptr) {
+                    for (const auto &parameter : *this->m_templateParameters) {
+                        if (parameter->name() == name)
+                            return expressionTypeOf(*parameter->type());
+                    }
+                }
+                for (auto driver = this->m_inheritance; driver != nullptr; driver = driver->inheritance()) {
+                    for (const auto &parameter : driver->templateParameters()) {
+                        if (parameter->name() == name)
+                            return expressionTypeOf(*parameter->type());
+                    }
+                }
+
+                if (auto constant = this->findConstant(name); constant != nullptr) {
+                    // Tables can only be indexed
+                    if (constant->isTable())
+                        return std::unexpected(ParseError::InvalidExpressionType);
+
+                    return expressionTypeOf(*constant->type());
                 }
+
+                // Registers are read as a whole
+                if (auto declaration = this->findRegister(name); declaration != nullptr) {
+                    if (!declaration->isReadable())
+                        return std::unexpected(ParseError::InvalidExpressionType);
+
+                    return expressionTypeOf(*declaration->type());
+                }
+
+                // Buffers are passed as the bytes they hold
+                if (this->findBuffer(name) != nullptr)
+                    return builtinExpressionType(Bytes, 0);
+
+                if (name == "true" || name == "false")
+                    return builtinExpressionType(Boolean, 1);
+
+                return std::unexpected(ParseError::UnknownIdentifier);
             }
+            case Operation::UnaryOperator: {
+                auto operand = valueType(*operands[0]);
+                if (!operand.has_value())
+                    return operand;
 
-            // Check if we have reached the end of the input
-            if (this->m_current == this->m_end || this->peek().type() == Token::Type::EndOfInput) {
-                co_return;
+                if (expression.value() == "!")
+                    return builtinExpressionType(Boolean, 1);
+
+                return promote(*operand);
+            }
+            case Operation::BinaryOperator: {
+                auto left = valueType(*operands[0]);
+                if (!left.has_value())
+                    return left;
+
+                auto right = valueType(*operands[1]);
+                if (!right.has_value())
+                    return right;
+
+                auto op = expression.value();
+                if (op == "==" || op == "!=" || op == "<" || op == ">" || op == "<=" || op == ">=" || op == "&&" || op == "||")
+                    return builtinExpressionType(Boolean, 1);
+                if (op == "<<" || op == ">>")
+                    return promote(*left);
+
+                return commonType(*left, *right);
+            }
+            case Operation::TernaryOperator: {
+                auto condition = valueType(*operands[0]);
+                if (!condition.has_value())
+                    return condition;
+
+                auto trueType = valueType(*operands[1]);
+                if (!trueType.has_value())
+                    return trueType;
+
+                auto falseType = valueType(*operands[2]);
+                if (!falseType.has_value())
+                    return falseType;
+
+                return commonType(*trueType, *falseType);
+            }
+            case Operation::Call: {
+                auto function = this->findFunction(expression.value());
+                if (function == nullptr)
+                    return std::unexpected(ParseError::UnknownIdentifier);
+
+                if (operands.size() != function->parameters().size())
+                    return std::unexpected(ParseError::InvalidArgumentCount);
+                if (expression.typeArguments().size() != function->typeParameters().size())
+                    return std::unexpected(ParseError::InvalidTemplateParameterCount);
+
+                for (size_t i = 0; i < operands.size(); i++) {
+                    auto type = this->inferType(*operands[i]);
+                    if (!type.has_value())
+                        return type;
+
+                    // bytes and strings are only passed to parameters of the same type, string literals to strings as well
+                    const auto &parameterType = *function->parameters()[i]->type();
+                    if (isSpan(parameterType) || isSpan(*type)) {
+                        bool literal = operands[i]->operation() == Operation::StringLiteral && parameterType.name() == "string";
+                        if (!literal && (!isSpan(parameterType) || parameterType.name() != type->name))
+                            return std::unexpected(ParseError::InvalidExpressionType);
+                    }
+                }
+
+                const auto returnType = function->returnType();
+                if (returnType == nullptr)
+                    return ExpressionType { "void" };
+                if (!returnType->isTypeParameter())
+                    return expressionTypeOf(*returnType);
+
+                // Generic return types are replaced with the type the function is called with
+                const auto &typeParameters = function->typeParameters();
+                auto index = std::ranges::find(typeParameters, returnType->name()) - typeParameters.begin();
+                const auto &typeArgument = expression.typeArguments()[index];
+                if (auto builtin = makeBuiltinType(typeArgument); builtin != nullptr)
+                    return builtinExpressionType(builtin->type(), builtin->size());
+
+                // Passed on from the type parameter of a generic caller, the views into the token stream stay valid
+                return ExpressionType { *std::ranges::find(this->m_typeParameters, typeArgument) };
+            }
+            case Operation::Index: {
+                const auto &table = *operands[0];
+                auto constant = table.operation() == Operation::Identifier ? this->findConstant(table.value()) : nullptr;
+                if (constant == nullptr)
+                    return std::unexpected(table.operation() == Operation::Identifier ? ParseError::UnknownIdentifier : ParseError::InvalidExpressionType);
+                if (!constant->isTable())
+                    return std::unexpected(ParseError::InvalidExpressionType);
+
+                auto index = valueType(*operands[1]);
+                if (!index.has_value())
+                    return index;
+
+                return expressionTypeOf(*constant->type());
             }
+            case Operation::Lambda:
+            case Operation::Array:
+                // Only valid in constant expressions
+                return std::unexpected(ParseError::InvalidExpressionType);
+            case Operation::Field: {
+                auto declaration = this->findRegister(operands[0]->value());
+                if (operands[0]->operation() != Operation::Identifier || declaration == nullptr)
+                    return std::unexpected(ParseError::UnknownIdentifier);
+
+                auto field = declaration->findField(expression.value());
+                if (field == nullptr)
+                    return std::unexpected(ParseError::UnknownIdentifier);
+                if (!declaration->isReadable())
+                    return std::unexpected(ParseError::InvalidExpressionType);
+
+                return expressionTypeOf(*field->type);
+            }
+            case Operation::Assignment: {
+                // Only registers and their fields can be assigned. Fields are updated by reading the register, so it has to be readable as well
+                const auto &target = *operands[0];
+                auto declaration = this->findRegister(target.operation() == Operation::Field ? target.operands()[0]->value() : target.value());
+                if (declaration == nullptr || (target.operation() != Operation::Identifier && target.operation() != Operation::Field))
+                    return std::unexpected(target.operation() == Operation::Identifier ? ParseError::UnknownIdentifier : ParseError::InvalidExpressionType);
+
+                if (target.operation() == Operation::Field) {
+                    if (auto type = this->inferType(target); !type.has_value())
+                        return type;
+                }
+                if (!declaration->isWritable())
+                    return std::unexpected(ParseError::InvalidExpressionType);
+
+                auto value = valueType(*operands[1]);
+                if (!value.has_value())
+                    return value;
+                if (!value->builtin.has_value() || value->builtin == FloatingPoint)
+                    return std::unexpected(ParseError::InvalidExpressionType);
+
+                return ExpressionType { "void" };
+            }
+            case Operation::Sequence: {
+                std::expected<ExpressionType, ParseError> type;
+                for (const auto &operand : operands) {
+                    type = this->inferType(*operand);
+                    if (!type.has_value())
+                        return type;
+                }
+
+                return type;
+            }
+        }
+
+        return std::unexpected(ParseError::InvalidExpressionType);
+    }
+
+    auto Parser::parseConstant() -> ParseResult<ast::NodeConstant> {
+        // Upper limit of the number of elements of a table, they end up in the flash of a microcontroller after all
+        constexpr static size_t MaxTableSize = 64 * 1024;
+
+        auto typeBegin = this->m_current;
+        auto type = this->parseType();
+        if (!type.has_value())
+            return std::unexpected(type.error());
+
+        // Only values of builtin types can be computed at compile time
+        if (type.value()->type()->kind() != ast::NodeKind::BuiltinType || isSpan(*type.value())) {
+            this->m_current = typeBegin;
+            return std::unexpected(ParseError::InvalidConstantExpression);
+        }
+        const auto &builtinType = static_cast<const ast::NodeBuiltinType &>(*type.value()->type());
+
+        if (!matchesSequence(Identifier))
+            return std::unexpected(ParseError::UnexpectedToken);
+
+        auto nameToken = this->m_current - 1;
+        auto name = nameToken->value();
+        for (const auto &constant : *this->m_constants) {
+            if (constant->name() == name) {
+                this->m_current = nameToken;
+                return std::unexpected(ParseError::RedefinedConstant);
+            }
+        }
+
+        // Tables either have a fixed size or take the size of their initializer
+        bool table = false;
+        std::optional<size_t> size;
+        if (matchesSequence(SeparatorOpenBracket)) {
+            table = true;
+
+            if (!matchesSequence(SeparatorCloseBracket)) {
+                auto sizeBegin = this->m_current;
+                auto sizeExpression = this->parseNested(SeparatorCloseBracket);
+                if (!sizeExpression.has_value())
+                    return std::unexpected(sizeExpression.error());
+
+                auto sizeValue = this->evaluate(**sizeExpression);
+                if (!sizeValue.has_value()) {
+                    this->m_current = sizeBegin;
+                    return std::unexpected(sizeValue.error());
+                }
+
+                if (!std::holds_alternative<i128>(*sizeValue) || std::get<i128>(*sizeValue) <= 0 || std::get<i128>(*sizeValue) > i128(MaxTableSize)) {
+                    this->m_current = sizeBegin;
+                    return std::unexpected(ParseError::InvalidConstantExpression);
+                }
+
+                size = size_t(std::get<i128>(*sizeValue));
+            }
+        }
+
+        if (!matchesSequence(OperatorAssign))
+            return std::unexpected(ParseError::UnexpectedToken);
+
+        auto expressionBegin = this->m_current;
+        auto expression = this->parseExpression();
+        if (!expression.has_value())
+            return std::unexpected(expression.error());
+
+        if (!matchesSequence(SeparatorSemicolon))
+            return std::unexpected(ParseError::UnexpectedToken);
+
+        // Evaluate the initializer right away, later constants and template arguments may refer to it
+        auto fail = [this, expressionBegin](ParseError error) -> ParseResult<ast::NodeConstant> {
+            this->m_current = expressionBegin;
+            return std::unexpected(error);
+        };
+
+        evaluator::Evaluator evaluator([this](std::string_view name) { return this->findConstant(name); });
+        auto addValue = [&](const evaluator::EvaluationResult &value, std::vector<ast::ConstantValue> &values) -> std::optional<ParseError> {
+            if (!value.has_value())
+                return value.error() == evaluator::EvaluationError::UnknownIdentifier ? ParseError::UnknownIdentifier : ParseError::InvalidConstantExpression;
+
+            auto converted = evaluator::convert(*value, builtinType);
+            if (std::holds_alternative<f64>(converted) && !std::isfinite(std::get<f64>(converted)))
+                return ParseError::InvalidConstantExpression;
+
+            values.push_back(converted);
+            return std::nullopt;
+        };
+
+        std::vector<ast::ConstantValue> values;
+        const auto &initializer = **expression;
+        if (!table) {
+            if (auto error = addValue(evaluator.evaluate(initializer), values))
+                return fail(*error);
+        } else {
+            if (initializer.operation() != ast::NodeExpression::Operation::Array)
+                return fail(ParseError::InvalidConstantExpression);
+
+            const auto &elements = initializer.operands();
+            if (elements.size() == 1 && elements.front()->operation() == ast::NodeExpression::Operation::Lambda) {
+                // Generated table, the lambda is called with the index of every element
+                if (!size.has_value())
+                    return fail(ParseError::InvalidConstantExpression);
+
+                values.reserve(*size);
+                for (size_t i = 0; i < *size; i++) {
+                    if (auto error = addValue(evaluator.evaluateLambda(*elements.front(), i128(i)), values))
+                        return fail(*error);
+                }
+            } else {
+                if (elements.empty() || elements.size() > MaxTableSize || (size.has_value() && *size != elements.size()))
+                    return fail(ParseError::InvalidConstantExpression);
+
+                values.reserve(elements.size());
+                for (const auto &element : elements) {
+                    if (auto error = addValue(evaluator.evaluate(*element), values))
+                        return fail(*error);
+                }
+            }
+        }
+
+        return std::make_unique<ast::NodeConstant>(name, std::move(type.value()), table, std::move(expression.value()), std::move(values));
+    }
+
+    auto Parser::parseRegister() -> ParseResult<ast::NodeRegister> {
+        using enum ast::NodeBuiltinType::Type;
+
+        // Registers are transferred as a whole, so they need an integer type the bus driver can be instantiated with
+        auto typeBegin = this->m_current;
+        auto type = this->parseType();
+        if (!type.has_value())
+            return std::unexpected(type.error());
+
+        const auto *builtinType = type.value()->type() != nullptr && type.value()->type()->kind() == ast::NodeKind::BuiltinType ? static_cast<const ast::NodeBuiltinType *>(type.value()->type()) : nullptr;
+        if (builtinType == nullptr || (builtinType->type() != Unsigned && builtinType->type() != Signed)) {
+            this->m_current = typeBegin;
+            return std::unexpected(ParseError::InvalidRegister);
+        }
+        const auto bits = builtinType->size() * 8;
+
+        if (!matchesSequence(Identifier))
+            return std::unexpected(ParseError::UnexpectedToken);
+
+        auto nameToken = this->m_current - 1;
+        auto name = nameToken->value();
+        if (std::ranges::find(*this->m_registers, name, &ast::NodeRegister::name) != this->m_registers->end() || std::ranges::find(*this->m_bursts, name, &ast::NodeBurst::name) != this->m_bursts->end() || this->findStruct(name) != nullptr) {
+            this->m_current = nameToken;
+            return std::unexpected(ParseError::InvalidRegister);
+        }
+
+        if (!matchesSequence(OperatorAt))
+            return std::unexpected(ParseError::UnexpectedToken);
+
+        auto address = this->parseUnsignedConstant(std::numeric_limits<u64>::max());
+        if (!address.has_value())
+            return std::unexpected(address.error());
+
+        // Registers are readable and writable unless they're declared as read only or write only.
+        // Cached ones have to be readable, their copy in RAM is filled by reading them
+        std::optional<ast::NodeRegister::Access> access;
+        std::optional<ast::Endianness> endianness;
+        bool cached = false;
+        while (matchesSequence(Identifier)) {
+            auto attribute = this->getValue(-1);
+            if (attribute == "cached" && !cached) {
+                cached = true;
+            } else if ((attribute == "big" || attribute == "little") && !endianness.has_value()) {
+                endianness = attribute == "big" ? ast::Endianness::Big : ast::Endianness::Little;
+            } else if (attribute == "r" && !access.has_value()) {
+                access = ast::NodeRegister::Access::Read;
+            } else if (attribute == "w" && !access.has_value()) {
+                access = ast::NodeRegister::Access::Write;
+            } else if (attribute == "rw" && !access.has_value()) {
+                access = ast::NodeRegister::Access::ReadWrite;
+            } else {
+                this->m_current--;
+                return std::unexpected(ParseError::InvalidRegister);
+            }
+        }
+
+        if (!access.has_value())
+            access = ast::NodeRegister::Access::ReadWrite;
+        if (cached && access == ast::NodeRegister::Access::Write) {
+            this->m_current = nameToken;
+            return std::unexpected(ParseError::InvalidRegister);
+        }
+
+        // Registers of memory mapped peripherals are overlaid with a struct, so they have to be aligned and must not overlap.
+        // Reading them is as cheap as reading a copy and they're in the host's byte order already
+        if (this->m_memoryMapped) {
+            auto overlaps = [&](const auto &other) {
+                return *address < other->address() + other->builtinType().size() && other->address() < *address + builtinType->size();
+            };
+
+            if (cached || endianness.has_value() || *address % builtinType->size() != 0 || std::ranges::any_of(*this->m_registers, overlaps)) {
+                this->m_current = nameToken;
+                return std::unexpected(ParseError::InvalidRegister);
+            }
+        }
+
+        // Others are accessed through the bus driver, that has to provide the generic functions to do so
+        auto hasBusFunction = [this](std::string_view name, size_t parameterCount) {
+            auto function = this->findFunction(name);
+            return function != nullptr && function->typeParameters().size() == 1 && function->parameters().size() == parameterCount;
+        };
+
+        if (!this->m_memoryMapped && ((*access != ast::NodeRegister::Access::Write && !hasBusFunction("readRegister", 1)) || (*access != ast::NodeRegister::Access::Read && !hasBusFunction("writeRegister", 2)))) {
+            this->m_current = nameToken;
+            return std::unexpected(ParseError::InvalidRegister);
+        }
+
+        std::vector<ast::NodeRegister::Field> fields;
+        if (!matchesSequence(SeparatorSemicolon)) {
+            if (!matchesSequence(SeparatorOpenBrace))
+                return std::unexpected(ParseError::UnexpectedToken);
+
+            u64 usedBits = 0;
+            while (!matchesSequence(SeparatorCloseBrace)) {
+                // Fields are unsigned numbers or flags, they're converted to their type after being masked out
+                auto fieldBegin = this->m_current;
+                auto fieldType = this->parseType();
+                if (!fieldType.has_value())
+                    return std::unexpected(fieldType.error());
+
+                const auto *fieldBuiltinType = fieldType.value()->type() != nullptr && fieldType.value()->type()->kind() == ast::NodeKind::BuiltinType ? static_cast<const ast::NodeBuiltinType *>(fieldType.value()->type()) : nullptr;
+                if (fieldBuiltinType == nullptr || (fieldBuiltinType->type() != Unsigned && fieldBuiltinType->type() != Boolean)) {
+                    this->m_current = fieldBegin;
+                    return std::unexpected(ParseError::InvalidRegister);
+                }
+
+                if (!matchesSequence(Identifier, OperatorAt))
+                    return std::unexpected(ParseError::UnexpectedToken);
+
+                auto fieldNameToken = this->m_current - 2;
+                if (std::ranges::find(fields, fieldNameToken->value(), &ast::NodeRegister::Field::name) != fields.end()) {
+                    this->m_current = fieldNameToken;
+                    return std::unexpected(ParseError::InvalidRegister);
+                }
+
+                auto offset = this->parseUnsignedConstant(bits - 1);
+                if (!offset.has_value())
+                    return std::unexpected(offset.error());
+
+                // Flags are a single bit, other fields are as wide as their type unless their width is given
+                u64 width = fieldBuiltinType->type() == Boolean ? 1 : std::min<u64>(fieldBuiltinType->size() * 8, bits - *offset);
+                if (matchesSequence(OperatorColon)) {
+                    auto widthBegin = this->m_current;
+                    auto explicitWidth = this->parseUnsignedConstant(fieldBuiltinType->type() == Boolean ? 1 : fieldBuiltinType->size() * 8);
+                    if (!explicitWidth.has_value())
+                        return std::unexpected(explicitWidth.error());
+                    if (*explicitWidth == 0) {
+                        this->m_current = widthBegin;
+                        return std::unexpected(ParseError::InvalidRegister);
+                    }
+
+                    width = *explicitWidth;
+                }
+
+                // Fields have to fit into the register and can't overlap
+                auto mask = (width == 64 ? ~u64(0) : (u64(1) << width) - 1) << *offset;
+                if (*offset + width > bits || (usedBits & mask) != 0) {
+                    this->m_current = fieldNameToken;
+                    return std::unexpected(ParseError::InvalidRegister);
+                }
+                usedBits |= mask;
+
+                if (!matchesSequence(SeparatorSemicolon))
+                    return std::unexpected(ParseError::UnexpectedToken);
+
+                fields.push_back({ fieldNameToken->value(), std::move(fieldType.value()), u8(*offset), u8(width) });
+            }
+        }
+
+        // Registers that don't declare their byte order use the one of the device, if there's none they're used as the bus driver returns them
+        if (!endianness.has_value())
+            endianness = this->defaultEndianness();
+
+        return std::make_unique<ast::NodeRegister>(name, std::move(type.value()), *address, *access, cached, std::move(fields), endianness, this->m_memoryMapped);
+    }
+
+    auto Parser::parseBurst() -> ParseResult<ast::NodeBurst> {
+        if (!matchesSequence(Identifier))
+            return std::unexpected(ParseError::UnexpectedToken);
+
+        // Bursts get accessors just like registers, so they share their names
+        auto nameToken = this->m_current - 1;
+        auto name = nameToken->value();
+        if (std::ranges::find(*this->m_registers, name, &ast::NodeRegister::name) != this->m_registers->end() || std::ranges::find(*this->m_bursts, name, &ast::NodeBurst::name) != this->m_bursts->end() || this->findStruct(name) != nullptr) {
+            this->m_current = nameToken;
+            return std::unexpected(ParseError::InvalidBurst);
+        }
+
+        // The bus driver reads all of them in a single transfer, it has to provide the generic function to do so
+        auto function = this->findFunction("readRegisters");
+        if (function == nullptr || function->typeParameters().size() != 1 || function->parameters().size() != 1) {
+            this->m_current = nameToken;
+            return std::unexpected(ParseError::InvalidBurst);
+        }
+
+        if (!matchesSequence(SeparatorOpenBrace))
+            return std::unexpected(ParseError::UnexpectedToken);
+
+        // Registers are listed by ascending address, every one of them directly follows the previous one
+        std::vector<std::string_view> registers;
+        const ast::NodeRegister *previous = nullptr;
+        do {
+            if (!matchesSequence(Identifier))
+                return std::unexpected(ParseError::UnexpectedToken);
+
+            const auto *declaration = this->findRegister(this->getValue(-1));
+            if (declaration == nullptr) {
+                this->m_current--;
+                return std::unexpected(ParseError::UnknownIdentifier);
+            }
+
+            if (!declaration->isReadable() || declaration->isMemoryMapped() || (previous != nullptr && declaration->address() != previous->address() + 1)) {
+                this->m_current--;
+                return std::unexpected(ParseError::InvalidBurst);
+            }
+
+            registers.push_back(declaration->name());
+            previous = declaration;
+        } while (matchesSequence(SeparatorComma));
+
+        if (!matchesSequence(SeparatorCloseBrace))
+            return std::unexpected(ParseError::UnexpectedToken);
+
+        return std::make_unique<ast::NodeBurst>(name, std::move(registers));
+    }
+
+    auto Parser::parseBuffer() -> ParseResult<ast::NodeBuffer> {
+        // Buffers are passed to functions by name, so they can't share it with anything else a function can refer to
+        auto nameToken = this->m_current - 1;
+        auto name = nameToken->value();
+        if (this->findConstant(name) != nullptr || this->findRegister(name) != nullptr || this->findBuffer(name) != nullptr || this->findStruct(name) != nullptr || std::ranges::find(*this->m_bursts, name, &ast::NodeBurst::name) != this->m_bursts->end()) {
+            this->m_current = nameToken;
+            return std::unexpected(ParseError::InvalidBuffer);
+        }
+
+        if (!matchesSequence(SeparatorOpenBracket))
+            return std::unexpected(ParseError::UnexpectedToken);
+
+        auto sizeBegin = this->m_current;
+        auto size = this->parseUnsignedConstant(std::numeric_limits<u32>::max());
+        if (!size.has_value())
+            return std::unexpected(size.error());
+        if (*size == 0) {
+            this->m_current = sizeBegin;
+            return std::unexpected(ParseError::InvalidBuffer);
+        }
+
+        if (!matchesSequence(SeparatorCloseBracket))
+            return std::unexpected(ParseError::UnexpectedToken);
+
+        // DMA controllers often need their buffers aligned to their burst size or placed in memory they can reach
+        u64 alignment = 0;
+        std::string_view section;
+        while (matchesSequence(Identifier)) {
+            auto attributeToken = this->m_current - 1;
+            auto attribute = attributeToken->value();
+
+            if (!matchesSequence(SeparatorOpenParenthesis))
+                return std::unexpected(ParseError::UnexpectedToken);
+
+            if (attribute == "aligned" && alignment == 0) {
+                auto alignmentBegin = this->m_current;
+                auto value = this->parseUnsignedConstant(std::numeric_limits<u32>::max());
+                if (!value.has_value())
+                    return std::unexpected(value.error());
+                if (*value == 0 || (*value & (*value - 1)) != 0) {
+                    this->m_current = alignmentBegin;
+                    return std::unexpected(ParseError::InvalidBuffer);
+                }
+
+                alignment = *value;
+            } else if (attribute == "section" && section.empty() && matchesSequence(StringLiteral) && !this->getValue(-1).empty()) {
+                section = this->getValue(-1);
+            } else {
+                this->m_current = attributeToken;
+                return std::unexpected(ParseError::InvalidBuffer);
+            }
+
+            if (!matchesSequence(SeparatorCloseParenthesis))
+                return std::unexpected(ParseError::UnexpectedToken);
+        }
+
+        if (!matchesSequence(SeparatorSemicolon))
+            return std::unexpected(ParseError::UnexpectedToken);
+
+        return std::make_unique<ast::NodeBuffer>(name, *size, alignment, section);
+    }
+
+    auto Parser::parseStruct() -> ParseResult<ast::NodeStruct> {
+        using enum ast::NodeBuiltinType::Type;
+
+        if (!matchesSequence(Identifier))
+            return std::unexpected(ParseError::UnexpectedToken);
+
+        // Structs get accessors named after them just like registers, bursts and buffers
+        auto nameToken = this->m_current - 1;
+        auto name = nameToken->value();
+        if (this->findConstant(name) != nullptr || this->findRegister(name) != nullptr || this->findBuffer(name) != nullptr || this->findStruct(name) != nullptr || std::ranges::find(*this->m_bursts, name, &ast::NodeBurst::name) != this->m_bursts->end()) {
+            this->m_current = nameToken;
+            return std::unexpected(ParseError::InvalidStruct);
+        }
+
+        // Devices mostly send their frames in one byte order, fields can still override it
+        auto endianness = this->parseEndianness().or_else([this] { return this->defaultEndianness(); }).value_or(ast::Endianness::Little);
+
+        if (!matchesSequence(SeparatorOpenBrace))
+            return std::unexpected(ParseError::UnexpectedToken);
+
+        std::vector<ast::NodeStruct::Field> fields;
+        u64 size = 0;
+        while (!matchesSequence(SeparatorCloseBrace)) {
+            auto fieldBegin = this->m_current;
+            auto fieldType = this->parseType();
+            if (!fieldType.has_value())
+                return std::unexpected(fieldType.error());
+
+            // Fields hold values, C has no floating point types other than float and double
+            const auto *builtinType = fieldType.value()->type() != nullptr && fieldType.value()->type()->kind() == ast::NodeKind::BuiltinType ? static_cast<const ast::NodeBuiltinType *>(fieldType.value()->type()) : nullptr;
+            if (builtinType == nullptr || builtinType->isSpan() || (builtinType->type() == FloatingPoint && builtinType->size() < 4)) {
+                this->m_current = fieldBegin;
+                return std::unexpected(ParseError::InvalidStruct);
+            }
+
+            if (!matchesSequence(Identifier))
+                return std::unexpected(ParseError::UnexpectedToken);
+
+            auto fieldNameToken = this->m_current - 1;
+            if (std::ranges::find(fields, fieldNameToken->value(), &ast::NodeStruct::Field::name) != fields.end()) {
+                this->m_current = fieldNameToken;
+                return std::unexpected(ParseError::InvalidStruct);
+            }
+
+            // Fields directly follow the previous one unless their offset is given, skipped bytes are reserved
+            u64 offset = size;
+            if (matchesSequence(OperatorAt)) {
+                auto offsetBegin = this->m_current;
+                auto explicitOffset = this->parseUnsignedConstant(std::numeric_limits<u32>::max());
+                if (!explicitOffset.has_value())
+                    return std::unexpected(explicitOffset.error());
+                if (*explicitOffset < size) {
+                    this->m_current = offsetBegin;
+                    return std::unexpected(ParseError::InvalidStruct);
+                }
+
+                offset = *explicitOffset;
+            }
+
+            // Integers can be narrower than their type, like 24 bit samples. Floating point values always have their full width
+            u64 width = builtinType->size();
+            if (matchesSequence(OperatorColon)) {
+                auto widthBegin = this->m_current;
+                auto explicitWidth = this->parseUnsignedConstant(builtinType->size());
+                if (!explicitWidth.has_value())
+                    return std::unexpected(explicitWidth.error());
+                if (*explicitWidth == 0 || (builtinType->type() == FloatingPoint && *explicitWidth != builtinType->size())) {
+                    this->m_current = widthBegin;
+                    return std::unexpected(ParseError::InvalidStruct);
+                }
+
+                width = *explicitWidth;
+            }
+
+            if (offset + width > std::numeric_limits<u32>::max()) {
+                this->m_current = fieldNameToken;
+                return std::unexpected(ParseError::InvalidStruct);
+            }
+
+            auto fieldEndianness = this->parseEndianness().value_or(endianness);
+
+            if (!matchesSequence(SeparatorSemicolon))
+                return std::unexpected(ParseError::UnexpectedToken);
+
+            fields.push_back({ fieldNameToken->value(), std::move(fieldType.value()), u32(offset), u8(width), fieldEndianness });
+            size = offset + width;
+        }
+
+        if (fields.empty()) {
+            this->m_current = nameToken;
+            return std::unexpected(ParseError::InvalidStruct);
+        }
+
+        return std::make_unique<ast::NodeStruct>(name, endianness, u32(size), std::move(fields));
+    }
+
+    auto Parser::parseEndianness() -> std::optional<ast::Endianness> {
+        if (this->m_current == this->m_end || this->peek().type() != Token::Type::Identifier)
+            return std::nullopt;
+
+        auto value = this->peek().value();
+        if (value != "big" && value != "little")
+            return std::nullopt;
+
+        this->m_current++;
+        return value == "big" ? ast::Endianness::Big : ast::Endianness::Little;
+    }
+
+    auto Parser::parsePriority() -> std::expected<std::optional<u8>, ParseError> {
+        if (this->m_current == this->m_end || this->peek().type() != Token::Type::Identifier || this->peek().value() != "priority")
+            return std::nullopt;
+
+        this->m_current++;
+        if (!matchesSequence(SeparatorOpenParenthesis))
+            return std::unexpected(ParseError::UnexpectedToken);
+
+        auto valueBegin = this->m_current;
+        auto value = this->parseUnsignedConstant(std::numeric_limits<u32>::max());
+        if (!value.has_value())
+            return std::unexpected(value.error());
+        if (*value >= ast::NodeDriver::PriorityLevels) {
+            this->m_current = valueBegin;
+            return std::unexpected(ParseError::InvalidPriority);
+        }
+
+        if (!matchesSequence(SeparatorCloseParenthesis))
+            return std::unexpected(ParseError::UnexpectedToken);
+
+        return u8(*value);
+    }
+
+    auto Parser::parseBaseAddress() -> std::expected<std::optional<u64>, ParseError> {
+        if (this->m_current == this->m_end || this->peek().type() != Token::Type::Identifier || this->peek().value() != "mmio")
+            return std::nullopt;
+
+        this->m_current++;
+        if (!matchesSequence(SeparatorOpenParenthesis))
+            return std::unexpected(ParseError::UnexpectedToken);
+
+        auto value = this->parseUnsignedConstant(std::numeric_limits<u64>::max());
+        if (!value.has_value())
+            return std::unexpected(value.error());
+
+        if (!matchesSequence(SeparatorCloseParenthesis))
+            return std::unexpected(ParseError::UnexpectedToken);
+
+        return *value;
+    }
+
+    auto Parser::parseFunctionAttributes() -> std::expected<ast::FunctionAttributes, ParseError> {
+        using Temperature = ast::FunctionAttributes::Temperature;
+        using Inlining = ast::FunctionAttributes::Inlining;
+
+        ast::FunctionAttributes attributes;
+        while (this->m_current != this->m_end && this->peek().type() == Token::Type::Identifier) {
+            auto attributeToken = this->m_current;
+            auto attribute = this->peek().value();
+
+            // Each of them can only be given once, and hot code can't be cold or inlined code be kept out of line at the same time
+            bool valid = true;
+            if (attribute == "hot" || attribute == "cold") {
+                valid = attributes.temperature == Temperature::Default;
+                attributes.temperature = attribute == "hot" ? Temperature::Hot : Temperature::Cold;
+            } else if (attribute == "inline" || attribute == "noinline") {
+                valid = attributes.inlining == Inlining::Default;
+                attributes.inlining = attribute == "inline" ? Inlining::Always : Inlining::Never;
+            } else if (attribute == "ramfunc") {
+                valid = attributes.section.empty();
+                attributes.section = ".ramfunc";
+            } else {
+                break;
+            }
+
+            this->m_current++;
+
+            // Functions run from RAM are placed in `.ramfunc` unless the linker script calls it differently, like `ramfunc(".itcm")`
+            if (attribute == "ramfunc" && matchesSequence(SeparatorOpenParenthesis)) {
+                if (!matchesSequence(StringLiteral) || this->getValue(-1).empty()) {
+                    this->m_current = attributeToken;
+                    return std::unexpected(ParseError::InvalidFunctionAttributes);
+                }
+
+                attributes.section = this->getValue(-1);
+                if (!matchesSequence(SeparatorCloseParenthesis))
+                    return std::unexpected(ParseError::UnexpectedToken);
+            }
+
+            if (!valid) {
+                this->m_current = attributeToken;
+                return std::unexpected(ParseError::InvalidFunctionAttributes);
+            }
+        }
+
+        return attributes;
+    }
+
+    auto Parser::defaultEndianness() const -> std::optional<ast::Endianness> {
+        if (this->m_endianness.has_value())
+            return this->m_endianness;
+
+        return this->m_inheritance != nullptr ? this->m_inheritance->deviceEndianness() : std::nullopt;
+    }
+
+    auto Parser::parseUnsignedConstant(u64 limit) -> std::expected<u64, ParseError> {
+        auto begin = this->m_current;
+        auto expression = this->parseExpression();
+        if (!expression.has_value())
+            return std::unexpected(expression.error());
+
+        auto value = this->evaluate(**expression);
+        if (!value.has_value()) {
+            this->m_current = begin;
+            return std::unexpected(value.error());
+        }
+
+        if (!std::holds_alternative<i128>(*value) || std::get<i128>(*value) < 0 || std::get<i128>(*value) > i128(limit)) {
+            this->m_current = begin;
+            return std::unexpected(ParseError::InvalidConstantExpression);
+        }
+
+        return u64(std::get<i128>(*value));
+    }
+
+    auto Parser::parseTemplateValue(const ast::NodeVariable *parameter) -> std::expected<ast::TemplateValue, ParseError> {
+        auto begin = this->m_current;
+
+        auto previous = std::exchange(this->m_templateArguments, true);
+        auto expression = this->parseExpression();
+        this->m_templateArguments = previous;
+
+        if (!expression.has_value())
+            return std::unexpected(expression.error());
+
+        // Plain literals are passed on the way they were written
+        const auto &value = **expression;
+        switch (value.operation()) {
+            using enum ast::NodeExpression::Operation;
+            case StringLiteral:     return ast::TemplateValue { Token::Type::StringLiteral, std::string(value.value()) };
+            case CharacterLiteral:  return ast::TemplateValue { Token::Type::CharacterLiteral, std::string(value.value()) };
+            case NumericLiteral:    return ast::TemplateValue { Token::Type::NumericLiteral, std::string(value.value()) };
+            default:                break;
+        }
+
+        auto result = this->evaluate(value);
+        if (!result.has_value()) {
+            this->m_current = begin;
+            return std::unexpected(result.error());
+        }
+
+        // Too many template arguments, that's reported once all of them have been parsed
+        if (parameter == nullptr)
+            return ast::TemplateValue { Token::Type::NumericLiteral, "" };
+
+        // Everything else is computed and passed on as a literal of the parameter's type
+        if (parameter->type()->type()->kind() != ast::NodeKind::BuiltinType) {
+            this->m_current = begin;
+            return std::unexpected(ParseError::InvalidConstantExpression);
+        }
+
+        const auto &type = static_cast<const ast::NodeBuiltinType &>(*parameter->type()->type());
+        auto converted = evaluator::convert(*result, type);
+        if (std::holds_alternative<f64>(converted) && !std::isfinite(std::get<f64>(converted))) {
+            this->m_current = begin;
+            return std::unexpected(ParseError::InvalidConstantExpression);
+        }
+
+        return ast::TemplateValue { Token::Type::NumericLiteral, evaluator::formatValue(converted, type) };
+    }
+
+    auto Parser::parseSequence() -> ParseResult<ast::NodeExpression> {
+        // Like C's comma operator, every expression is evaluated in order and the last one is the value
+        std::vector<std::unique_ptr<ast::NodeExpression>> operands;
+        do {
+            auto expression = this->parseExpression();
+            if (!expression.has_value())
+                return expression;
+
+            operands.emplace_back(std::move(expression.value()));
+        } while (matchesSequence(SeparatorComma));
+
+        if (operands.size() == 1)
+            return std::move(operands.front());
+
+        return std::make_unique<ast::NodeExpression>(ast::NodeExpression::Operation::Sequence, ",", std::move(operands));
+    }
+
+    auto Parser::parseExpression() -> ParseResult<ast::NodeExpression> {
+        if (this->m_expressionDepth >= MaxExpressionDepth)
+            return std::unexpected(ParseError::InvalidConstantExpression);
+
+        this->m_expressionDepth += 1;
+
+        ParseResult<ast::NodeExpression> result;
+        if (matchesSequence(Identifier, OperatorLambda)) {
+            // Lambdas are only valid as arguments of builtin functions and as table generators, the evaluator checks that
+            auto parameter = this->getValue(-2);
+
+            auto body = this->parseExpression();
+            if (body.has_value()) {
+                std::vector<std::unique_ptr<ast::NodeExpression>> operands;
+                operands.emplace_back(std::move(body.value()));
+                result = std::make_unique<ast::NodeExpression>(ast::NodeExpression::Operation::Lambda, std::string(parameter), std::move(operands));
+            } else {
+                result = std::move(body);
+            }
+        } else {
+            result = this->parseTernary();
+
+            // Assignments have the lowest precedence and are right associative. Which targets can be assigned is checked with the types
+            if (result.has_value() && matchesSequence(OperatorAssign)) {
+                auto value = this->parseExpression();
+                if (value.has_value()) {
+                    std::vector<std::unique_ptr<ast::NodeExpression>> operands;
+                    operands.emplace_back(std::move(result.value()));
+                    operands.emplace_back(std::move(value.value()));
+                    result = std::make_unique<ast::NodeExpression>(ast::NodeExpression::Operation::Assignment, "=", std::move(operands));
+                } else {
+                    result = std::move(value);
+                }
+            }
+        }
+
+        this->m_expressionDepth -= 1;
+        return result;
+    }
+
+    auto Parser::parseTernary() -> ParseResult<ast::NodeExpression> {
+        auto condition = this->parseBinary(0);
+        if (!condition.has_value() || !matchesSequence(OperatorQuestionMark))
+            return condition;
+
+        auto trueExpression = this->parseExpression();
+        if (!trueExpression.has_value())
+            return trueExpression;
+
+        if (!matchesSequence(OperatorColon))
+            return std::unexpected(ParseError::UnexpectedToken);
+
+        auto falseExpression = this->parseExpression();
+        if (!falseExpression.has_value())
+            return falseExpression;
+
+        std::vector<std::unique_ptr<ast::NodeExpression>> operands;
+        operands.emplace_back(std::move(condition.value()));
+        operands.emplace_back(std::move(trueExpression.value()));
+        operands.emplace_back(std::move(falseExpression.value()));
+
+        return std::make_unique<ast::NodeExpression>(ast::NodeExpression::Operation::TernaryOperator, "?", std::move(operands));
+    }
+
+    auto Parser::parseBinary(u32 minPrecedence) -> ParseResult<ast::NodeExpression> {
+        // Same precedence as in C, higher binds tighter
+        constexpr static auto getPrecedence = [](std::string_view op) -> std::optional<u32> {
+            if (op == "||")                                         return 0;
+            if (op == "&&")                                         return 1;
+            if (op == "|")                                          return 2;
+            if (op == "^")                                          return 3;
+            if (op == "&")                                          return 4;
+            if (op == "==" || op == "!=")                           return 5;
+            if (op == "<" || op == ">" || op == "<=" || op == ">=") return 6;
+            if (op == "<<" || op == ">>")                           return 7;
+            if (op == "+" || op == "-")                             return 8;
+            if (op == "*" || op == "/" || op == "%")                return 9;
+
+            return std::nullopt;
+        };
+
+        auto left = this->parseUnary();
+        if (!left.has_value())
+            return left;
+
+        while (this->m_current != this->m_end && this->peek().type() == Token::Type::Operator) {
+            auto op = this->peek().value();
+
+            auto precedence = getPrecedence(op);
+            if (!precedence.has_value() || *precedence < minPrecedence)
+                break;
+
+            // The closing '>' of a template argument list
+            if (this->m_templateArguments && (op == ">" || op == ">>" || op == ">="))
+                break;
+
+            this->m_current++;
+
+            // All binary operators are left associative
+            auto right = this->parseBinary(*precedence + 1);
+            if (!right.has_value())
+                return right;
+
+            std::vector<std::unique_ptr<ast::NodeExpression>> operands;
+            operands.emplace_back(std::move(left.value()));
+            operands.emplace_back(std::move(right.value()));
+            left = std::make_unique<ast::NodeExpression>(ast::NodeExpression::Operation::BinaryOperator, std::string(op), std::move(operands));
+        }
+
+        return left;
+    }
+
+    auto Parser::parseUnary() -> ParseResult<ast::NodeExpression> {
+        if (this->m_current != this->m_end && this->peek().type() == Token::Type::Operator) {
+            auto op = this->peek().value();
+
+            if (op == "-" || op == "~" || op == "!") {
+                this->m_current++;
+
+                // "- - - x" nests just as deep as parentheses do
+                if (this->m_expressionDepth >= MaxExpressionDepth)
+                    return std::unexpected(ParseError::InvalidConstantExpression);
+
+                this->m_expressionDepth += 1;
+                auto operand = this->parseUnary();
+                this->m_expressionDepth -= 1;
+
+                if (!operand.has_value())
+                    return operand;
+
+                std::vector<std::unique_ptr<ast::NodeExpression>> operands;
+                operands.emplace_back(std::move(operand.value()));
+
+                return std::make_unique<ast::NodeExpression>(ast::NodeExpression::Operation::UnaryOperator, std::string(op), std::move(operands));
+            }
+        }
+
+        return this->parsePostfix();
+    }
+
+    auto Parser::parsePostfix() -> ParseResult<ast::NodeExpression> {
+        auto expression = this->parsePrimary();
+
+        while (expression.has_value()) {
+            std::vector<std::unique_ptr<ast::NodeExpression>> operands;
+
+            if (matchesSequence(SeparatorOpenBracket)) {
+                auto index = this->parseNested(SeparatorCloseBracket);
+                if (!index.has_value())
+                    return index;
+
+                operands.emplace_back(std::move(expression.value()));
+                operands.emplace_back(std::move(index.value()));
+                expression = std::make_unique<ast::NodeExpression>(ast::NodeExpression::Operation::Index, "[]", std::move(operands));
+            } else if (matchesSequence(OperatorDot, Identifier)) {
+                // Field of a register
+                operands.emplace_back(std::move(expression.value()));
+                expression = std::make_unique<ast::NodeExpression>(ast::NodeExpression::Operation::Field, std::string(this->getValue(-1)), std::move(operands));
+            } else {
+                break;
+            }
+        }
+
+        return expression;
+    }
+
+    auto Parser::parseNested(const lexer::Token &end) -> ParseResult<ast::NodeExpression> {
+        // Parentheses and brackets turn '>' back into a comparison inside template argument lists
+        auto previous = std::exchange(this->m_templateArguments, false);
+        auto expression = this->parseExpression();
+        this->m_templateArguments = previous;
+
+        if (expression.has_value() && !matchesSequence(end))
+            return std::unexpected(ParseError::UnexpectedToken);
+
+        return expression;
+    }
+
+    auto Parser::parsePrimary() -> ParseResult<ast::NodeExpression> {
+        using Operation = ast::NodeExpression::Operation;
+
+        if (matchesSequence(NumericLiteral))
+            return std::make_unique<ast::NodeExpression>(Operation::NumericLiteral, std::string(this->getValue(-1)));
+        if (matchesSequence(StringLiteral))
+            return std::make_unique<ast::NodeExpression>(Operation::StringLiteral, std::string(this->getValue(-1)));
+        if (matchesSequence(CharacterLiteral))
+            return std::make_unique<ast::NodeExpression>(Operation::CharacterLiteral, std::string(this->getValue(-1)));
+
+        if (matchesSequence(SeparatorOpenParenthesis))
+            return this->parseNested(SeparatorCloseParenthesis);
+
+        // Lists of expressions, used for array literals and function arguments
+        auto parseList = [this](const Token &end) -> std::expected<std::vector<std::unique_ptr<ast::NodeExpression>>, ParseError> {
+            std::vector<std::unique_ptr<ast::NodeExpression>> elements;
+            if (matchesSequence(end))
+                return elements;
+
+            while (true) {
+                auto previous = std::exchange(this->m_templateArguments, false);
+                auto element = this->parseExpression();
+                this->m_templateArguments = previous;
+
+                if (!element.has_value())
+                    return std::unexpected(element.error());
+
+                elements.emplace_back(std::move(element.value()));
+
+                if (matchesSequence(SeparatorComma))
+                    continue;
+                if (!matchesSequence(end))
+                    return std::unexpected(ParseError::UnexpectedToken);
+
+                return elements;
+            }
+        };
+
+        if (matchesSequence(SeparatorOpenBracket)) {
+            auto elements = parseList(SeparatorCloseBracket);
+            if (!elements.has_value())
+                return std::unexpected(elements.error());
+
+            return std::make_unique<ast::NodeExpression>(Operation::Array, "[]", std::move(elements.value()));
+        }
+
+        if (matchesSequence(Identifier)) {
+            auto name = std::string(this->getValue(-1));
+            while (matchesSequence(OperatorColon, OperatorColon, Identifier)) {
+                name += fmt::format("::{}", this->getValue(-1));
+            }
+
+            // Type arguments of a generic function call. A '<' followed by a type can't be a comparison
+            auto isTypeArgument = [this](const Token &token) {
+                return token.type() == Token::Type::BuiltinType || (token.type() == Token::Type::Identifier && this->isTypeParameter(token.value()));
+            };
+
+            std::vector<std::string> typeArguments;
+            if (this->m_end - this->m_current >= 2 && this->peek() == OperatorLessThan && isTypeArgument(this->m_current[1])) {
+                this->m_current++;
+
+                do {
+                    if (this->m_current == this->m_end || !isTypeArgument(this->peek()))
+                        return std::unexpected(ParseError::UnexpectedToken);
+                    if (this->peek().type() == Token::Type::BuiltinType && makeBuiltinType(this->peek().value()) == nullptr)
+                        return std::unexpected(ParseError::UnknownType);
+
+                    typeArguments.emplace_back(this->peek().value());
+                    this->m_current++;
+                } while (matchesSequence(SeparatorComma));
+
+                if (!matchesSequence(OperatorGreaterThan) || this->m_current == this->m_end || this->peek() != SeparatorOpenParenthesis)
+                    return std::unexpected(ParseError::UnexpectedToken);
+            }
+
+            if (matchesSequence(SeparatorOpenParenthesis)) {
+                auto arguments = parseList(SeparatorCloseParenthesis);
+                if (!arguments.has_value())
+                    return std::unexpected(arguments.error());
+
+                return std::make_unique<ast::NodeExpression>(Operation::Call, std::move(name), std::move(arguments.value()), std::move(typeArguments));
+            }
+
+            return std::make_unique<ast::NodeExpression>(Operation::Identifier, std::move(name));
+        }
+
+        return std::unexpected(ParseError::UnexpectedToken);
+    }
+
+    [[nodiscard]] auto Parser::parseNamespace() -> ASTGenerator {
+        bool usedNamespace = false;
+        if (matchesSequence(KeywordNamespace)) {
+            usedNamespace = true;
+
+            if (matchesSequence(Identifier, SeparatorOpenBrace)) {
+                auto namespaceName = this->getValue(-2);
+
+                this->m_namespaces.push_back(namespaceName);
+            } else {
+                co_yield std::unexpected(ParseError::UnexpectedToken);
+                co_return;
+            }
+        }
+
+        while (true) {
+            // Check if we have reached the end of the input
+            if (this->m_current == this->m_end || this->peek().type() == Token::Type::EndOfInput) {
+                co_return;
+            }
+
+            if (matchesSequence(KeywordDriver, Identifier)) {
+                co_yield parseDriver();
+            } else if (this->peek() == KeywordNamespace) {
+                co_yield hlp::elementsOf(parseNamespace());
+            } else if (this->peek() == SeparatorCloseBrace || this->peek().type() == Token::Type::EndOfInput) {
+                break;
+            } else {
+                co_yield std::unexpected(ParseError::UnexpectedToken);
+                co_return;
+            }
+        }
+
+        if (usedNamespace) {
+            if (!matchesSequence(SeparatorCloseBrace)) {
+                co_yield std::unexpected(ParseError::UnexpectedToken);
+                co_return;
+            }
+            this->m_namespaces.pop_back();
+        }
+    }
+
+    auto Parser::parse(const std::vector<lexer::Token> &tokens) -> ASTGenerator {
+        this->m_begin   = tokens.begin();
+        this->m_current = tokens.begin();
+        this->m_end     = tokens.end();
+
+        while (true) {
+            for (auto namespaceParser = parseNamespace(); namespaceParser;) {
+                auto node = namespaceParser();
+
+                if (!node.has_value()) {
+                    co_yield std::unexpected(node.error());
+                    co_return;
+                }
+
+                // Check if we have encountered an error
+                bool error = !node.has_value();
+
+                // Yield the node
+                co_yield std::move(node);
+
+                // If we have encountered an error, stop parsing
+                if (error) {
+                    co_return;
+                }
+            }
+
+            // Check if we have reached the end of the input
+            if (this->m_current == this->m_end || this->peek().type() == Token::Type::EndOfInput) {
+                co_return;
+            }
+
+            // The top level namespace only stops early at a closing brace that doesn't belong to anything
+            co_yield std::unexpected(ParseError::UnexpectedToken);
+            co_return;
         }
     }
 
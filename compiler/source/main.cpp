@@ -1,21 +1,221 @@
 #include <cstdlib>
 
+#include <compiler/helpers/fs.hpp>
+#include <compiler/helpers/profiler.hpp>
 #include <compiler/language/compiler.hpp>
 #include <compiler/visitors/visitor_ast_printer.hpp>
 #include <compiler/visitors/visitor_c_generator.hpp>
+#include <compiler/visitors/visitor_json_dump.hpp>
+#include <compiler/visitors/visitor_pipeline.hpp>
 
+#include <cxxopts.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <set>
 #include <thread>
-#include <chrono>
 
-auto main() -> int {
-    compiler::language::Compiler compiler("./specs/test.toml");
+namespace {
+
+    struct Job {
+        std::filesystem::path specsPath;
+
+        // Empty if the generated code should be printed to stdout
+        std::filesystem::path outputPath;
+        std::filesystem::path depfilePath;
+
+        // Empty if the AST shouldn't be dumped
+        std::filesystem::path astPath;
+        std::filesystem::path astJsonPath;
+
+        // Empty if the IR shouldn't be dumped
+        std::filesystem::path irPath;
+
+        bool streaming = false;
+    };
+
+    auto runJob(const Job &job, const std::shared_ptr<compiler::language::DriverCache> &driverCache, std::mutex &stdoutMutex) -> void {
+        compiler::language::Compiler compiler(job.specsPath, driverCache);
+
+        auto compile = [&](auto &visitor) {
+            if (job.streaming)
+                compiler.compileStreaming(visitor);
+            else
+                compiler.compile(visitor);
+        };
+
+        compiler::visitor::VisitorCGenerator visitor;
+        if (job.astPath.empty() && job.astJsonPath.empty()) {
+            compile(visitor);
+        } else {
+            // Dumps are rendered in the same traversal as the generated code
+            compiler::visitor::VisitorASTPrinter printer;
+            compiler::visitor::VisitorJsonDump jsonDump;
+            compiler::visitor::VisitorPipeline pipeline(visitor, printer, jsonDump);
+            compile(pipeline);
+
+            if (!job.astPath.empty())
+                compiler::hlp::writeFileIfChanged(job.astPath, printer.output());
+            if (!job.astJsonPath.empty())
+                compiler::hlp::writeFileIfChanged(job.astJsonPath, jsonDump.output());
+        }
+
+        if (!job.irPath.empty())
+            compiler::hlp::writeFileIfChanged(job.irPath, visitor.ir());
+
+        if (job.outputPath.empty()) {
+            std::scoped_lock lock(stdoutMutex);
+            fmt::print("{}\n", visitor.source());
+            return;
+        }
+
+        // Only touch the output if it changed, otherwise everything including it would be rebuilt
+        compiler::hlp::writeFileIfChanged(job.outputPath, visitor.source());
+
+        if (!job.depfilePath.empty()) {
+            compiler::hlp::writeDepfile(job.depfilePath, { job.outputPath }, compiler.specsFile().inputFiles());
+        }
+    }
+
+}
+
+auto main(int argc, char **argv) -> int {
+    cxxopts::Options options("compiler", "Driver Description Language compiler");
+    options.positional_help("<specs files...>");
+    options.add_options()
+        ("s,specs",         "Specs files to compile, one per board variant",            cxxopts::value<std::vector<std::string>>()->default_value("./specs/test.toml"))
+        ("o,output",        "Write the generated code to this file instead of stdout",  cxxopts::value<std::string>())
+        ("O,output-dir",    "Write the generated code of every specs file to <output-dir>/<specs name>.c", cxxopts::value<std::string>())
+        ("d,depfile",       "Write a Make / Ninja depfile listing all files that were read. Written next to every output when using --output-dir", cxxopts::value<std::string>()->implicit_value(""))
+        ("j,jobs",          "Number of specs files compiled in parallel",               cxxopts::value<size_t>()->default_value(std::to_string(std::max(1U, std::thread::hardware_concurrency()))))
+        ("streaming",       "Generate code for every driver right after compiling it and release its AST early. Lowers peak memory for large projects but bypasses the driver cache")
+        ("ast",             "Write a human readable dump of the AST to this file. Written as <specs name>.ast next to every output when using --output-dir", cxxopts::value<std::string>()->implicit_value(""))
+        ("ast-json",        "Write the AST as JSON to this file. Written as <specs name>.ast.json next to every output when using --output-dir", cxxopts::value<std::string>()->implicit_value(""))
+        ("ir",              "Write the optimized IR of every expression bodied function to this file. Written as <specs name>.ir next to every output when using --output-dir", cxxopts::value<std::string>()->implicit_value(""))
+        ("time-report",     "Print time, allocations and peak memory per compilation phase and driver")
+        ("trace",           "Write a Chrome trace event file of all compilation phases", cxxopts::value<std::string>())
+        ("h,help",          "Print this help");
+    options.parse_positional({ "specs" });
+
+    cxxopts::ParseResult arguments;
+    try {
+        arguments = options.parse(argc, argv);
+    } catch (const cxxopts::exceptions::exception &e) {
+        fmt::print(stderr, "{}\n", e.what());
+        return EXIT_FAILURE;
+    }
+
+    if (arguments.count("help")) {
+        fmt::print("{}\n", options.help());
+        return EXIT_SUCCESS;
+    }
+
+    auto specsPaths = arguments["specs"].as<std::vector<std::string>>();
+
+    // Build the list of specs files to compile and where their outputs go
+    std::vector<Job> jobs;
+    if (arguments.count("output-dir")) {
+        std::filesystem::path outputDirectory = arguments["output-dir"].as<std::string>();
+
+        std::set<std::filesystem::path> outputPaths;
+        for (const auto &specsPath : specsPaths) {
+            auto name = std::filesystem::path(specsPath).stem().string();
+
+            Job job = { .specsPath = specsPath, .outputPath = outputDirectory / (name + ".c") };
+            if (arguments.count("depfile"))
+                job.depfilePath = outputDirectory / (name + ".d");
+            if (arguments.count("ast"))
+                job.astPath = outputDirectory / (name + ".ast");
+            if (arguments.count("ast-json"))
+                job.astJsonPath = outputDirectory / (name + ".ast.json");
+            if (arguments.count("ir"))
+                job.irPath = outputDirectory / (name + ".ir");
+
+            if (!outputPaths.insert(job.outputPath).second) {
+                fmt::print(stderr, "Multiple specs files would generate \"{}\"\n", job.outputPath.string());
+                return EXIT_FAILURE;
+            }
+
+            jobs.push_back(std::move(job));
+        }
+    } else if (specsPaths.size() > 1) {
+        fmt::print(stderr, "Compiling multiple specs files requires an output directory\n");
+        return EXIT_FAILURE;
+    } else {
+        Job job = { .specsPath = specsPaths.front() };
+
+        if (arguments.count("output"))
+            job.outputPath = arguments["output"].as<std::string>();
+
+        if (arguments.count("depfile")) {
+            auto depfilePath = arguments["depfile"].as<std::string>();
+            if (job.outputPath.empty() || depfilePath.empty()) {
+                fmt::print(stderr, "A depfile can only be generated together with an output file\n");
+                return EXIT_FAILURE;
+            }
+
+            job.depfilePath = depfilePath;
+        }
+
+        for (auto [option, path] : { std::pair { "ast", &job.astPath }, std::pair { "ast-json", &job.astJsonPath }, std::pair { "ir", &job.irPath } }) {
+            if (!arguments.count(option))
+                continue;
+
+            auto dumpPath = arguments[option].as<std::string>();
+            if (dumpPath.empty()) {
+                fmt::print(stderr, "--{} requires a path unless an output directory is used\n", option);
+                return EXIT_FAILURE;
+            }
+
+            *path = dumpPath;
+        }
+
+        jobs.push_back(std::move(job));
+    }
+
+    for (auto &job : jobs)
+        job.streaming = arguments.count("streaming") > 0;
+
+    auto &profiler = compiler::hlp::Profiler::get();
+    profiler.setEnabled(arguments.count("time-report") || arguments.count("trace"));
+
+    // Drivers shared between specs files with identical configs are only lexed and parsed once
+    auto driverCache = std::make_shared<compiler::language::DriverCache>();
+
+    std::atomic<size_t> nextJob = 0;
+    std::atomic<bool> failed = false;
+    std::mutex stdoutMutex;
+
+    auto worker = [&] {
+        for (auto index = nextJob++; index < jobs.size(); index = nextJob++) {
+            try {
+                runJob(jobs[index], driverCache, stdoutMutex);
+            } catch (const std::exception &e) {
+                std::scoped_lock lock(stdoutMutex);
+                fmt::print(stderr, "{}: {}\n", jobs[index].specsPath.string(), e.what());
+
+                failed = true;
+            }
+        }
+    };
+
+    auto threadCount = std::clamp<size_t>(arguments["jobs"].as<size_t>(), 1, jobs.size());
+    {
+        std::vector<std::jthread> threads;
+        for (size_t i = 1; i < threadCount; i++)
+            threads.emplace_back(worker);
 
-    compiler::visitor::VisitorCGenerator visitor;
-    compiler.compile(visitor);
+        worker();
+    }
 
-    fmt::print("{}\n", visitor.source());
+    if (arguments.count("time-report")) {
+        fmt::print(stderr, "{}", profiler.timeReport());
+        fmt::print(stderr, "Driver cache: {} hits, {} misses\n", driverCache->hits(), driverCache->misses());
+    }
 
-    getchar();
+    if (arguments.count("trace")) {
+        compiler::hlp::writeFileIfChanged(arguments["trace"].as<std::string>(), profiler.traceEvents());
+    }
 
-    return EXIT_SUCCESS;
-}
\ No newline at end of file
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -1,4 +1,5 @@
 #include <compiler/specs/specs_file.hpp>
+#include <compiler/helpers/profiler.hpp>
 
 #include <toml++/toml.h>
 
@@ -7,7 +8,10 @@
 namespace compiler::specs {
     
     SpecsFile::SpecsFile(const std::filesystem::path &specsFilePath) {
+        hlp::ScopedPhase phase("specs");
+
         auto specs = toml::parse_file(specsFilePath.u8string());
+        this->m_inputFiles.push_back(specsFilePath);
 
         // Loop over the entire specs file, looking for driver definitions
         for (auto &&[driverName, driverContent] : specs) {
@@ -42,6 +46,9 @@ namespace compiler::specs {
 
                 // Read the driver code from the file
                 driver.code = file.readString();
+                driver.path = path;
+
+                this->m_inputFiles.push_back(std::move(path));
             }
 
             // Read the "config" object from the driver table
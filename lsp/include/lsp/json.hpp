@@ -0,0 +1,63 @@
+#pragma once
+
+#include <compiler/types.hpp>
+
+#include <concepts>
+#include <map>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace lsp::json {
+
+    // Minimal JSON document model, just enough for the messages of the language server protocol
+    class Value {
+    public:
+        using Array  = std::vector<Value>;
+        using Object = std::map<std::string, Value, std::less<>>;
+
+        Value() = default;
+        Value(std::nullptr_t) { }
+        Value(bool value) : m_value(value) { }
+        Value(double value) : m_value(value) { }
+        Value(std::integral auto value) requires (!std::same_as<decltype(value), bool>) : m_value(double(value)) { }
+        Value(std::string value) : m_value(std::move(value)) { }
+        Value(std::string_view value) : m_value(std::string(value)) { }
+        Value(const char *value) : m_value(std::string(value)) { }
+        Value(Array value) : m_value(std::move(value)) { }
+        Value(Object value) : m_value(std::move(value)) { }
+
+        [[nodiscard]] auto isNull() const -> bool   { return std::holds_alternative<std::nullptr_t>(this->m_value); }
+        [[nodiscard]] auto isBool() const -> bool   { return std::holds_alternative<bool>(this->m_value); }
+        [[nodiscard]] auto isNumber() const -> bool { return std::holds_alternative<double>(this->m_value); }
+        [[nodiscard]] auto isString() const -> bool { return std::holds_alternative<std::string>(this->m_value); }
+        [[nodiscard]] auto isArray() const -> bool  { return std::holds_alternative<Array>(this->m_value); }
+        [[nodiscard]] auto isObject() const -> bool { return std::holds_alternative<Object>(this->m_value); }
+
+        // Accessors throw a std::runtime_error if the value has a different type
+        [[nodiscard]] auto asBool() const -> bool;
+        [[nodiscard]] auto asNumber() const -> double;
+        [[nodiscard]] auto asString() const -> const std::string &;
+        [[nodiscard]] auto asArray() const -> const Array &;
+        [[nodiscard]] auto asObject() const -> const Object &;
+
+        // Returns null for missing members so optional members can be queried without checks
+        [[nodiscard]] auto operator[](std::string_view key) const -> const Value &;
+
+        // Turns the value into an object if it's null and inserts the member if it doesn't exist yet
+        auto operator[](std::string_view key) -> Value &;
+
+        [[nodiscard]] auto contains(std::string_view key) const -> bool;
+
+        [[nodiscard]] auto dump() const -> std::string;
+        [[nodiscard]] static auto parse(std::string_view string) -> Value;
+
+    private:
+        auto dump(std::string &result) const -> void;
+
+    private:
+        std::variant<std::nullptr_t, bool, double, std::string, Array, Object> m_value;
+    };
+
+}
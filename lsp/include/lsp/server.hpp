@@ -0,0 +1,74 @@
+#pragma once
+
+#include <lsp/json.hpp>
+
+#include <compiler/language/incremental.hpp>
+
+#include <filesystem>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace lsp {
+
+    // Language server speaking JSON-RPC over a pair of streams, usually stdin and stdout.
+    // Driver files listed in the specs file are kept parsed together with their dependencies so
+    // diagnostics and definitions see the same drivers the compiler would
+    class Server {
+    public:
+        explicit Server(std::optional<std::filesystem::path> specsPath = std::nullopt, bool verbose = false)
+            : m_specsPath(std::move(specsPath)), m_verbose(verbose) { }
+
+        // Serves messages until the client sends exit. Returns the exit code of the server
+        auto run(std::istream &input, std::ostream &output) -> int;
+
+    private:
+        struct Document {
+            std::string uri;
+            std::filesystem::path path;
+            std::vector<std::string> dependencies;
+            std::unique_ptr<compiler::language::IncrementalDocument> document;
+        };
+
+        struct ResponseError {
+            compiler::i32 code;
+            std::string message;
+        };
+
+        auto handleMessage(const json::Value &message) -> void;
+        auto handleRequest(std::string_view method, const json::Value &params) -> json::Value;
+        auto handleNotification(std::string_view method, const json::Value &params) -> void;
+
+        auto initialize(const json::Value &params) -> json::Value;
+        auto definition(const json::Value &params) -> json::Value;
+        auto changeDocument(const std::string &uri, std::string text) -> void;
+        auto closeDocument(const std::string &uri) -> void;
+
+        auto loadSpecs(const std::filesystem::path &path) -> void;
+        auto updateDocument(const std::string &name, std::string text) -> void;
+        auto publishDiagnostics(const Document &document) -> void;
+
+        [[nodiscard]] auto findDocument(const std::string &uri) -> std::pair<const std::string, Document> *;
+
+        auto send(const json::Value &message) -> void;
+        auto log(std::string_view message) -> void;
+
+    private:
+        std::optional<std::filesystem::path> m_specsPath;
+        bool m_verbose;
+
+        std::ostream *m_output = nullptr;
+        bool m_initialized = false, m_shutdown = false, m_exit = false;
+
+        // Documents by the name of their driver in the specs file. Files that aren't part of it are stored by their uri
+        std::map<std::string, Document> m_documents;
+
+        // Names of the documents from the specs file, dependencies come before the drivers depending on them
+        std::vector<std::string> m_order;
+    };
+
+}
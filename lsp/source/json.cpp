@@ -0,0 +1,347 @@
+#include <lsp/json.hpp>
+
+#include <compiler/helpers/json.hpp>
+
+#include <cmath>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+namespace lsp::json {
+    using namespace compiler;
+
+    namespace {
+
+        class Parser {
+        public:
+            explicit Parser(std::string_view string) : m_string(string) { }
+
+            auto parseDocument() -> Value {
+                auto value = this->parseValue();
+
+                this->skipWhitespace();
+                if (this->m_offset != this->m_string.size())
+                    this->error("trailing characters");
+
+                return value;
+            }
+
+        private:
+            [[noreturn]] auto error(std::string_view message) const -> void {
+                throw std::runtime_error(fmt::format("JSON Error: {} at offset {}", message, this->m_offset));
+            }
+
+            auto skipWhitespace() -> void {
+                while (this->m_offset < this->m_string.size() && std::isspace(static_cast<unsigned char>(this->m_string[this->m_offset])))
+                    this->m_offset += 1;
+            }
+
+            auto peek() const -> char {
+                return this->m_offset < this->m_string.size() ? this->m_string[this->m_offset] : '\0';
+            }
+
+            auto consume(std::string_view expected) -> bool {
+                if (!this->m_string.substr(this->m_offset).starts_with(expected))
+                    return false;
+
+                this->m_offset += expected.size();
+                return true;
+            }
+
+            auto parseValue() -> Value {
+                // Keeps malicious input from overflowing the stack
+                if (this->m_depth > 256)
+                    this->error("nesting too deep");
+
+                this->skipWhitespace();
+
+                switch (this->peek()) {
+                    case '{': return this->parseObject();
+                    case '[': return this->parseArray();
+                    case '"': return this->parseString();
+                    default:
+                        if (this->consume("null"))  return nullptr;
+                        if (this->consume("true"))  return true;
+                        if (this->consume("false")) return false;
+
+                        return this->parseNumber();
+                }
+            }
+
+            auto parseObject() -> Value {
+                this->m_depth += 1;
+                this->m_offset += 1;
+
+                Value::Object object;
+
+                this->skipWhitespace();
+                if (!this->consume("}")) {
+                    while (true) {
+                        this->skipWhitespace();
+                        if (this->peek() != '"')
+                            this->error("expected member name");
+
+                        auto key = this->parseString().asString();
+
+                        this->skipWhitespace();
+                        if (!this->consume(":"))
+                            this->error("expected ':'");
+
+                        object.insert_or_assign(std::move(key), this->parseValue());
+
+                        this->skipWhitespace();
+                        if (this->consume("}"))
+                            break;
+                        if (!this->consume(","))
+                            this->error("expected ',' or '}'");
+                    }
+                }
+
+                this->m_depth -= 1;
+                return object;
+            }
+
+            auto parseArray() -> Value {
+                this->m_depth += 1;
+                this->m_offset += 1;
+
+                Value::Array array;
+
+                this->skipWhitespace();
+                if (!this->consume("]")) {
+                    while (true) {
+                        array.push_back(this->parseValue());
+
+                        this->skipWhitespace();
+                        if (this->consume("]"))
+                            break;
+                        if (!this->consume(","))
+                            this->error("expected ',' or ']'");
+                    }
+                }
+
+                this->m_depth -= 1;
+                return array;
+            }
+
+            auto parseHexQuad() -> u32 {
+                if (this->m_offset + 4 > this->m_string.size())
+                    this->error("invalid unicode escape");
+
+                u32 value = 0;
+                for (size_t i = 0; i < 4; i++) {
+                    char c = this->m_string[this->m_offset++];
+                    value <<= 4;
+
+                    if (c >= '0' && c <= '9')      value |= c - '0';
+                    else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+                    else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+                    else this->error("invalid unicode escape");
+                }
+
+                return value;
+            }
+
+            static auto appendUtf8(std::string &result, u32 codepoint) -> void {
+                if (codepoint < 0x80) {
+                    result += char(codepoint);
+                } else if (codepoint < 0x800) {
+                    result += char(0xC0 | (codepoint >> 6));
+                    result += char(0x80 | (codepoint & 0x3F));
+                } else if (codepoint < 0x10000) {
+                    result += char(0xE0 | (codepoint >> 12));
+                    result += char(0x80 | ((codepoint >> 6) & 0x3F));
+                    result += char(0x80 | (codepoint & 0x3F));
+                } else {
+                    result += char(0xF0 | (codepoint >> 18));
+                    result += char(0x80 | ((codepoint >> 12) & 0x3F));
+                    result += char(0x80 | ((codepoint >> 6) & 0x3F));
+                    result += char(0x80 | (codepoint & 0x3F));
+                }
+            }
+
+            auto parseString() -> Value {
+                this->m_offset += 1;
+
+                std::string result;
+                while (true) {
+                    if (this->m_offset >= this->m_string.size())
+                        this->error("unterminated string");
+
+                    char c = this->m_string[this->m_offset++];
+                    if (c == '"')
+                        break;
+
+                    if (c != '\\') {
+                        result += c;
+                        continue;
+                    }
+
+                    if (this->m_offset >= this->m_string.size())
+                        this->error("unterminated string");
+
+                    switch (this->m_string[this->m_offset++]) {
+                        case '"':  result += '"';  break;
+                        case '\\': result += '\\'; break;
+                        case '/':  result += '/';  break;
+                        case 'b':  result += '\b'; break;
+                        case 'f':  result += '\f'; break;
+                        case 'n':  result += '\n'; break;
+                        case 'r':  result += '\r'; break;
+                        case 't':  result += '\t'; break;
+                        case 'u': {
+                            auto codepoint = this->parseHexQuad();
+
+                            // Characters outside of the basic multilingual plane are encoded as surrogate pairs
+                            if (codepoint >= 0xD800 && codepoint <= 0xDBFF && this->consume("\\u")) {
+                                auto low = this->parseHexQuad();
+                                codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                            }
+
+                            appendUtf8(result, codepoint);
+                            break;
+                        }
+                        default:
+                            this->error("invalid escape sequence");
+                    }
+                }
+
+                return result;
+            }
+
+            auto parseNumber() -> Value {
+                const auto begin = this->m_offset;
+                while (this->m_offset < this->m_string.size() && std::string_view("+-0123456789.eE").contains(this->m_string[this->m_offset]))
+                    this->m_offset += 1;
+
+                if (begin == this->m_offset)
+                    this->error("unexpected character");
+
+                try {
+                    return std::stod(std::string(this->m_string.substr(begin, this->m_offset - begin)));
+                } catch (const std::exception &) {
+                    this->error("invalid number");
+                }
+            }
+
+        private:
+            std::string_view m_string;
+            size_t m_offset = 0;
+            size_t m_depth = 0;
+        };
+
+    }
+
+    auto Value::asBool() const -> bool {
+        if (!this->isBool())
+            throw std::runtime_error("JSON Error: expected a boolean");
+
+        return std::get<bool>(this->m_value);
+    }
+
+    auto Value::asNumber() const -> double {
+        if (!this->isNumber())
+            throw std::runtime_error("JSON Error: expected a number");
+
+        return std::get<double>(this->m_value);
+    }
+
+    auto Value::asString() const -> const std::string & {
+        if (!this->isString())
+            throw std::runtime_error("JSON Error: expected a string");
+
+        return std::get<std::string>(this->m_value);
+    }
+
+    auto Value::asArray() const -> const Array & {
+        if (!this->isArray())
+            throw std::runtime_error("JSON Error: expected an array");
+
+        return std::get<Array>(this->m_value);
+    }
+
+    auto Value::asObject() const -> const Object & {
+        if (!this->isObject())
+            throw std::runtime_error("JSON Error: expected an object");
+
+        return std::get<Object>(this->m_value);
+    }
+
+    auto Value::operator[](std::string_view key) const -> const Value & {
+        static const Value Null;
+
+        if (!this->isObject())
+            return Null;
+
+        const auto &object = std::get<Object>(this->m_value);
+        if (auto it = object.find(key); it != object.end())
+            return it->second;
+        else
+            return Null;
+    }
+
+    auto Value::operator[](std::string_view key) -> Value & {
+        if (this->isNull())
+            this->m_value = Object();
+
+        auto &object = std::get<Object>(this->m_value);
+        if (auto it = object.find(key); it != object.end())
+            return it->second;
+        else
+            return object.emplace(std::string(key), nullptr).first->second;
+    }
+
+    auto Value::contains(std::string_view key) const -> bool {
+        return this->isObject() && std::get<Object>(this->m_value).contains(key);
+    }
+
+    auto Value::dump(std::string &result) const -> void {
+        std::visit([&result]<typename T>(const T &value) {
+            if constexpr (std::same_as<T, std::nullptr_t>) {
+                result += "null";
+            } else if constexpr (std::same_as<T, bool>) {
+                result += value ? "true" : "false";
+            } else if constexpr (std::same_as<T, double>) {
+                // Request ids and positions are integers, don't print them with a fractional part
+                if (std::trunc(value) == value && std::abs(value) < 9007199254740992.0)
+                    result += fmt::format("{}", i64(value));
+                else
+                    result += fmt::format("{}", value);
+            } else if constexpr (std::same_as<T, std::string>) {
+                result += fmt::format("\"{}\"", compiler::hlp::escapeJson(value));
+            } else if constexpr (std::same_as<T, Array>) {
+                result += '[';
+                for (size_t i = 0; i < value.size(); i++) {
+                    if (i != 0)
+                        result += ',';
+                    value[i].dump(result);
+                }
+                result += ']';
+            } else if constexpr (std::same_as<T, Object>) {
+                result += '{';
+                bool first = true;
+                for (const auto &[key, member] : value) {
+                    if (!first)
+                        result += ',';
+                    first = false;
+
+                    result += fmt::format("\"{}\":", compiler::hlp::escapeJson(key));
+                    member.dump(result);
+                }
+                result += '}';
+            }
+        }, this->m_value);
+    }
+
+    auto Value::dump() const -> std::string {
+        std::string result;
+        this->dump(result);
+
+        return result;
+    }
+
+    auto Value::parse(std::string_view string) -> Value {
+        return Parser(string).parseDocument();
+    }
+
+}
@@ -0,0 +1,38 @@
+#include <cstdlib>
+#include <iostream>
+
+#include <lsp/server.hpp>
+
+#include <cxxopts.hpp>
+#include <fmt/format.h>
+
+auto main(int argc, char **argv) -> int {
+    cxxopts::Options options("ddl_lsp", "Driver Description Language language server, speaks the language server protocol over stdin / stdout");
+    options.add_options()
+        ("s,specs",     "Specs file listing the drivers of the project. Can also be passed as the \"specs\" initialization option", cxxopts::value<std::string>())
+        ("v,verbose",   "Log document updates and how long they took to stderr")
+        ("h,help",      "Print this help");
+
+    cxxopts::ParseResult arguments;
+    try {
+        arguments = options.parse(argc, argv);
+    } catch (const cxxopts::exceptions::exception &e) {
+        fmt::print(stderr, "{}\n", e.what());
+        return EXIT_FAILURE;
+    }
+
+    if (arguments.count("help")) {
+        fmt::print("{}\n", options.help());
+        return EXIT_SUCCESS;
+    }
+
+    std::optional<std::filesystem::path> specsPath;
+    if (arguments.count("specs"))
+        specsPath = arguments["specs"].as<std::string>();
+
+    // Stdout is reserved for protocol messages
+    std::ios::sync_with_stdio(false);
+
+    lsp::Server server(specsPath, arguments.count("verbose") > 0);
+    return server.run(std::cin, std::cout);
+}
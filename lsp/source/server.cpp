@@ -0,0 +1,466 @@
+#include <lsp/server.hpp>
+
+#include <compiler/specs/specs_file.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+
+#include <fmt/format.h>
+
+namespace lsp {
+
+    using namespace compiler;
+    using namespace compiler::language;
+
+    namespace {
+
+        // Error codes defined by JSON-RPC and the language server protocol
+        constexpr i32 ParseError           = -32700;
+        constexpr i32 InvalidRequest       = -32600;
+        constexpr i32 MethodNotFound       = -32601;
+        constexpr i32 InternalError        = -32603;
+        constexpr i32 ServerNotInitialized = -32002;
+
+        auto readMessage(std::istream &input) -> std::optional<std::string> {
+            // Read the header, only Content-Length is of interest
+            std::optional<size_t> contentLength;
+            std::string line;
+            while (std::getline(input, line)) {
+                if (line.ends_with('\r'))
+                    line.pop_back();
+
+                if (line.empty())
+                    break;
+
+                constexpr static std::string_view Header = "Content-Length:";
+                if (line.starts_with(Header))
+                    contentLength = std::stoull(line.substr(Header.size()));
+            }
+
+            if (!input || !contentLength.has_value())
+                return std::nullopt;
+
+            std::string content(*contentLength, '\0');
+            if (!input.read(content.data(), std::streamsize(content.size())))
+                return std::nullopt;
+
+            return content;
+        }
+
+        // Positions in the protocol are lines and UTF-16 code units
+        auto toPosition(std::string_view text, size_t offset) -> json::Value {
+            offset = std::min(offset, text.size());
+
+            size_t line = 0, character = 0;
+            for (size_t i = 0; i < offset; i++) {
+                auto c = static_cast<unsigned char>(text[i]);
+
+                if (c == '\n') {
+                    line += 1;
+                    character = 0;
+                } else if ((c & 0xC0) != 0x80) {
+                    // Characters outside of the basic multilingual plane take up two code units
+                    character += c >= 0xF0 ? 2 : 1;
+                }
+            }
+
+            return json::Value::Object { { "line", line }, { "character", character } };
+        }
+
+        auto toOffset(std::string_view text, const json::Value &position) -> size_t {
+            auto line      = size_t(position["line"].asNumber());
+            auto character = size_t(position["character"].asNumber());
+
+            size_t offset = 0;
+            for (; line > 0 && offset < text.size(); offset++) {
+                if (text[offset] == '\n')
+                    line -= 1;
+            }
+
+            while (character > 0 && offset < text.size() && text[offset] != '\n') {
+                auto c = static_cast<unsigned char>(text[offset]);
+                character -= std::min<size_t>(character, c >= 0xF0 ? 2 : 1);
+
+                // Skip the continuation bytes of the character
+                offset += 1;
+                while (offset < text.size() && (static_cast<unsigned char>(text[offset]) & 0xC0) == 0x80)
+                    offset += 1;
+            }
+
+            return offset;
+        }
+
+        auto toRange(std::string_view text, size_t offset, size_t length) -> json::Value {
+            return json::Value::Object { { "start", toPosition(text, offset) }, { "end", toPosition(text, offset + length) } };
+        }
+
+        auto uriToPath(std::string_view uri) -> std::filesystem::path {
+            constexpr static std::string_view Scheme = "file://";
+            if (!uri.starts_with(Scheme))
+                return { };
+
+            uri.remove_prefix(Scheme.size());
+
+            std::string path;
+            for (size_t i = 0; i < uri.size(); i++) {
+                if (uri[i] == '%' && i + 2 < uri.size()) {
+                    path += char(std::stoi(std::string(uri.substr(i + 1, 2)), nullptr, 16));
+                    i += 2;
+                } else {
+                    path += uri[i];
+                }
+            }
+
+            // Windows paths are sent as file:///C:/...
+            if (path.size() > 2 && path[0] == '/' && path[2] == ':')
+                path.erase(0, 1);
+
+            return std::filesystem::path(path);
+        }
+
+        auto pathToUri(const std::filesystem::path &path) -> std::string {
+            auto string = std::filesystem::absolute(path).generic_string();
+
+            std::string uri = string.starts_with('/') ? "file://" : "file:///";
+            for (char c : string) {
+                if (std::isalnum(static_cast<unsigned char>(c)) || std::string_view("/-._~:").contains(c))
+                    uri += c;
+                else
+                    uri += fmt::format("%{:02X}", static_cast<unsigned char>(c));
+            }
+
+            return uri;
+        }
+
+        auto isSamePath(const std::filesystem::path &a, const std::filesystem::path &b) -> bool {
+            std::error_code error;
+            return std::filesystem::weakly_canonical(a, error) == std::filesystem::weakly_canonical(b, error);
+        }
+
+    }
+
+    auto Server::send(const json::Value &message) -> void {
+        auto content = message.dump();
+
+        *this->m_output << fmt::format("Content-Length: {}\r\n\r\n", content.size()) << content;
+        this->m_output->flush();
+    }
+
+    auto Server::log(std::string_view message) -> void {
+        if (this->m_verbose)
+            std::cerr << fmt::format("[ddl_lsp] {}\n", message);
+    }
+
+    auto Server::findDocument(const std::string &uri) -> std::pair<const std::string, Document> * {
+        if (auto it = this->m_documents.find(uri); it != this->m_documents.end())
+            return &*it;
+
+        auto path = uriToPath(uri);
+        for (auto &entry : this->m_documents) {
+            if (!entry.second.path.empty() && isSamePath(entry.second.path, path))
+                return &entry;
+        }
+
+        return nullptr;
+    }
+
+    auto Server::loadSpecs(const std::filesystem::path &path) -> void {
+        auto specsFile = specs::SpecsFile(path);
+
+        // Order the drivers so dependencies are always updated before the drivers using them
+        std::vector<std::string> order;
+        std::set<std::string> visited, inProgress;
+        std::function<void(const std::string &)> visit = [&](const std::string &name) {
+            if (visited.contains(name))
+                return;
+            if (!inProgress.insert(name).second)
+                throw std::runtime_error(fmt::format("Circular dependency on driver \"{}\"", name));
+
+            auto it = specsFile.drivers().find(name);
+            if (it == specsFile.drivers().end())
+                throw std::runtime_error(fmt::format("Dependency \"{}\" does not exist", name));
+
+            for (const auto &dependency : it->second.dependencies)
+                visit(dependency);
+
+            inProgress.erase(name);
+            visited.insert(name);
+            order.push_back(name);
+        };
+
+        for (const auto &[name, driver] : specsFile.drivers())
+            visit(name);
+
+        this->m_documents.clear();
+        for (const auto &name : order) {
+            const auto &driver = specsFile.drivers().at(name);
+
+            auto &document = this->m_documents[name];
+            document.uri          = pathToUri(driver.path);
+            document.path         = driver.path;
+            document.dependencies = driver.dependencies;
+            document.document     = std::make_unique<IncrementalDocument>(name, driver.config);
+        }
+
+        this->m_order = std::move(order);
+        for (const auto &name : this->m_order)
+            this->updateDocument(name, specsFile.drivers().at(name).code);
+
+        this->log(fmt::format("Loaded {} drivers from {}", this->m_order.size(), path.string()));
+    }
+
+    auto Server::updateDocument(const std::string &name, std::string text) -> void {
+        auto &[uri, path, dependencies, document] = this->m_documents.at(name);
+
+        // Like the compiler, a driver only sees the drivers of its direct dependencies
+        SymbolTable external;
+        for (const auto &dependency : dependencies) {
+            const auto &exports = this->m_documents.at(dependency).document->exports();
+            external.insert(exports.begin(), exports.end());
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        document->update(std::move(text), external);
+        auto duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+        this->log(fmt::format("Updated {} in {:.3f}ms ({} declarations reused, {} parsed)", name, duration.count(), document->reused(), document->reparsed()));
+    }
+
+    auto Server::publishDiagnostics(const Document &document) -> void {
+        const auto &text = document.document->text();
+
+        json::Value::Array diagnostics;
+        for (const auto &diagnostic : document.document->diagnostics()) {
+            diagnostics.push_back(json::Value::Object {
+                { "range",    toRange(text, diagnostic.offset, diagnostic.length) },
+                { "severity", 1 },
+                { "source",   "ddl" },
+                { "message",  diagnostic.message }
+            });
+        }
+
+        this->send(json::Value::Object {
+            { "jsonrpc", "2.0" },
+            { "method",  "textDocument/publishDiagnostics" },
+            { "params",  json::Value::Object { { "uri", document.uri }, { "diagnostics", std::move(diagnostics) } } }
+        });
+    }
+
+    auto Server::changeDocument(const std::string &uri, std::string text) -> void {
+        auto entry = this->findDocument(uri);
+
+        // Files that aren't part of the specs file are parsed on their own
+        if (entry == nullptr) {
+            auto &document = this->m_documents[uri];
+            document.uri      = uri;
+            document.document = std::make_unique<IncrementalDocument>(uri);
+
+            this->updateDocument(uri, std::move(text));
+            this->publishDiagnostics(document);
+            return;
+        }
+
+        auto &[name, document] = *entry;
+        document.uri = uri;
+
+        if (document.document->text() == text) {
+            this->publishDiagnostics(document);
+            return;
+        }
+
+        this->updateDocument(name, std::move(text));
+        this->publishDiagnostics(document);
+
+        // Drivers depending on the changed one may now fail or succeed to instantiate it.
+        // Their declarations that don't use the changed drivers are reused
+        std::set<std::string> changed = { name };
+        for (const auto &dependent : this->m_order) {
+            auto &other = this->m_documents.at(dependent);
+            if (!std::ranges::any_of(other.dependencies, [&](const auto &dependency) { return changed.contains(dependency); }))
+                continue;
+
+            this->updateDocument(dependent, other.document->text());
+            this->publishDiagnostics(other);
+            changed.insert(dependent);
+        }
+    }
+
+    auto Server::closeDocument(const std::string &uri) -> void {
+        auto entry = this->findDocument(uri);
+        if (entry == nullptr)
+            return;
+
+        auto &[name, document] = *entry;
+
+        if (document.path.empty()) {
+            // Clear the diagnostics of files that aren't part of the specs file, nothing refers to them anymore
+            this->send(json::Value::Object {
+                { "jsonrpc", "2.0" },
+                { "method",  "textDocument/publishDiagnostics" },
+                { "params",  json::Value::Object { { "uri", document.uri }, { "diagnostics", json::Value::Array() } } }
+            });
+
+            this->m_documents.erase(name);
+        } else {
+            // Unsaved changes are discarded, go back to what the compiler would see
+            std::ifstream file(document.path, std::ios::binary);
+            this->changeDocument(uri, std::string(std::istreambuf_iterator<char>(file), { }));
+        }
+    }
+
+    auto Server::initialize(const json::Value &params) -> json::Value {
+        if (!this->m_specsPath.has_value()) {
+            if (const auto &specs = params["initializationOptions"]["specs"]; specs.isString()) {
+                this->m_specsPath = specs.asString();
+
+                // Relative paths in the specs file are relative to the project's root, just like when running the compiler there
+                if (const auto &rootUri = params["rootUri"]; rootUri.isString()) {
+                    std::error_code error;
+                    std::filesystem::current_path(uriToPath(rootUri.asString()), error);
+                }
+            }
+        }
+
+        if (this->m_specsPath.has_value()) {
+            try {
+                this->loadSpecs(*this->m_specsPath);
+            } catch (const std::exception &e) {
+                this->send(json::Value::Object {
+                    { "jsonrpc", "2.0" },
+                    { "method",  "window/showMessage" },
+                    { "params",  json::Value::Object { { "type", 1 }, { "message", fmt::format("Failed to load specs file: {}", e.what()) } } }
+                });
+            }
+        }
+
+        return json::Value::Object {
+            { "capabilities", json::Value::Object {
+                { "textDocumentSync", json::Value::Object {
+                    { "openClose", true },
+                    { "change",    1 },
+                    { "save",      false }
+                } },
+                { "definitionProvider", true }
+            } },
+            { "serverInfo", json::Value::Object { { "name", "ddl_lsp" } } }
+        };
+    }
+
+    auto Server::definition(const json::Value &params) -> json::Value {
+        auto entry = this->findDocument(params["textDocument"]["uri"].asString());
+        if (entry == nullptr)
+            return nullptr;
+
+        const auto &document = *entry->second.document;
+        auto symbol = document.findDefinition(toOffset(document.text(), params["position"]));
+        if (!symbol.has_value())
+            return nullptr;
+
+        auto target = this->m_documents.find(symbol->document);
+        if (target == this->m_documents.end())
+            return nullptr;
+
+        return json::Value::Object {
+            { "uri",   target->second.uri },
+            { "range", toRange(target->second.document->text(), symbol->offset, symbol->length) }
+        };
+    }
+
+    auto Server::handleRequest(std::string_view method, const json::Value &params) -> json::Value {
+        if (method == "initialize")
+            return this->initialize(params);
+        else if (method == "shutdown") {
+            this->m_shutdown = true;
+            return nullptr;
+        } else if (method == "textDocument/definition")
+            return this->definition(params);
+        else
+            throw ResponseError { MethodNotFound, fmt::format("Unknown method \"{}\"", method) };
+    }
+
+    auto Server::handleNotification(std::string_view method, const json::Value &params) -> void {
+        if (method == "exit") {
+            this->m_exit = true;
+        } else if (method == "textDocument/didOpen") {
+            const auto &textDocument = params["textDocument"];
+            this->changeDocument(textDocument["uri"].asString(), textDocument["text"].asString());
+        } else if (method == "textDocument/didChange") {
+            // Only full document synchronization is supported, the last change contains the entire text
+            const auto &changes = params["contentChanges"].asArray();
+            if (!changes.empty())
+                this->changeDocument(params["textDocument"]["uri"].asString(), changes.back()["text"].asString());
+        } else if (method == "textDocument/didClose") {
+            this->closeDocument(params["textDocument"]["uri"].asString());
+        }
+
+        // All other notifications, including initialized, need no handling
+    }
+
+    auto Server::handleMessage(const json::Value &message) -> void {
+        const auto &id     = message["id"];
+        const auto &method = message["method"];
+
+        // Responses to requests sent by the server aren't used
+        if (!method.isString())
+            return;
+
+        if (!message.contains("id")) {
+            try {
+                this->handleNotification(method.asString(), message["params"]);
+            } catch (const std::exception &e) {
+                this->log(fmt::format("Failed to handle {}: {}", method.asString(), e.what()));
+            }
+
+            return;
+        }
+
+        json::Value response = json::Value::Object { { "jsonrpc", "2.0" }, { "id", id } };
+        try {
+            if (!this->m_initialized && method.asString() != "initialize")
+                throw ResponseError { ServerNotInitialized, "Server has not been initialized" };
+            if (this->m_shutdown)
+                throw ResponseError { InvalidRequest, "Server is shutting down" };
+
+            response["result"] = this->handleRequest(method.asString(), message["params"]);
+            if (method.asString() == "initialize")
+                this->m_initialized = true;
+        } catch (const ResponseError &error) {
+            response["error"] = json::Value::Object { { "code", error.code }, { "message", error.message } };
+        } catch (const std::exception &e) {
+            response["error"] = json::Value::Object { { "code", InternalError }, { "message", e.what() } };
+        }
+
+        this->send(response);
+    }
+
+    auto Server::run(std::istream &input, std::ostream &output) -> int {
+        this->m_output = &output;
+
+        while (!this->m_exit) {
+            auto content = readMessage(input);
+            if (!content.has_value())
+                break;
+
+            json::Value message;
+            try {
+                message = json::Value::parse(*content);
+            } catch (const std::exception &e) {
+                this->send(json::Value::Object {
+                    { "jsonrpc", "2.0" },
+                    { "id",      nullptr },
+                    { "error",   json::Value::Object { { "code", ParseError }, { "message", e.what() } } }
+                });
+                continue;
+            }
+
+            this->handleMessage(message);
+        }
+
+        // Exiting without being asked to shut down first is an error
+        return this->m_exit && this->m_shutdown ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+}